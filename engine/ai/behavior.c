@@ -5,19 +5,32 @@
 #include "ai/behavior.h"
 #include "ai/ai.h"
 #include "core/scene.h"
+#include "core/timestep.h"
+#include "core/profiler.h"
 #include "render/render.h"
 #include "navigation/pathfinding.h"
+#include "navigation/flowfield.h"
+#include "navigation/path_jobs.h"
+#include "navigation/grid.h"
+#include "navigation/replan.h"
+#include "navigation/path_cache.h"
 
 static const Uint8* keystates = NULL;
 static int chase_timer = 0;
+static MoveGrid turn_grid = { 0 };     // Reused by whichever NPC is taking its combat turn
 #define CHASE_RANGE 5
 #define COMBAT_RANGE 2
+#define WANDER_START_RATE 0.05f     // Idle -> wander transitions per second
+#define WANDER_STEP_RATE 0.2f       // Random steps per second while wandering
+#define CHASE_REPATH_SECONDS 1.0f   // Min time between chase path searches
+#define CHASE_FIELD_STEPS 2         // Steps read from the flow field before reading it again
+#define CHASE_REPLAN_STEPS 4        // Steps taken from the incremental planner before repairing it
 
 // -----------------------------------------
 // AI Transition Conditions (Stubs for now)
 // -----------------------------------------
 
-int should_wander() { return rand() % 200 == 0; }   // Wander occasionally
+int should_wander() { return tick_chance(WANDER_START_RATE); }   // Wander occasionally
 
 int sees_player(Entity* self) {
     for (int i = 0; i < entity_count; i++) {
@@ -62,6 +75,8 @@ int lost_player(Entity* self) {
 // -----------------------------------------
 
 void npc_brain(Entity* self) {
+    PROFILE_BEGIN("npc_brain");
+
     switch (self->state) {
         case STATE_IDLE:
             if (should_wander()) {
@@ -110,6 +125,8 @@ void npc_brain(Entity* self) {
             self->sprite = self->sprite_chase ? self->sprite_chase : self->sprite;
             break;
     }
+
+    PROFILE_END();
 }
 
 // -----------------------------------------
@@ -139,7 +156,7 @@ void wander_behavior(Entity* self) {
     // Only pick a new destination if we don't have a path
     if (self->path) return;
     
-    if (rand() % 100 < 2) {
+    if (tick_chance(WANDER_STEP_RATE)) {
         // Pick a random direction
         int dir = rand() % 4;
         int target_x = self->x;
@@ -150,8 +167,8 @@ void wander_behavior(Entity* self) {
         else if (dir == 2) target_y += 1;
         else if (dir == 3) target_y -= 1;
         
-        // Find path to the target
-        Path* path = find_path(self->x, self->y, target_x, target_y);
+        // Find path to the target (wanderers retrace the same steps often)
+        Path* path = find_path_cached(self->x, self->y, target_x, target_y);
         if (path && path->length > 0) {
             // Free any existing path
             if (self->path) {
@@ -167,22 +184,7 @@ void wander_behavior(Entity* self) {
     }
 }
 
-void chase_behavior(Entity* self) {
-    if (is_combat_active() && !is_entity_turn(self)) return;
-
-    Entity* player = get_player();
-
-    if (!player) return; // Safety check
-
-    // Only update path if we don't have one or we've reached the end
-    if (self->path && self->path->current < self->path->length) {
-        return; // Still following current path
-    }
-
-    if (++chase_timer % 10 != 0) return; // Only recalculate path every 10 ticks
-
-    // Find path to player
-    Path* path = find_path(self->x, self->y, player->x, player->y);
+static void follow_path(Entity* self, Path* path) {
     if (path && path->length > 0) {
         // Free any existing path
         if (self->path) {
@@ -197,6 +199,88 @@ void chase_behavior(Entity* self) {
     }
 }
 
+// Heads for the player: a few steps read from the shared flow field; when
+// the field does not reach self, a few steps from self's own incremental
+// search (started only if allow_search, then repaired as the player moves);
+// when that fails too, a path request (only if allow_search and none is
+// outstanding).
+static void approach_player(Entity* self, Entity* player, int allow_search) {
+    int owner = (int)(self - entities);
+
+    const FlowField* field = flow_field_get(player->x, player->y);
+    if (field) {
+        Path* path = flow_field_path(field, self->x, self->y, CHASE_FIELD_STEPS);
+        if (path) {
+            cancel_path_request(self);
+            replan_release(owner);
+            follow_path(self, path);
+            return;
+        }
+        if (flow_field_cost(field, self->x, self->y) == 0) return;   // Already there
+    }
+
+    if (allow_search || replan_active(owner)) {
+        Path* path = replan_path(owner, self->x, self->y, player->x, player->y, CHASE_REPLAN_STEPS);
+        if (path) {
+            cancel_path_request(self);
+            follow_path(self, path);
+            return;
+        }
+    }
+
+    if (allow_search && self->path_ticket == PATH_TICKET_NONE) {
+        request_path(self, player->x, player->y);
+    }
+}
+
+// On its combat turn: goes to the tile within this turn's AP that is
+// closest to the player along the flow field, straight from the move grid
+// without a search. Returns 0 if no reachable tile is closer than self.
+static int advance_within_ap(Entity* self, Entity* player) {
+    const FlowField* field = flow_field_get(player->x, player->y);
+    if (!field || !move_grid_update(&turn_grid, self->x, self->y, self->ap_current)) return 0;
+
+    int best = -1;
+    int best_cost = flow_field_cost(field, self->x, self->y);
+    for (int i = 0; i < turn_grid.side * turn_grid.side; i++) {
+        const HighlightTile* tile = &turn_grid.tiles[i];
+        if (!tile->valid) continue;
+
+        int cost = flow_field_cost(field, tile->x, tile->y);
+        if (cost < 0 || (best_cost >= 0 && cost > best_cost)) continue;
+        if (best_cost >= 0 && cost == best_cost &&
+            (best < 0 || tile->ap_cost >= turn_grid.tiles[best].ap_cost)) {
+            continue;   // Ties go to the cheaper tile, and staying put is cheapest
+        }
+        best = i;
+        best_cost = cost;
+    }
+    if (best < 0) return 0;
+
+    Path* path = move_grid_path(&turn_grid, turn_grid.tiles[best].x, turn_grid.tiles[best].y);
+    if (!path) return 0;
+    cancel_path_request(self);
+    follow_path(self, path);
+    return 1;
+}
+
+void chase_behavior(Entity* self) {
+    if (is_combat_active() && !is_entity_turn(self)) return;
+
+    Entity* player = get_player();
+
+    if (!player) return; // Safety check
+
+    // Only update path if we don't have one or we've reached the end
+    if (self->path && self->path->current < self->path->length) {
+        return; // Still following current path
+    }
+
+    // Field steps are cheap; full searches are not recalculated every tick
+    int allow_search = ++chase_timer % seconds_to_ticks(CHASE_REPATH_SECONDS) == 0;
+    approach_player(self, player, allow_search);
+}
+
 void combat_behavior(Entity* self) {
     if (is_combat_active() && !is_entity_turn(self)) return;
 
@@ -207,18 +291,8 @@ void combat_behavior(Entity* self) {
         return;
     }
 
-    Path* path = find_path(self->x, self->y, player->x, player->y);
-    if (path && path->length > 0) {
-        if (self->path) {
-            free_path(self->path);
-        }
-        self->path = path;
-        self->path->current = 0;
-        self->moving = 0;
-        self->move_progress = 0.0f;
-    } else if (path) {
-        free_path(path);
-    }
+    if (is_combat_active() && advance_within_ap(self, player)) return;
+    approach_player(self, player, 1);
 }
 
 void idle_behavior(Entity* self) {
@@ -8,8 +8,11 @@ const char* TILE_DIR        = "data/tiles/";
 
 const char* PLAYER_SPRITE   = "data/sprites/player.png";
 const char* NPC_SPRITE      = "data/sprites/npc.png";
-const char* DEFAULT_MAP     = "data/maps/test_map.txt";
+const char* DEFAULT_MAP     = "data/maps/test_map.omap";    // Built from test_map.txt by `make maps`
 const char* GRASS_TILE      = "data/tiles/grass.png";
 
 const int TILE_WIDTH       = 64;
 const int TILE_HEIGHT      = 32;
+
+const int WINDOW_WIDTH     = 800;
+const int WINDOW_HEIGHT    = 600;
@@ -18,4 +18,8 @@ extern const char* GRASS_TILE;
 extern const int TILE_WIDTH;
 extern const int TILE_HEIGHT;
 
+// Window size
+extern const int WINDOW_WIDTH;
+extern const int WINDOW_HEIGHT;
+
 #endif
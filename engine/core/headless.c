@@ -0,0 +1,79 @@
+// Implementation file for headless.h
+// See headless.h for detailed documentation.
+
+#include "core/headless.h"
+#include "core/scene.h"
+#include "core/sim.h"
+#include "core/profiler.h"
+#include "core/timestep.h"
+#include "render/render.h"
+#include "navigation/pathfinding.h"
+#include "navigation/path_cache.h"
+#include "helpers/sdl_helpers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+int run_headless(const HeadlessOptions* options) {
+    SDL_Surface* target = NULL;
+    SDL_Renderer* renderer = NULL;
+
+    if (!init_sdl_headless(&target, &renderer)) {
+        shutdown_sdl_headless(target, renderer);
+        return 0;
+    }
+    init_render(renderer);
+
+    // Phase timings come from the profiler zones
+    if (!profiler_enabled) profiler_init(1, 0);
+    profile_thread_name("headless");
+
+    srand(options->seed);
+    set_scene_map(options->map);
+    set_scene(SCENE_EXPLORE, renderer);
+
+    if (!sim_init(options->render)) {
+        shutdown_render();
+        shutdown_sdl_headless(target, renderer);
+        return 0;
+    }
+
+    printf("Headless: %d ticks at %d Hz, seed %u, %s\n", options->ticks, tick_rate,
+           options->seed, options->render ? "rendering off screen" : "no rendering");
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int tick = 0; tick < options->ticks; tick++) {
+        profiler_frame();           // A tick is a frame in traces
+        sim_tick();
+
+        if (options->render) {
+            PROFILE_BEGIN("render");
+            sim_publish();
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            render_scene(renderer, sim_latest_snapshot(), 1.0f);   // Exactly on the tick
+            SDL_RenderPresent(renderer);
+            PROFILE_END();
+        }
+    }
+
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    printf("Headless: %d ticks in %.3f s (%.1f ticks/s, %.1fx real time)\n",
+           options->ticks, seconds, seconds > 0.0 ? options->ticks / seconds : 0.0,
+           seconds > 0.0 ? options->ticks * tick_seconds / seconds : 0.0);
+    PathCacheStats cache = path_cache_stats();
+    printf("Headless: path cache %u hits, %u misses, %u invalidated\n",
+           cache.hits, cache.misses, cache.invalidations);
+    profiler_print_summary();
+
+    sim_shutdown();
+    release_path_workspace();
+    shutdown_render();
+    shutdown_sdl_headless(target, renderer);
+    return 1;
+}
@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+// headless.h
+//
+// Running the simulation without a display.
+// This module handles:
+//
+// - Starting SDL on the dummy video driver with an off-screen software
+//   renderer (see init_sdl_headless())
+// - Loading a given map with a fixed random seed
+// - Running update_scene() for a fixed number of ticks, as fast as possible
+// - Optionally drawing every tick into the off-screen target
+// - Printing ticks per second and per-zone timings (see profiler.h) at exit
+//
+// Usage:
+//
+//   oblique --headless --ticks 5000 --map data/maps/test_map.omap --seed 7
+//   oblique --headless --ticks 5000 --offscreen     // Render too
+//
+// Ticks run back to back on the calling thread; the simulation thread is
+// not started. Tick length is still tick_seconds, so gameplay timing is the
+// same as in a windowed run, only compressed.
+//
+// Design goals:
+// - Soak and performance runs on build machines without a display
+// - Repeatable runs: same map, seed and tick count, same work
+// -----------------------------------------------------------------------------
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define HEADLESS_DEFAULT_TICKS  1000
+#define HEADLESS_DEFAULT_SEED   1
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    int ticks;              // Ticks to simulate
+    const char* map;        // Map file (NULL = DEFAULT_MAP)
+    unsigned int seed;      // srand() seed for AI decisions
+    int render;             // 1 = draw each tick off screen, 0 = simulate only
+} HeadlessOptions;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Runs a headless session as described by options and prints its timings.
+// Returns 1 on success, 0 if SDL or the scene could not be set up.
+int run_headless(const HeadlessOptions* options);
+
+#endif  // HEADLESS_H
@@ -1,31 +1,458 @@
+// Implementation file for map.h
+// See map.h for detailed documentation.
+
 #include "core/map.h"
+#include "core/map_file.h"
+#include "core/tile.h"
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+Map world_map = { 0 };
+MapChunk map_void_chunk;
+MapPlanePage map_void_planes;
+__thread const Map* nav_map = &world_map;
+
+static uint32_t last_map_serial = 0;
+
+static void free_plane_pages(Map* map);
+
+// -----------------------------------------------------------------------------
+// Map Lifetime
+// -----------------------------------------------------------------------------
+
+int map_create(int width, int height) {
+    if (width <= 0 || height <= 0 ||
+        width > MAP_MAX_DIMENSION || height > MAP_MAX_DIMENSION) {
+        printf("Invalid map size: %dx%d\n", width, height);
+        return 0;
+    }
+
+    map_free();
+
+    int chunks_x = (width + MAP_CHUNK_SIZE - 1) >> MAP_CHUNK_SHIFT;
+    int chunks_y = (height + MAP_CHUNK_SIZE - 1) >> MAP_CHUNK_SHIFT;
+    size_t chunk_count = (size_t)chunks_x * (size_t)chunks_y;
+
+    MapChunk** chunks = malloc(chunk_count * sizeof(MapChunk*));
+    MapChunk* storage = calloc(chunk_count, sizeof(MapChunk));
+    if (!chunks || !storage) {
+        printf("Failed to allocate %dx%d map\n", width, height);
+        free(chunks);
+        free(storage);
+        return 0;
+    }
+
+    for (size_t i = 0; i < chunk_count; i++) {
+        chunks[i] = &storage[i];
+    }
+
+    world_map.width = width;
+    world_map.height = height;
+    world_map.chunks_x = chunks_x;
+    world_map.chunks_y = chunks_y;
+    world_map.chunks = chunks;
+    world_map.storage = storage;
+
+    if (!map_init_planes()) {
+        map_free();
+        return 0;
+    }
+    return 1;
+}
+
+void map_free(void) {
+    if (world_map.on_free) {
+        world_map.on_free();
+    }
+    unmap_map_file();
+    free(world_map.chunks);
+    free(world_map.storage);
+    free_plane_pages(&world_map);
+    free(world_map.chunk_revisions);
+    world_map = (Map){ 0 };
+}
+
+// -----------------------------------------------------------------------------
+// Navigation Planes
+// -----------------------------------------------------------------------------
+
+// Counts the walkable tiles of a page that are not flat.
+static int page_weighted_tiles(const MapPlanePage* page) {
+    int count = 0;
+    for (int y = 0; y < MAP_CHUNK_SIZE; y++) {
+        count += __builtin_popcount(page->walk[y] & ~page->flat[y]);
+    }
+    return count;
+}
+
+static MapPlanePage* retain_page(MapPlanePage* page) {
+    if (page != &map_void_planes) page->refs++;
+    return page;
+}
+
+static void release_page(MapPlanePage* page) {
+    if (page != &map_void_planes && --page->refs == 0) free(page);
+}
+
+// Releases every page of a map's page table and frees the table.
+static void free_plane_pages(Map* map) {
+    size_t chunk_count = (size_t)map->chunks_x * map->chunks_y;
+    for (size_t i = 0; map->planes && i < chunk_count; i++) {
+        release_page(map->planes[i]);
+    }
+    free(map->planes);
+    map->planes = NULL;
+}
+
+// Returns world_map's page for chunk index, ready to write: a new page for
+// a chunk on map_void_planes, a private copy of a page a snapshot shares.
+// Returns NULL on allocation failure.
+static MapPlanePage* own_page(int index) {
+    MapPlanePage* page = world_map.planes[index];
+    if (page != &map_void_planes && page->refs == 1) return page;
+
+    MapPlanePage* owned = page == &map_void_planes
+        ? calloc(1, sizeof(MapPlanePage))
+        : malloc(sizeof(MapPlanePage));
+    if (!owned) return NULL;
+
+    if (page != &map_void_planes) {
+        memcpy(owned, page, sizeof(MapPlanePage));
+        release_page(page);
+    }
+    owned->refs = 1;
+    world_map.planes[index] = owned;
+    return owned;
+}
+
+// Recomputes walk bits, flat bits and costs for tiles [x0, x1) x [y0, y1).
+// Works one chunk at a time (no per-tile chunk lookup) and merges every row
+// segment's bits into its page row with a single store. Pages are made
+// writable first (see own_page()).
+//
+// Returns:
+//   1 on success, 0 if a page could not be allocated.
+static int rebuild_planes(int x0, int y0, int x1, int y1) {
+    uint8_t walk_lut[TILE_COUNT];
+    uint8_t cost_lut[TILE_COUNT];
+    for (int id = 0; id < TILE_COUNT; id++) {
+        int cost = tile_defs[id].walkable ? tile_defs[id].move_cost : 0;
+        walk_lut[id] = tile_defs[id].walkable ? 1 : 0;
+        cost_lut[id] = (uint8_t)(cost > UINT8_MAX ? UINT8_MAX : cost);
+    }
+
+    for (int cy = y0 >> MAP_CHUNK_SHIFT; cy <= (y1 - 1) >> MAP_CHUNK_SHIFT; cy++) {
+        for (int cx = x0 >> MAP_CHUNK_SHIFT; cx <= (x1 - 1) >> MAP_CHUNK_SHIFT; cx++) {
+            MapPlanePage* page = own_page(cy * world_map.chunks_x + cx);
+            if (!page) {
+                printf("Failed to allocate navigation planes for chunk (%d, %d)\n", cx, cy);
+                return 0;
+            }
+
+            // This chunk's share of the rectangle, in local coordinates
+            int base_x = cx << MAP_CHUNK_SHIFT;
+            int base_y = cy << MAP_CHUNK_SHIFT;
+            int lx0 = x0 > base_x ? x0 - base_x : 0;
+            int ly0 = y0 > base_y ? y0 - base_y : 0;
+            int lx1 = x1 < base_x + MAP_CHUNK_SIZE ? x1 - base_x : MAP_CHUNK_SIZE;
+            int ly1 = y1 < base_y + MAP_CHUNK_SIZE ? y1 - base_y : MAP_CHUNK_SIZE;
+            uint32_t mask = (uint32_t)(((1ull << (lx1 - lx0)) - 1) << lx0);
+
+            const MapChunk* chunk = world_map.chunks[cy * world_map.chunks_x + cx];
+            for (int ly = ly0; ly < ly1; ly++) {
+                const TileId* src = &chunk->tiles[ly << MAP_CHUNK_SHIFT];
+                uint8_t* costs = &page->costs[ly << MAP_CHUNK_SHIFT];
+
+                uint32_t bits = 0;
+                uint32_t flat = 0;
+                for (int lx = lx0; lx < lx1; lx++) {
+                    TileId id = src[lx];
+                    int valid = id < TILE_COUNT;
+                    uint32_t walk = valid ? walk_lut[id] : 0;
+                    costs[lx] = valid ? cost_lut[id] : 0;
+                    bits |= walk << lx;
+                    flat |= (uint32_t)(walk && costs[lx] == MAP_FLAT_COST) << lx;
+                }
+
+                // Keep the weighted tile count in step with the bits replaced
+                world_map.weighted_tiles -= __builtin_popcount(page->walk[ly] & ~page->flat[ly] & mask);
+                world_map.weighted_tiles += __builtin_popcount(bits & ~flat);
+
+                page->walk[ly] = (page->walk[ly] & ~mask) | bits;
+                page->flat[ly] = (page->flat[ly] & ~mask) | flat;
+            }
+        }
+    }
+    return 1;
+}
+
+int map_init_planes(void) {
+    size_t chunk_count = (size_t)world_map.chunks_x * world_map.chunks_y;
+
+    free_plane_pages(&world_map);
+    free(world_map.chunk_revisions);
+
+    world_map.walk_stride = (world_map.width + 63) >> 6;
+    world_map.planes = malloc(chunk_count * sizeof(MapPlanePage*));
+    world_map.chunk_revisions = calloc(chunk_count, sizeof(uint32_t));
+    world_map.weighted_tiles = 0;
+    world_map.revision = 0;
+    world_map.serial = ++last_map_serial;
+
+    if (!world_map.planes || !world_map.chunk_revisions) {
+        printf("Failed to allocate navigation planes for %dx%d map\n", world_map.width, world_map.height);
+        return 0;
+    }
+
+    for (size_t i = 0; i < chunk_count; i++) {
+        world_map.planes[i] = &map_void_planes;
+    }
+
+    // Streamed maps start all void and get pages as chunks are installed
+    for (int cy = 0; cy < world_map.chunks_y; cy++) {
+        for (int cx = 0; cx < world_map.chunks_x; cx++) {
+            if (world_map.chunks[cy * world_map.chunks_x + cx] == &map_void_chunk) continue;
+
+            int x0 = cx << MAP_CHUNK_SHIFT;
+            int y0 = cy << MAP_CHUNK_SHIFT;
+            int x1 = x0 + MAP_CHUNK_SIZE < world_map.width ? x0 + MAP_CHUNK_SIZE : world_map.width;
+            int y1 = y0 + MAP_CHUNK_SIZE < world_map.height ? y0 + MAP_CHUNK_SIZE : world_map.height;
+            if (!rebuild_planes(x0, y0, x1, y1)) return 0;
+        }
+    }
+    return 1;
+}
+
+int map_refresh_chunk(int chunk_x, int chunk_y) {
+    int index = chunk_y * world_map.chunks_x + chunk_x;
+    MapPlanePage* page = world_map.planes[index];
+
+    if (world_map.chunks[index] == &map_void_chunk) {
+        // Streamed out: drop the page instead of filling it with void
+        if (page != &map_void_planes) {
+            world_map.weighted_tiles -= page_weighted_tiles(page);
+            release_page(page);
+            world_map.planes[index] = &map_void_planes;
+        }
+    } else {
+        int x0 = chunk_x << MAP_CHUNK_SHIFT;
+        int y0 = chunk_y << MAP_CHUNK_SHIFT;
+        int x1 = x0 + MAP_CHUNK_SIZE;
+        int y1 = y0 + MAP_CHUNK_SIZE;
+        if (x1 > world_map.width) x1 = world_map.width;
+        if (y1 > world_map.height) y1 = world_map.height;
+
+        // Only this chunk's page is written, and a failed own_page() leaves
+        // it untouched, so the planes still match the chunk it replaced
+        if (!rebuild_planes(x0, y0, x1, y1)) return 0;
+    }
+
+    world_map.chunk_revisions[index] = ++world_map.revision;
+    return 1;
+}
+
+int map_snapshot_planes(Map* snapshot) {
+    size_t chunk_count = (size_t)world_map.chunks_x * world_map.chunks_y;
+    int same_map = snapshot->planes && snapshot->serial == world_map.serial &&
+                   snapshot->width == world_map.width && snapshot->height == world_map.height;
+
+    if (!same_map) {
+        map_free_snapshot(snapshot);
+
+        snapshot->planes = malloc(chunk_count * sizeof(MapPlanePage*));
+        snapshot->chunk_revisions = calloc(chunk_count, sizeof(uint32_t));
+        if (!snapshot->planes || !snapshot->chunk_revisions) {
+            printf("Failed to allocate navigation snapshot for %dx%d map\n", world_map.width, world_map.height);
+            map_free_snapshot(snapshot);
+            return 0;
+        }
+
+        snapshot->width = world_map.width;
+        snapshot->height = world_map.height;
+        snapshot->chunks_x = world_map.chunks_x;
+        snapshot->chunks_y = world_map.chunks_y;
+        snapshot->walk_stride = world_map.walk_stride;
+        snapshot->serial = world_map.serial;
+        for (size_t i = 0; i < chunk_count; i++) {
+            snapshot->planes[i] = &map_void_planes;
+        }
+    }
+
+    // A shared page is never written, so a changed chunk always has a
+    // different page pointer
+    for (size_t i = 0; i < chunk_count; i++) {
+        if (snapshot->planes[i] == world_map.planes[i]) continue;
+        release_page(snapshot->planes[i]);
+        snapshot->planes[i] = retain_page(world_map.planes[i]);
+    }
+
+    memcpy(snapshot->chunk_revisions, world_map.chunk_revisions, chunk_count * sizeof(uint32_t));
+    snapshot->weighted_tiles = world_map.weighted_tiles;
+    snapshot->revision = world_map.revision;
+    return 1;
+}
+
+void map_free_snapshot(Map* snapshot) {
+    free_plane_pages(snapshot);
+    free(snapshot->chunk_revisions);
+    *snapshot = (Map){ 0 };
+}
+
+int map_chunks_changed_since(int x0, int y0, int x1, int y1, uint32_t revision) {
+    if (nav_map->revision == revision) return 0;
+
+    int cx0 = (x0 < 0 ? 0 : x0) >> MAP_CHUNK_SHIFT;
+    int cy0 = (y0 < 0 ? 0 : y0) >> MAP_CHUNK_SHIFT;
+    int cx1 = x1 >> MAP_CHUNK_SHIFT;
+    int cy1 = y1 >> MAP_CHUNK_SHIFT;
+    if (cx1 >= nav_map->chunks_x) cx1 = nav_map->chunks_x - 1;
+    if (cy1 >= nav_map->chunks_y) cy1 = nav_map->chunks_y - 1;
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            if (nav_map->chunk_revisions[cy * nav_map->chunks_x + cx] > revision) return 1;
+        }
+    }
+    return 0;
+}
+
+void map_view_capture(MapView* view, int chunk_x0, int chunk_y0, int chunk_x1, int chunk_y1) {
+    if (chunk_x0 < 0) chunk_x0 = 0;
+    if (chunk_y0 < 0) chunk_y0 = 0;
+    if (chunk_x1 >= world_map.chunks_x) chunk_x1 = world_map.chunks_x - 1;
+    if (chunk_y1 >= world_map.chunks_y) chunk_y1 = world_map.chunks_y - 1;
+    if (chunk_x1 >= chunk_x0 + MAP_VIEW_SIDE) chunk_x1 = chunk_x0 + MAP_VIEW_SIDE - 1;
+    if (chunk_y1 >= chunk_y0 + MAP_VIEW_SIDE) chunk_y1 = chunk_y0 + MAP_VIEW_SIDE - 1;
+
+    view->serial = world_map.serial;
+    view->width = world_map.width;
+    view->height = world_map.height;
+    view->chunk_x0 = chunk_x0;
+    view->chunk_y0 = chunk_y0;
+    view->chunks_w = chunk_x1 >= chunk_x0 ? chunk_x1 - chunk_x0 + 1 : 0;
+    view->chunks_h = chunk_y1 >= chunk_y0 ? chunk_y1 - chunk_y0 + 1 : 0;
+
+    for (int ly = 0; ly < view->chunks_h; ly++) {
+        for (int lx = 0; lx < view->chunks_w; lx++) {
+            int index = (chunk_y0 + ly) * world_map.chunks_x + chunk_x0 + lx;
+            view->chunks[ly * view->chunks_w + lx] = world_map.chunks[index];
+            view->revisions[ly * view->chunks_w + lx] = world_map.chunk_revisions[index];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Tile Access
+// -----------------------------------------------------------------------------
+
+int map_set_tile(int x, int y, TileId id) {
+    if (!map_in_bounds(x, y)) return 0;
+
+    MapChunk* chunk = map_chunk_at(x, y);
+    if (chunk == &map_void_chunk) return 0;
 
-int tile_map[MAP_HEIGHT][MAP_WIDTH];
+    TileId* tile = &chunk->tiles[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK)];
+    TileId old = *tile;
+    *tile = id;
+
+    // Planes unchanged (no page for a copy-on-write): keep the old tile
+    if (!rebuild_planes(x, y, x + 1, y + 1)) {
+        *tile = old;
+        return 0;
+    }
+    world_map.chunk_revisions[(y >> MAP_CHUNK_SHIFT) * world_map.chunks_x + (x >> MAP_CHUNK_SHIFT)] = ++world_map.revision;
+    return 1;
+}
 
 int map_is_walkable(int x, int y) {
-    if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT)
+    if (!map_in_bounds(x, y))
         return 0;
 
     // Convention: 0 = walkable (ground), non-zero = blocked (walls/obstacles)
     // This matches the map file where 0 means empty/walkable terrain
-    return tile_map[y][x] == 0;
+    return map_get_tile(x, y) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+// First pass over a text map: counts tiles per row and non-empty rows.
+// Returns 0 if rows have differing lengths.
+static int measure_text_map(FILE* file, int* out_width, int* out_height) {
+    int width = -1;
+    int height = 0;
+    int row_tiles = 0;
+    int in_token = 0;
+    int c;
+
+    do {
+        c = getc(file);
+
+        if (c == EOF || c == '\n') {
+            if (in_token) row_tiles++;
+            in_token = 0;
+
+            if (row_tiles > 0) {
+                if (width < 0) {
+                    width = row_tiles;
+                } else if (row_tiles != width) {
+                    printf("Row %d has %d tiles, expected %d\n", height, row_tiles, width);
+                    return 0;
+                }
+                height++;
+            }
+            row_tiles = 0;
+        } else if (isspace(c)) {
+            if (in_token) row_tiles++;
+            in_token = 0;
+        } else {
+            in_token = 1;
+        }
+    } while (c != EOF);
+
+    *out_width = width;
+    *out_height = height;
+    return width > 0;
 }
 
 int load_map(const char* filename) {
+    if (is_map_file(filename)) {
+        return load_map_file(filename);
+    }
+
     FILE* file = fopen(filename, "r");
     if (!file) {
         printf("Failed to load map file: %s\n", filename);
         return 0;
     }
 
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            if (fscanf(file, "%d", &tile_map[y][x]) != 1) {
+    int width, height;
+    if (!measure_text_map(file, &width, &height) || !map_create(width, height)) {
+        printf("Invalid map file: %s\n", filename);
+        fclose(file);
+        return 0;
+    }
+
+    rewind(file);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int id;
+            if (fscanf(file, "%d", &id) != 1 || id < 0 || id > UINT16_MAX) {
                 printf("Invalid tile data at (%d, %d)\n", x, y);
                 fclose(file);
+                map_free();
                 return 0;
             }
+            map_set_tile(x, y, (TileId)id);
         }
     }
 
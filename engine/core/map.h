@@ -1,15 +1,356 @@
+// -----------------------------------------------------------------------------
+// map.h
+//
+// Runtime-sized tile map storage.
+// This module handles:
+//
+// - Allocating a map whose dimensions are only known at load time
+// - Storing tiles in fixed-size square chunks (MAP_CHUNK_SIZE x MAP_CHUNK_SIZE)
+// - Fast inline accessors used by navigation, rendering and camera code
+// - Navigation planes (walkability and flat-tile bitsets, move-cost bytes)
+//   kept in sync with the tiles, so pathfinding never touches tile_defs
+// - Map views: the chunks around the camera, captured by the simulation so
+//   the renderer draws from a snapshot instead of the live chunk table
+// - Loading maps from data/maps/ (text, or binary .omap via map_file.h)
+//
+// Tiles are addressed by (x, y) like before, but are physically stored as a
+// table of chunks. Each chunk is a small row-major block of compact TileIds,
+// so row-wise scans touch one cache line per 32 tiles and a neighbourhood
+// lookup (x +/- 1, y +/- 1) almost always stays inside the same 2 KB chunk.
+//
+// The navigation planes are paged the same way: one MapPlanePage per chunk,
+// and non-resident chunks share map_void_planes, so a streamed map only
+// pays for the planes of its resident chunks.
+//
+// Memory: a 4096x4096 map is 128x128 chunks of 2 KB = 32 MB of tile data
+// plus a 128 KB chunk table, plus 128x128 plane pages of about 1.3 KB
+// (walkability and flat bits, move costs) = 21 MB and a 128 KB page table.
+//
+// Design goals:
+// - No compile-time map size anywhere in the engine
+// - O(1) tile access with shifts and masks (no division)
+// - Chunk granularity that later systems (streaming, baking) can build on
+// -----------------------------------------------------------------------------
+
 #ifndef MAP_H
 #define MAP_H
 
 #include "core/constants.h"
 
-#define MAP_WIDTH 20
-#define MAP_HEIGHT 20
+#include <stddef.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define MAP_CHUNK_SHIFT 5                                   // log2(MAP_CHUNK_SIZE)
+#define MAP_CHUNK_SIZE  (1 << MAP_CHUNK_SHIFT)              // 32 tiles per chunk side
+#define MAP_CHUNK_MASK  (MAP_CHUNK_SIZE - 1)
+#define MAP_CHUNK_TILES (MAP_CHUNK_SIZE * MAP_CHUNK_SIZE)   // 1024 tiles per chunk
+
+#define MAP_MAX_DIMENSION 65536  // Upper bound on width/height accepted by map_create()
+
+#define MAP_TILE_VOID 0xFFFF     // Tile id reported for non-resident (streamed out) chunks
+
+#define MAP_FLAT_COST 1          // Move cost of tiles set in MapPlanePage::flat
+
+#define MAP_VIEW_SIDE   8                               // Chunks per side a MapView holds
+#define MAP_VIEW_CHUNKS (MAP_VIEW_SIDE * MAP_VIEW_SIDE) // The window spans about 4 x 4
+
+#if MAP_CHUNK_SIZE != 32
+#error "MapPlanePage stores one uint32_t of bits per chunk row"
+#endif
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Compact tile identifier (index into tile_defs in tile.c).
+typedef uint16_t TileId;
+
+// A square block of tiles, stored row-major:
+//   tiles[local_y * MAP_CHUNK_SIZE + local_x]
+//
+// Chunks on the right/bottom edge of a map whose size is not a multiple of
+// MAP_CHUNK_SIZE are padded; the padding tiles are never read.
+typedef struct {
+    TileId tiles[MAP_CHUNK_TILES];
+} MapChunk;
+
+// Navigation planes of one chunk, built from its tiles and tile_defs.
+//
+// Fields:
+//   walk: Walkability, bit local_x of walk[local_y]
+//   flat: Walkable tiles whose move cost is MAP_FLAT_COST, same layout
+//         (uniform-cost regions for jump search)
+//   costs: Move cost per tile, laid out like MapChunk::tiles (0 for
+//          unwalkable tiles)
+//   refs: Page tables pointing at this page (world_map and snapshots).
+//         A page with more than one is never written; world_map copies it
+//         first. Only touched on the thread that edits world_map.
+//
+// Padding tiles of edge chunks are always 0 in every plane.
+typedef struct {
+    uint32_t walk[MAP_CHUNK_SIZE];
+    uint32_t flat[MAP_CHUNK_SIZE];
+    uint8_t costs[MAP_CHUNK_TILES];
+    int refs;
+} MapPlanePage;
+
+// The tile map.
+//
+// Fields:
+//   width, height: Map size in tiles
+//   chunks_x, chunks_y: Map size in chunks (rounded up)
+//   chunks: Chunk table, row-major (chunks[cy * chunks_x + cx]); entries
+//           for non-resident chunks point at map_void_chunk
+//   storage: Contiguous block backing every chunk, owned by the map
+//            (NULL when chunks point into a mapped .omap file)
+//   file_base, file_size: mmap()ed .omap file backing the chunks, if any
+//   on_free: Called first by map_free() when set, so the owner of the
+//            chunks (the streamer) can release them
+//   planes: Plane page table, indexed like chunks; entries for
+//           non-resident chunks point at map_void_planes
+//   walk_stride: 64-tile words per row, as read by map_walk_word()
+//   weighted_tiles: Number of walkable tiles that are not flat
+//   revision: Incremented whenever any tile changes
+//   chunk_revisions: Value of revision when each chunk last changed
+//   serial: Unique per loaded map, so caches keyed on chunk revisions
+//           can tell a fresh map from the one they were built for
+typedef struct {
+    int width;
+    int height;
+    int chunks_x;
+    int chunks_y;
+    MapChunk** chunks;
+    MapChunk* storage;
+    void* file_base;
+    size_t file_size;
+    void (*on_free)(void);
+
+    MapPlanePage** planes;
+    int walk_stride;
+    int weighted_tiles;
+    uint32_t revision;
+    uint32_t* chunk_revisions;
+    uint32_t serial;
+} Map;
+
+// A box of world_map's chunks as they were when captured. The simulation
+// captures one into every render snapshot (see sim.h), so the renderer
+// never reads the chunk table the streamer is changing. Chunk pointers stay
+// valid while the snapshot is drawn: the streamer frees an evicted chunk
+// only once the renderer is past every snapshot captured before the
+// eviction (see map_stream_release_chunks()).
+//
+// Fields:
+//   serial: world_map.serial at capture (0: nothing captured)
+//   width, height: Map size in tiles
+//   chunk_x0, chunk_y0: First chunk of the box
+//   chunks_w, chunks_h: Box size in chunks (at most MAP_VIEW_SIDE each)
+//   chunks, revisions: Chunk pointer and chunk_revisions entry of each
+//                      chunk in the box, row-major
+typedef struct {
+    uint32_t serial;
+    int width, height;
+    int chunk_x0, chunk_y0;
+    int chunks_w, chunks_h;
+    const MapChunk* chunks[MAP_VIEW_CHUNKS];
+    uint32_t revisions[MAP_VIEW_CHUNKS];
+} MapView;
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+// The currently loaded map. Zero-sized until map_create() or load_map().
+extern Map world_map;
+
+// Shared read-only stand-in for chunks that are not resident (see
+// map_stream.h). Every tile is MAP_TILE_VOID; writes to it are ignored.
+extern MapChunk map_void_chunk;
+
+// Shared read-only planes of every non-resident chunk: nothing walkable.
+extern MapPlanePage map_void_planes;
+
+// Map that the size and navigation accessors below read. &world_map on
+// every thread except pathfinding workers, which point it at a read-only
+// snapshot of the planes (see map_snapshot_planes() and path_jobs.h) so they
+// can search while the simulation keeps changing world_map.
+extern __thread const Map* nav_map;
+
+// -----------------------------------------------------------------------------
+// Inline Accessors
+// -----------------------------------------------------------------------------
+
+static inline int map_width(void) {
+    return nav_map->width;
+}
+
+static inline int map_height(void) {
+    return nav_map->height;
+}
 
-extern int tile_map[MAP_HEIGHT][MAP_WIDTH];
+// Returns 1 if (x, y) lies inside the map, 0 otherwise.
+static inline int map_in_bounds(int x, int y) {
+    return x >= 0 && x < nav_map->width && y >= 0 && y < nav_map->height;
+}
 
+// Returns the chunk holding tile (x, y). Coordinates must be in bounds.
+static inline MapChunk* map_chunk_at(int x, int y) {
+    return world_map.chunks[(y >> MAP_CHUNK_SHIFT) * world_map.chunks_x + (x >> MAP_CHUNK_SHIFT)];
+}
+
+// Returns the tile id at (x, y). Coordinates must be in bounds.
+static inline TileId map_get_tile(int x, int y) {
+    return map_chunk_at(x, y)->tiles[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK)];
+}
+
+// Returns the plane page holding tile (x, y) of map. Coordinates must be in bounds.
+static inline const MapPlanePage* map_planes_at(const Map* map, int x, int y) {
+    return map->planes[(y >> MAP_CHUNK_SHIFT) * map->chunks_x + (x >> MAP_CHUNK_SHIFT)];
+}
+
+// Returns 1 if (x, y) is walkable according to tile_defs. A page lookup
+// and a bit test. Coordinates must be in bounds.
+static inline int map_walkable(int x, int y) {
+    return (int)((map_planes_at(nav_map, x, y)->walk[y & MAP_CHUNK_MASK] >> (x & MAP_CHUNK_MASK)) & 1);
+}
+
+// Returns 1 if (x, y) is walkable at MAP_FLAT_COST. Coordinates must be in bounds.
+static inline int map_flat(int x, int y) {
+    return (int)((map_planes_at(nav_map, x, y)->flat[y & MAP_CHUNK_MASK] >> (x & MAP_CHUNK_MASK)) & 1);
+}
+
+// Returns the move cost of (x, y) (0 if unwalkable). Coordinates must be in bounds.
+static inline int map_move_cost(int x, int y) {
+    return map_planes_at(nav_map, x, y)->costs[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK)];
+}
+
+// Returns tiles [w * 64, w * 64 + 64) of row y of map's walkability bits,
+// built from the two chunks they span, for testing 64 tiles at a time.
+// Bits past the map width are always 0. y must be in bounds and
+// 0 <= w < walk_stride.
+static inline uint64_t map_walk_word(const Map* map, int y, int w) {
+    MapPlanePage* const* row = &map->planes[(y >> MAP_CHUNK_SHIFT) * map->chunks_x];
+    int c = w << 1;
+    uint64_t hi = c + 1 < map->chunks_x ? row[c + 1]->walk[y & MAP_CHUNK_MASK] : 0;
+    return row[c]->walk[y & MAP_CHUNK_MASK] | hi << 32;
+}
+
+// Returns 64 tiles of the flat bits, laid out like map_walk_word().
+static inline uint64_t map_flat_word(const Map* map, int y, int w) {
+    MapPlanePage* const* row = &map->planes[(y >> MAP_CHUNK_SHIFT) * map->chunks_x];
+    int c = w << 1;
+    uint64_t hi = c + 1 < map->chunks_x ? row[c + 1]->flat[y & MAP_CHUNK_MASK] : 0;
+    return row[c]->flat[y & MAP_CHUNK_MASK] | hi << 32;
+}
+
+// Returns the index of chunk (chunk_x, chunk_y) in view's chunks and
+// revisions, or -1 outside the captured box.
+static inline int map_view_index(const MapView* view, int chunk_x, int chunk_y) {
+    int lx = chunk_x - view->chunk_x0;
+    int ly = chunk_y - view->chunk_y0;
+    if (lx < 0 || ly < 0 || lx >= view->chunks_w || ly >= view->chunks_h) return -1;
+    return ly * view->chunks_w + lx;
+}
+
+// Returns view's chunk (chunk_x, chunk_y), or map_void_chunk outside the
+// captured box.
+static inline const MapChunk* map_view_chunk(const MapView* view, int chunk_x, int chunk_y) {
+    int index = map_view_index(view, chunk_x, chunk_y);
+    return index < 0 ? &map_void_chunk : view->chunks[index];
+}
+
+// -----------------------------------------------------------------------------
+// Map Lifetime
+// -----------------------------------------------------------------------------
+
+// Allocates an empty width x height map (all tiles 0) and makes it current.
+// Any previously loaded map is freed first.
+//
+// Returns:
+//   1 on success, 0 on invalid dimensions or allocation failure.
+int map_create(int width, int height);
+
+// Frees the current map and resets it to 0x0. Safe to call repeatedly.
+void map_free(void);
+
+// Allocates the plane page table for the current map and builds a page
+// for every chunk that is not map_void_chunk. Called by every loader;
+// returns 0 on allocation failure.
+int map_init_planes(void);
+
+// Rebuilds the navigation planes for one chunk and bumps its revision.
+// Used when a chunk's tiles are replaced wholesale (streamed in or out):
+// a chunk set to map_void_chunk frees its page and reads map_void_planes.
+//
+// Returns:
+//   1 on success, 0 if the chunk's page could not be allocated. The planes
+//   and revision are then unchanged, so the caller must put back the chunk
+//   it replaced.
+int map_refresh_chunk(int chunk_x, int chunk_y);
+
+// Copies the current map's size, navigation planes and revisions into
+// snapshot (chunks stays NULL: snapshots carry no tiles). Plane pages are
+// shared, not copied: world_map copies a shared page the next time it
+// changes that chunk, so a snapshot costs a page table plus the pages of
+// chunks edited while it is alive. snapshot must be zeroed or a previous
+// snapshot; if it is a snapshot of the same map, only pages that changed
+// since it was taken are swapped.
+//
+// Returns:
+//   1 on success, 0 on allocation failure (snapshot is then left empty).
+int map_snapshot_planes(Map* snapshot);
+
+// Frees a snapshot's planes and zeroes it. Safe to call repeatedly.
+void map_free_snapshot(Map* snapshot);
+
+// Returns 1 if any chunk overlapping tiles [x0, x1] x [y0, y1] of nav_map
+// changed after revision, 0 otherwise. The box is clamped to the map.
+// Caches keyed on (serial, revision) use this to tell whether an edit
+// touched the area they depend on; a map-wide revision equal to revision
+// answers 0 without scanning.
+int map_chunks_changed_since(int x0, int y0, int x1, int y1, uint32_t revision);
+
+// Captures chunks [chunk_x0, chunk_x1] x [chunk_y0, chunk_y1] of world_map
+// into view, clamped to the map and to MAP_VIEW_SIDE chunks per side
+// (counted from chunk_x0, chunk_y0).
+void map_view_capture(MapView* view, int chunk_x0, int chunk_y0, int chunk_x1, int chunk_y1);
+
+// -----------------------------------------------------------------------------
+// Tile Access
+// -----------------------------------------------------------------------------
+
+// Sets the tile id at (x, y) and updates the navigation planes and
+// revisions for that tile.
+//
+// Returns:
+//   1 on success. 0 if (x, y) is out of bounds or in a non-resident chunk,
+//   or if the planes could not be updated (no memory to copy a page a path
+//   snapshot shares); the tile, planes and revisions are then unchanged.
+int map_set_tile(int x, int y, TileId id);
+
+// Returns 1 if (x, y) is in bounds and holds tile 0, 0 otherwise.
+// Convention: 0 = walkable (ground), non-zero = blocked (walls/obstacles).
 int map_is_walkable(int x, int y);
 
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+// Loads a map file and makes it current.
+//
+// Binary .omap files (see map_file.h) are detected by their magic number and
+// memory-mapped in place. Anything else is parsed as a text map: one row of
+// whitespace-separated tile ids per line. The text map width is taken from
+// the first row and the height from the number of non-empty rows; every row
+// must have the same number of tiles.
+//
+// Returns:
+//   1 on success, 0 on failure (file missing, ragged rows, bad tile id,
+//   corrupt binary file).
 int load_map(const char* filename);
 
-#endif
+#endif  // MAP_H
@@ -0,0 +1,236 @@
+// Implementation file for map_file.h
+// See map_file.h for detailed documentation.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "core/map_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+// The format is little-endian and chunk data is used in place, so the host
+// must be little-endian too (true for every platform we ship on).
+static int host_is_little_endian(void) {
+    const uint16_t probe = 1;
+    return *(const uint8_t*)&probe == 1;
+}
+
+static uint64_t align_up(uint64_t value, uint64_t align) {
+    return (value + align - 1) / align * align;
+}
+
+int validate_map_file_header(const MapFileHeader* h, uint64_t file_size) {
+    if (memcmp(h->magic, MAP_FILE_MAGIC, 4) != 0) {
+        printf("Map file: bad magic\n");
+        return 0;
+    }
+    if (h->version != MAP_FILE_VERSION) {
+        printf("Map file: unsupported version %u (expected %d)\n", h->version, MAP_FILE_VERSION);
+        return 0;
+    }
+    if (h->chunk_size != MAP_CHUNK_SIZE) {
+        printf("Map file: chunk size %u does not match engine chunk size %d\n", h->chunk_size, MAP_CHUNK_SIZE);
+        return 0;
+    }
+    if (h->width == 0 || h->height == 0 ||
+        h->width > MAP_MAX_DIMENSION || h->height > MAP_MAX_DIMENSION ||
+        h->chunks_x != (h->width + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE ||
+        h->chunks_y != (h->height + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE) {
+        printf("Map file: bad dimensions %ux%u (%ux%u chunks)\n", h->width, h->height, h->chunks_x, h->chunks_y);
+        return 0;
+    }
+    if (h->layer_count == 0 || h->layer_count > 64) {
+        printf("Map file: bad layer count %u\n", h->layer_count);
+        return 0;
+    }
+
+    // Bounds are compared by subtraction so crafted offsets cannot wrap
+    uint64_t entries = (uint64_t)h->chunks_x * h->chunks_y * h->layer_count;
+    if (h->chunk_table_offset < sizeof(MapFileHeader) ||
+        h->chunk_table_offset % sizeof(uint64_t) != 0 ||
+        h->chunk_table_offset > file_size ||
+        entries > (file_size - h->chunk_table_offset) / sizeof(uint64_t)) {
+        printf("Map file: chunk table out of range\n");
+        return 0;
+    }
+    if (h->data_offset > file_size) {
+        printf("Map file: data offset out of range\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+int validate_map_chunk_offset(const MapFileHeader* h, uint64_t offset, uint64_t file_size) {
+    return offset >= h->data_offset &&
+           offset % sizeof(uint64_t) == 0 &&
+           file_size >= sizeof(MapChunk) &&
+           offset <= file_size - sizeof(MapChunk);
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+int is_map_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+
+    char magic[4];
+    int match = fread(magic, 1, 4, file) == 4 && memcmp(magic, MAP_FILE_MAGIC, 4) == 0;
+    fclose(file);
+    return match;
+}
+
+int load_map_file(const char* filename) {
+    if (!host_is_little_endian()) {
+        printf("Map file: big-endian hosts are not supported\n");
+        return 0;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Failed to load map file: %s\n", filename);
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(MapFileHeader)) {
+        printf("Map file too small: %s\n", filename);
+        close(fd);
+        return 0;
+    }
+
+    size_t file_size = (size_t)st.st_size;
+    void* base = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file alive
+
+    if (base == MAP_FAILED) {
+        printf("Failed to mmap map file: %s\n", filename);
+        return 0;
+    }
+
+    const MapFileHeader* header = (const MapFileHeader*)base;
+    if (!validate_map_file_header(header, file_size)) {
+        printf("Invalid map file: %s\n", filename);
+        munmap(base, file_size);
+        return 0;
+    }
+
+    size_t chunk_count = (size_t)header->chunks_x * header->chunks_y;
+    const uint64_t* table = (const uint64_t*)((const char*)base + header->chunk_table_offset);
+
+    MapChunk** chunks = malloc(chunk_count * sizeof(MapChunk*));
+    if (!chunks) {
+        munmap(base, file_size);
+        return 0;
+    }
+
+    // Point every chunk straight at its ground layer inside the mapping
+    for (size_t i = 0; i < chunk_count; i++) {
+        uint64_t offset = table[i * header->layer_count + MAP_LAYER_GROUND];
+        if (!validate_map_chunk_offset(header, offset, file_size)) {
+            printf("Invalid map file: %s (chunk %zu out of range)\n", filename, i);
+            free(chunks);
+            munmap(base, file_size);
+            return 0;
+        }
+        chunks[i] = (MapChunk*)((char*)base + offset);
+    }
+
+    map_free();
+
+    world_map.width = (int)header->width;
+    world_map.height = (int)header->height;
+    world_map.chunks_x = (int)header->chunks_x;
+    world_map.chunks_y = (int)header->chunks_y;
+    world_map.chunks = chunks;
+    world_map.storage = NULL;
+    world_map.file_base = base;
+    world_map.file_size = file_size;
+
+    if (!map_init_planes()) {
+        map_free();
+        return 0;
+    }
+    return 1;
+}
+
+int save_map_file(const char* filename) {
+    if (world_map.width <= 0 || world_map.height <= 0) {
+        printf("No map loaded, nothing to save\n");
+        return 0;
+    }
+    if (!host_is_little_endian()) {
+        printf("Map file: big-endian hosts are not supported\n");
+        return 0;
+    }
+
+    size_t chunk_count = (size_t)world_map.chunks_x * world_map.chunks_y;
+    uint64_t table_offset = sizeof(MapFileHeader);
+    uint64_t data_offset = align_up(table_offset + chunk_count * sizeof(uint64_t), MAP_FILE_DATA_ALIGN);
+
+    MapFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAP_FILE_MAGIC, 4);
+    header.version = MAP_FILE_VERSION;
+    header.width = (uint32_t)world_map.width;
+    header.height = (uint32_t)world_map.height;
+    header.chunk_size = MAP_CHUNK_SIZE;
+    header.chunks_x = (uint32_t)world_map.chunks_x;
+    header.chunks_y = (uint32_t)world_map.chunks_y;
+    header.layer_count = 1;
+    header.chunk_table_offset = table_offset;
+    header.data_offset = data_offset;
+
+    uint64_t* table = malloc(chunk_count * sizeof(uint64_t));
+    if (!table) return 0;
+    for (size_t i = 0; i < chunk_count; i++) {
+        table[i] = data_offset + i * sizeof(MapChunk);
+    }
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        printf("Failed to open %s for writing\n", filename);
+        free(table);
+        return 0;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(table, sizeof(uint64_t), chunk_count, file) == chunk_count;
+
+    // Zero padding up to the page-aligned data section
+    long pad = (long)(data_offset - table_offset - chunk_count * sizeof(uint64_t));
+    for (long i = 0; ok && i < pad; i++) {
+        ok = fputc(0, file) != EOF;
+    }
+
+    for (size_t i = 0; ok && i < chunk_count; i++) {
+        ok = fwrite(world_map.chunks[i], sizeof(MapChunk), 1, file) == 1;
+    }
+
+    free(table);
+    if (fclose(file) != 0) ok = 0;
+
+    if (!ok) {
+        printf("Failed to write map file: %s\n", filename);
+    }
+    return ok;
+}
+
+void unmap_map_file(void) {
+    if (world_map.file_base) {
+        munmap(world_map.file_base, world_map.file_size);
+        world_map.file_base = NULL;
+        world_map.file_size = 0;
+    }
+}
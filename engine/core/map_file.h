@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+// map_file.h
+//
+// Versioned binary map format (.omap), loaded with mmap().
+// This module handles:
+//
+// - The on-disk layout (header, chunk table, tile layers)
+// - Mapping a .omap file and pointing the map's chunk table straight into it
+// - Writing the current map out as .omap (used by tools/map_convert)
+//
+// Layout (all integers little-endian):
+//
+//   [MapFileHeader]                      64 bytes at offset 0
+//   [chunk table]                        uint64 offset per (chunk, layer),
+//                                        index (cy * chunks_x + cx) * layer_count + layer
+//   [padding to MAP_FILE_DATA_ALIGN]
+//   [chunk layer data]                   MAP_CHUNK_TILES TileIds per entry,
+//                                        row-major, same layout as MapChunk
+//
+// Because chunk data on disk has exactly the in-memory MapChunk layout, the
+// loader does no parsing: it validates the header and chunk table, then uses
+// the tile data in place. The mapping is private (copy-on-write), so
+// map_set_tile() still works and never writes back to the file.
+//
+// The navigation planes are not stored in the file: map_init_planes() builds
+// them from every tile of every chunk, which reads (and so faults in) the
+// whole ground layer at load time. Streamed maps (map_stream.h) avoid this
+// by building planes per chunk as chunks are installed.
+//
+// Layer 0 is the ground layer and is the only one the engine reads today;
+// extra layers are carried by the format and ignored by the loader.
+//
+// Design goals:
+// - No tile parsing or copying: validation is O(chunks), and the only
+//   O(tiles) work at load is the plane build
+// - Strict validation: a corrupt file is rejected, never dereferenced
+// -----------------------------------------------------------------------------
+
+#ifndef MAP_FILE_H
+#define MAP_FILE_H
+
+#include "core/map.h"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define MAP_FILE_MAGIC      "OBMP"
+#define MAP_FILE_VERSION    1
+#define MAP_FILE_DATA_ALIGN 4096    // Chunk data starts page-aligned
+#define MAP_LAYER_GROUND    0
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Fixed 64-byte file header.
+typedef struct {
+    char     magic[4];              // MAP_FILE_MAGIC, not NUL-terminated
+    uint32_t version;               // MAP_FILE_VERSION
+    uint32_t width;                 // Map size in tiles
+    uint32_t height;
+    uint32_t chunk_size;            // Must equal MAP_CHUNK_SIZE
+    uint32_t chunks_x;              // Map size in chunks
+    uint32_t chunks_y;
+    uint32_t layer_count;           // >= 1, layer 0 is ground
+    uint64_t chunk_table_offset;    // Byte offset of the chunk table
+    uint64_t data_offset;           // Byte offset of the first chunk layer
+    uint8_t  reserved[16];          // Zero
+} MapFileHeader;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Returns 1 if the file at filename starts with MAP_FILE_MAGIC.
+int is_map_file(const char* filename);
+
+// Checks a header read from a file of file_size bytes: magic, version,
+// chunk size, dimensions, and chunk table and data offset bounds.
+//
+// Returns:
+//   1 if valid, 0 otherwise (the reason is printed).
+int validate_map_file_header(const MapFileHeader* h, uint64_t file_size);
+
+// Checks one chunk table entry of a header that passed
+// validate_map_file_header(): a whole MapChunk at offset must lie between
+// data_offset and the end of the file.
+//
+// Returns:
+//   1 if valid, 0 otherwise.
+int validate_map_chunk_offset(const MapFileHeader* h, uint64_t offset, uint64_t file_size);
+
+// Maps a .omap file and makes it the current map.
+//
+// Any previously loaded map is freed first. The file stays mapped until
+// map_free() (or the next load) releases it.
+//
+// Returns:
+//   1 on success, 0 if the file cannot be opened or fails validation.
+int load_map_file(const char* filename);
+
+// Writes the current map to filename in .omap format (single ground layer).
+//
+// Returns:
+//   1 on success, 0 on I/O failure or if no map is loaded.
+int save_map_file(const char* filename);
+
+// Releases the mapping held by the current map, if any.
+// Called by map_free(); not normally needed elsewhere.
+void unmap_map_file(void);
+
+#endif  // MAP_FILE_H
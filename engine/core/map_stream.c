@@ -0,0 +1,681 @@
+// Implementation file for map_stream.h
+// See map_stream.h for detailed documentation.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "core/map_stream.h"
+#include "core/map_file.h"
+#include "core/tile.h"
+#include "core/constants.h"
+#include "render/render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types
+// -----------------------------------------------------------------------------
+
+enum {
+    SLOT_NONRESIDENT,
+    SLOT_REQUESTED,     // Queued for, or being loaded by, the worker
+    SLOT_RESIDENT,
+    SLOT_FAILED         // Read error; stays void and is not retried
+};
+
+// Per-chunk residency record, also an intrusive LRU list node.
+// Main thread only.
+typedef struct {
+    int state;
+    uint32_t last_wanted;   // Tick the chunk was last inside the wanted area
+    int lru_prev;           // Towards most recently wanted (-1 = head)
+    int lru_next;           // Towards least recently wanted (-1 = tail)
+} ChunkSlot;
+
+typedef struct {
+    int index;              // Chunk index (cy * chunks_x + cx)
+    int priority;           // Lower loads first
+} StreamRequest;
+
+typedef struct {
+    int index;
+    MapChunk* chunk;        // NULL if the read failed
+} StreamResult;
+
+typedef struct {
+    TileId id;
+    SDL_Surface* surface;
+} DecodedTile;
+
+// An evicted chunk a snapshot published before the eviction may still draw
+typedef struct {
+    MapChunk* chunk;
+    uint32_t epoch;         // First snapshot epoch captured without it
+} RetiredChunk;
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+// Simulation thread
+static int stream_active = 0;
+static ChunkSlot* slots = NULL;
+static int lru_head = -1;
+static int lru_tail = -1;
+static uint32_t stream_tick = 0;
+static size_t budget = 0;
+static RetiredChunk* retired = NULL;
+static int retired_count = 0;
+static int retired_capacity = 0;
+static uint32_t published_epoch = 0;    // As last passed to map_stream_release_chunks()
+
+// Render thread
+static size_t texture_bytes[TILE_COUNT];
+
+// Immutable while the worker runs
+static int stream_fd = -1;
+static uint64_t* chunk_offsets = NULL;  // Ground layer offset per chunk
+
+// Shared with the worker, guarded by stream_lock
+static SDL_Thread* worker = NULL;
+static SDL_mutex* stream_lock = NULL;
+static SDL_cond* work_available = NULL;
+static SDL_cond* work_done = NULL;
+static int worker_quit = 0;
+static StreamRequest* queue = NULL;
+static int queue_count = 0;
+static int in_flight = -1;
+static StreamResult* results = NULL;
+static int result_count = 0;
+static DecodedTile decoded[TILE_COUNT];
+static int decoded_count = 0;
+static unsigned char tile_requested[TILE_COUNT];  // Decoded, being decoded, or uploaded
+static TileId tile_queue[TILE_COUNT];   // Tiles to decode that no chunk read claimed
+static int tile_queue_count = 0;
+static int tiles_in_flight = 0;
+
+// Shared by the simulation (installs, evictions) and the renderer (texture
+// upload), guarded by stream_lock
+static size_t resident_bytes = 0;
+static int tile_refs[TILE_COUNT];       // Resident chunks using each tile type
+
+// -----------------------------------------------------------------------------
+// Worker Thread
+// -----------------------------------------------------------------------------
+
+static MapChunk* read_chunk(int index) {
+    MapChunk* chunk = malloc(sizeof(MapChunk));
+    if (!chunk) return NULL;
+
+    char* dst = (char*)chunk;
+    size_t remaining = sizeof(MapChunk);
+    off_t offset = (off_t)chunk_offsets[index];
+
+    while (remaining > 0) {
+        ssize_t n = pread(stream_fd, dst, remaining, offset);
+        if (n <= 0) {
+            free(chunk);
+            return NULL;
+        }
+        dst += n;
+        offset += n;
+        remaining -= (size_t)n;
+    }
+
+    return chunk;
+}
+
+// Decodes claimed tile images and publishes them. Caller holds stream_lock,
+// which is released while decoding.
+static void decode_tiles_locked(const TileId* claimed, int claimed_count) {
+    if (claimed_count == 0) return;
+
+    SDL_UnlockMutex(stream_lock);
+    SDL_Surface* surfaces[TILE_COUNT];
+    for (int i = 0; i < claimed_count; i++) {
+        surfaces[i] = load_tile_surface(claimed[i]);
+    }
+    SDL_LockMutex(stream_lock);
+
+    for (int i = 0; i < claimed_count; i++) {
+        if (surfaces[i]) {
+            decoded[decoded_count++] = (DecodedTile){ claimed[i], surfaces[i] };
+        } else {
+            tile_requested[claimed[i]] = 0;
+        }
+    }
+}
+
+static int stream_worker(void* unused) {
+    SDL_LockMutex(stream_lock);
+
+    while (1) {
+        while (!worker_quit && queue_count == 0 && tile_queue_count == 0) {
+            SDL_CondWait(work_available, stream_lock);
+        }
+        if (worker_quit) break;
+
+        // Tiles re-requested by install_results_locked() go first; their
+        // chunks are already on screen
+        if (tile_queue_count > 0) {
+            TileId claimed[TILE_COUNT];
+            int claimed_count = tile_queue_count;
+            memcpy(claimed, tile_queue, sizeof(TileId) * tile_queue_count);
+            tile_queue_count = 0;
+            tiles_in_flight = 1;
+
+            decode_tiles_locked(claimed, claimed_count);
+
+            tiles_in_flight = 0;
+            SDL_CondBroadcast(work_done);
+            continue;
+        }
+
+        // Take the most urgent request
+        int best = 0;
+        for (int i = 1; i < queue_count; i++) {
+            if (queue[i].priority < queue[best].priority) best = i;
+        }
+        int index = queue[best].index;
+        queue[best] = queue[--queue_count];
+        in_flight = index;
+
+        SDL_UnlockMutex(stream_lock);
+        MapChunk* chunk = read_chunk(index);
+        SDL_LockMutex(stream_lock);
+
+        // Claim tile types nobody has decoded yet
+        TileId claimed[TILE_COUNT];
+        int claimed_count = 0;
+        for (int i = 0; chunk && i < MAP_CHUNK_TILES; i++) {
+            TileId id = chunk->tiles[i];
+            if (id < TILE_COUNT && !tile_requested[id]) {
+                tile_requested[id] = 1;
+                claimed[claimed_count++] = id;
+            }
+        }
+
+        decode_tiles_locked(claimed, claimed_count);
+
+        results[result_count++] = (StreamResult){ index, chunk };
+        in_flight = -1;
+        SDL_CondBroadcast(work_done);
+    }
+
+    SDL_UnlockMutex(stream_lock);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// LRU and Residency (simulation thread)
+// -----------------------------------------------------------------------------
+
+static void lru_unlink(int index) {
+    ChunkSlot* s = &slots[index];
+    if (s->lru_prev >= 0) slots[s->lru_prev].lru_next = s->lru_next;
+    else lru_head = s->lru_next;
+    if (s->lru_next >= 0) slots[s->lru_next].lru_prev = s->lru_prev;
+    else lru_tail = s->lru_prev;
+    s->lru_prev = s->lru_next = -1;
+}
+
+static void lru_push_front(int index) {
+    ChunkSlot* s = &slots[index];
+    s->lru_prev = -1;
+    s->lru_next = lru_head;
+    if (lru_head >= 0) slots[lru_head].lru_prev = index;
+    lru_head = index;
+    if (lru_tail < 0) lru_tail = index;
+}
+
+// Adjusts tile_refs for every distinct tile type in a chunk.
+//
+// map_stream_upload_textures() may drop a tile's image while no resident
+// chunk uses it, including between the worker publishing a chunk and its
+// install here. So a tile going from 0 to 1 refs is queued for decoding
+// again if nothing has it requested. Caller holds stream_lock.
+static void count_chunk_tiles(const MapChunk* chunk, int delta) {
+    unsigned char seen[TILE_COUNT] = { 0 };
+    for (int i = 0; i < MAP_CHUNK_TILES; i++) {
+        TileId id = chunk->tiles[i];
+        if (id < TILE_COUNT && !seen[id]) {
+            seen[id] = 1;
+            tile_refs[id] += delta;
+
+            if (delta > 0 && tile_refs[id] == delta && !tile_requested[id]) {  // Was 0
+                tile_requested[id] = 1;
+                tile_queue[tile_queue_count++] = id;
+            }
+        }
+    }
+}
+
+// Installs finished loads. Caller holds stream_lock.
+static void install_results_locked(void) {
+    for (int i = 0; i < result_count; i++) {
+        StreamResult* r = &results[i];
+        ChunkSlot* s = &slots[r->index];
+
+        if (!r->chunk) {
+            printf("MapStream: failed to read chunk %d\n", r->index);
+            s->state = SLOT_FAILED;
+            continue;
+        }
+
+        world_map.chunks[r->index] = r->chunk;
+        if (!map_refresh_chunk(r->index % world_map.chunks_x, r->index / world_map.chunks_x)) {
+            // No page for its planes: leave it out and read it again later
+            world_map.chunks[r->index] = &map_void_chunk;
+            free(r->chunk);
+            s->state = SLOT_NONRESIDENT;
+            continue;
+        }
+        s->state = SLOT_RESIDENT;
+        resident_bytes += sizeof(MapChunk);
+        count_chunk_tiles(r->chunk, +1);
+        lru_push_front(r->index);
+    }
+    result_count = 0;
+
+    if (tile_queue_count > 0) {
+        SDL_CondSignal(work_available);
+    }
+}
+
+// Evicts a chunk. It is freed by map_stream_release_chunks() once no
+// snapshot the renderer may draw holds it. Caller holds stream_lock.
+// Returns 0 (chunk kept) if the retired list cannot grow.
+static int evict_chunk_locked(int index) {
+    MapChunk* chunk = world_map.chunks[index];
+
+    if (retired_count == retired_capacity) {
+        int capacity = retired_capacity ? retired_capacity * 2 : 64;
+        RetiredChunk* grown = realloc(retired, sizeof(RetiredChunk) * capacity);
+        if (!grown) return 0;
+        retired = grown;
+        retired_capacity = capacity;
+    }
+    retired[retired_count++] = (RetiredChunk){ chunk, published_epoch + 1 };
+
+    lru_unlink(index);
+    count_chunk_tiles(chunk, -1);
+    world_map.chunks[index] = &map_void_chunk;
+    map_refresh_chunk(index % world_map.chunks_x, index / world_map.chunks_x);
+
+    slots[index].state = SLOT_NONRESIDENT;
+    resident_bytes -= sizeof(MapChunk);
+    return 1;
+}
+
+// Evicts least-recently-wanted chunks while over budget. Chunks wanted this
+// tick are never evicted, so a budget smaller than the wanted area just
+// over-commits instead of thrashing. Caller holds stream_lock.
+static void evict_over_budget_locked(void) {
+    while (resident_bytes > budget && lru_tail >= 0 &&
+           slots[lru_tail].last_wanted != stream_tick) {
+        if (!evict_chunk_locked(lru_tail)) break;
+    }
+}
+
+static int chebyshev(int ax, int ay, int bx, int by) {
+    int dx = abs(ax - bx);
+    int dy = abs(ay - by);
+    return dx > dy ? dx : dy;
+}
+
+// Rebuilds the request queue for the area around chunk (cx, cy) and the
+// look-ahead chunk (ax, ay). Caller holds stream_lock.
+static void request_area_locked(int cx, int cy, int ax, int ay) {
+    // Drop requests the worker has not started; they are re-added below if
+    // still wanted, with fresh priorities
+    for (int i = 0; i < queue_count; i++) {
+        slots[queue[i].index].state = SLOT_NONRESIDENT;
+    }
+    queue_count = 0;
+
+    int r = MAP_STREAM_RADIUS;
+    int min_x = (cx < ax ? cx : ax) - r, max_x = (cx > ax ? cx : ax) + r;
+    int min_y = (cy < ay ? cy : ay) - r, max_y = (cy > ay ? cy : ay) + r;
+    if (min_x < 0) min_x = 0;
+    if (min_y < 0) min_y = 0;
+    if (max_x >= world_map.chunks_x) max_x = world_map.chunks_x - 1;
+    if (max_y >= world_map.chunks_y) max_y = world_map.chunks_y - 1;
+
+    for (int y = min_y; y <= max_y; y++) {
+        for (int x = min_x; x <= max_x; x++) {
+            int around = chebyshev(x, y, cx, cy);
+            int ahead = chebyshev(x, y, ax, ay);
+            if (around > r && ahead > r) continue;
+
+            // Interleave: ring n around the camera, then ring n ahead
+            int priority = around <= r ? around * 2 : ahead * 2 + 1;
+            if (ahead <= r && ahead * 2 + 1 < priority) priority = ahead * 2 + 1;
+
+            int index = y * world_map.chunks_x + x;
+            ChunkSlot* s = &slots[index];
+            s->last_wanted = stream_tick;
+
+            if (s->state == SLOT_RESIDENT) {
+                lru_unlink(index);
+                lru_push_front(index);
+            } else if (s->state == SLOT_NONRESIDENT && index != in_flight) {
+                s->state = SLOT_REQUESTED;
+                queue[queue_count++] = (StreamRequest){ index, priority };
+            }
+        }
+    }
+
+    if (queue_count > 0) {
+        SDL_CondSignal(work_available);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+int map_stream_open(const char* filename, size_t budget_bytes) {
+    if (!is_map_file(filename)) return 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Failed to open map file: %s\n", filename);
+        return 0;
+    }
+
+    struct stat st;
+    MapFileHeader header;
+    if (fstat(fd, &st) != 0 ||
+        pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        !validate_map_file_header(&header, (uint64_t)st.st_size)) {
+        printf("Invalid map file: %s\n", filename);
+        close(fd);
+        return 0;
+    }
+
+    size_t chunk_count = (size_t)header.chunks_x * header.chunks_y;
+    size_t table_bytes = chunk_count * header.layer_count * sizeof(uint64_t);
+    uint64_t* table = malloc(table_bytes);
+    uint64_t* offsets = malloc(chunk_count * sizeof(uint64_t));
+    MapChunk** chunks = malloc(chunk_count * sizeof(MapChunk*));
+    ChunkSlot* new_slots = calloc(chunk_count, sizeof(ChunkSlot));
+    StreamRequest* new_queue = malloc(chunk_count * sizeof(StreamRequest));
+    StreamResult* new_results = malloc(chunk_count * sizeof(StreamResult));
+
+    int ok = table && offsets && chunks && new_slots && new_queue && new_results &&
+             pread(fd, table, table_bytes, (off_t)header.chunk_table_offset) == (ssize_t)table_bytes;
+
+    for (size_t i = 0; ok && i < chunk_count; i++) {
+        offsets[i] = table[i * header.layer_count + MAP_LAYER_GROUND];
+        ok = validate_map_chunk_offset(&header, offsets[i], (uint64_t)st.st_size);
+    }
+    free(table);
+
+    if (!ok) {
+        printf("Invalid map file: %s (chunk table)\n", filename);
+        free(offsets);
+        free(chunks);
+        free(new_slots);
+        free(new_queue);
+        free(new_results);
+        close(fd);
+        return 0;
+    }
+
+    map_free();
+
+    for (int i = 0; i < MAP_CHUNK_TILES; i++) {
+        map_void_chunk.tiles[i] = MAP_TILE_VOID;
+    }
+    for (size_t i = 0; i < chunk_count; i++) {
+        chunks[i] = &map_void_chunk;
+        new_slots[i].lru_prev = new_slots[i].lru_next = -1;
+    }
+
+    world_map.width = (int)header.width;
+    world_map.height = (int)header.height;
+    world_map.chunks_x = (int)header.chunks_x;
+    world_map.chunks_y = (int)header.chunks_y;
+    world_map.chunks = chunks;
+    world_map.on_free = map_stream_close;
+
+    // Every chunk starts void, so the planes start (and stay) all-blocked
+    // until chunks are installed
+    if (!map_init_planes()) {
+        map_free();
+        free(offsets);
+        free(new_slots);
+        free(new_queue);
+        free(new_results);
+        close(fd);
+        return 0;
+    }
+
+    stream_fd = fd;
+    chunk_offsets = offsets;
+    slots = new_slots;
+    queue = new_queue;
+    results = new_results;
+    lru_head = lru_tail = -1;
+    stream_tick = 0;
+    budget = budget_bytes;
+    resident_bytes = 0;
+    queue_count = result_count = decoded_count = 0;
+    tile_queue_count = tiles_in_flight = 0;
+    in_flight = -1;
+    worker_quit = 0;
+    memset(tile_refs, 0, sizeof(tile_refs));
+    memset(texture_bytes, 0, sizeof(texture_bytes));
+    memset(tile_requested, 0, sizeof(tile_requested));
+
+    stream_lock = SDL_CreateMutex();
+    work_available = SDL_CreateCond();
+    work_done = SDL_CreateCond();
+    stream_active = 1;
+
+    worker = stream_lock && work_available && work_done
+        ? SDL_CreateThread(stream_worker, "map_stream", NULL)
+        : NULL;
+    if (!worker) {
+        printf("MapStream: failed to start worker: %s\n", SDL_GetError());
+        map_free();
+        return 0;
+    }
+
+    return 1;
+}
+
+void map_stream_close(void) {
+    if (!stream_active) return;
+
+    if (worker) {
+        SDL_LockMutex(stream_lock);
+        worker_quit = 1;
+        SDL_CondSignal(work_available);
+        SDL_UnlockMutex(stream_lock);
+        SDL_WaitThread(worker, NULL);
+        worker = NULL;
+    }
+
+    // Free finished-but-uninstalled loads, decoded images and evicted chunks
+    // (nothing draws while the map is being replaced)
+    for (int i = 0; i < result_count; i++) free(results[i].chunk);
+    for (int i = 0; i < decoded_count; i++) SDL_FreeSurface(decoded[i].surface);
+    for (int i = 0; i < retired_count; i++) free(retired[i].chunk);
+    free(retired);
+    retired = NULL;
+    retired_count = retired_capacity = 0;
+
+    size_t chunk_count = (size_t)world_map.chunks_x * world_map.chunks_y;
+    for (size_t i = 0; world_map.chunks && i < chunk_count; i++) {
+        if (world_map.chunks[i] != &map_void_chunk) free(world_map.chunks[i]);
+        world_map.chunks[i] = &map_void_chunk;
+    }
+
+    for (int id = 0; id < TILE_COUNT; id++) {
+        release_tile_image((TileId)id);
+    }
+
+    if (stream_lock) SDL_DestroyMutex(stream_lock);
+    if (work_available) SDL_DestroyCond(work_available);
+    if (work_done) SDL_DestroyCond(work_done);
+    stream_lock = NULL;
+    work_available = work_done = NULL;
+
+    close(stream_fd);
+    stream_fd = -1;
+    free(chunk_offsets);
+    free(slots);
+    free(queue);
+    free(results);
+    chunk_offsets = NULL;
+    slots = NULL;
+    queue = NULL;
+    results = NULL;
+    queue_count = result_count = decoded_count = tile_queue_count = 0;
+    resident_bytes = 0;
+    stream_active = 0;
+}
+
+int map_stream_active(void) {
+    return stream_active;
+}
+
+void map_stream_update(const Camera* cam, int dir_x, int dir_y) {
+    if (!stream_active) return;
+
+    stream_tick++;
+
+    int tile_x, tile_y;
+    camera_center_tile(cam, &tile_x, &tile_y);
+
+    int cx = tile_x >> MAP_CHUNK_SHIFT;
+    int cy = tile_y >> MAP_CHUNK_SHIFT;
+    int ax = cx + dir_x * MAP_STREAM_LOOKAHEAD;
+    int ay = cy + dir_y * MAP_STREAM_LOOKAHEAD;
+
+    SDL_LockMutex(stream_lock);
+    install_results_locked();
+    request_area_locked(cx, cy, ax, ay);
+    evict_over_budget_locked();
+    SDL_UnlockMutex(stream_lock);
+}
+
+void map_stream_release_chunks(uint32_t published, uint32_t drawn) {
+    published_epoch = published;
+
+    int kept = 0;
+    for (int i = 0; i < retired_count; i++) {
+        if ((int32_t)(drawn - retired[i].epoch) >= 0) {
+            free(retired[i].chunk);
+        } else {
+            retired[kept++] = retired[i];
+        }
+    }
+    retired_count = kept;
+}
+
+void map_stream_upload_textures(void) {
+    if (!stream_active) return;
+
+    DecodedTile ready[TILE_COUNT];
+    unsigned char wanted[TILE_COUNT];
+    unsigned char failed[TILE_COUNT] = { 0 };
+    unsigned char unused[TILE_COUNT];
+    int ready_count;
+
+    // Decide under the lock, so a chunk installed after this sees
+    // tile_requested cleared for every image given up here and asks again
+    SDL_LockMutex(stream_lock);
+    ready_count = decoded_count;
+    memcpy(ready, decoded, sizeof(DecodedTile) * decoded_count);
+    decoded_count = 0;
+
+    for (int i = 0; i < ready_count; i++) {
+        wanted[i] = tile_refs[ready[i].id] > 0;
+        if (!wanted[i]) tile_requested[ready[i].id] = 0;
+    }
+
+    // Images no resident chunk uses any more
+    for (int id = 0; id < TILE_COUNT; id++) {
+        unused[id] = tile_refs[id] == 0 && tile_sprites[id] != SPRITE_NONE;
+        if (unused[id]) tile_requested[id] = 0;
+    }
+    SDL_UnlockMutex(stream_lock);
+
+    size_t added = 0;
+    size_t removed = 0;
+    for (int i = 0; i < ready_count; i++) {
+        TileId id = ready[i].id;
+        SDL_Surface* surface = ready[i].surface;
+
+        if (wanted[i] && set_tile_image(id, surface)) {
+            removed += texture_bytes[id];
+            texture_bytes[id] = (size_t)TILE_WIDTH * TILE_HEIGHT * 4;  // One atlas cell
+            added += texture_bytes[id];
+        } else if (wanted[i]) {
+            failed[i] = 1;
+        }
+        SDL_FreeSurface(surface);
+    }
+
+    for (int id = 0; id < TILE_COUNT; id++) {
+        if (!unused[id]) continue;
+        release_tile_image((TileId)id);
+        removed += texture_bytes[id];
+        texture_bytes[id] = 0;
+    }
+
+    SDL_LockMutex(stream_lock);
+    resident_bytes = resident_bytes + added - removed;
+    for (int i = 0; i < ready_count; i++) {
+        if (failed[i]) tile_requested[ready[i].id] = 0;     // Ask again
+    }
+    SDL_UnlockMutex(stream_lock);
+}
+
+void map_stream_prefetch(int tile_x, int tile_y) {
+    if (!stream_active) return;
+
+    int cx = tile_x >> MAP_CHUNK_SHIFT;
+    int cy = tile_y >> MAP_CHUNK_SHIFT;
+
+    SDL_LockMutex(stream_lock);
+    stream_tick++;
+
+    while (1) {
+        install_results_locked();
+        request_area_locked(cx, cy, cx, cy);
+
+        if (queue_count == 0 && in_flight < 0 &&
+            tile_queue_count == 0 && !tiles_in_flight) {
+            break;
+        }
+        SDL_CondWait(work_done, stream_lock);
+    }
+
+    SDL_UnlockMutex(stream_lock);
+}
+
+int map_chunk_resident(int chunk_x, int chunk_y) {
+    if (chunk_x < 0 || chunk_x >= world_map.chunks_x ||
+        chunk_y < 0 || chunk_y >= world_map.chunks_y) {
+        return 0;
+    }
+    if (!stream_active) return 1;
+
+    return slots[chunk_y * world_map.chunks_x + chunk_x].state == SLOT_RESIDENT;
+}
+
+size_t map_stream_resident_bytes(void) {
+    if (!stream_active) return 0;
+
+    SDL_LockMutex(stream_lock);
+    size_t bytes = resident_bytes;
+    SDL_UnlockMutex(stream_lock);
+    return bytes;
+}
@@ -0,0 +1,120 @@
+// -----------------------------------------------------------------------------
+// map_stream.h
+//
+// Background streaming of map chunks (and their tile textures) around the
+// camera, for worlds that do not fit in memory at once.
+// This module handles:
+//
+// - Opening a .omap file in streaming mode (header + chunk table only)
+// - Deciding which chunks should be resident from the camera position and
+//   the player's movement direction
+// - Loading chunks and decoding tile images on a worker thread
+// - Installing loaded chunks into world_map and evicting cold ones (LRU)
+//   to stay under a memory budget
+//
+// Non-resident chunks point at a shared "void" chunk filled with
+// MAP_TILE_VOID, so map_get_tile() never needs a residency branch: void
+// tiles are simply unwalkable and not drawn.
+//
+// Threading:
+// - The worker thread only touches its own buffers and the shared request /
+//   result queues (guarded by one mutex, held for O(queue) work, never
+//   across I/O).
+// - Installing and evicting happen on the simulation thread inside
+//   map_stream_update(), so the simulation reads world_map without locks.
+//   Texture upload happens on the render thread inside
+//   map_stream_upload_textures(); the tile reference counts and the memory
+//   charge they share are guarded by the same mutex.
+// - The renderer never reads world_map's chunk table: it draws the chunks
+//   captured in its snapshot (MapView, see map.h). An evicted chunk is
+//   kept until map_stream_release_chunks() reports that the renderer has
+//   moved past every snapshot captured before the eviction.
+// - The main loop never waits on the worker; only map_stream_prefetch()
+//   (used during scene setup) blocks.
+//
+// Design goals:
+// - Main loop never blocks on disk
+// - Bounded memory (chunks + tile textures) with LRU eviction
+// - Chunks ahead of the player are requested before chunks behind
+// -----------------------------------------------------------------------------
+
+#ifndef MAP_STREAM_H
+#define MAP_STREAM_H
+
+#include "core/map.h"
+#include "render/camera.h"
+
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define MAP_STREAM_DEFAULT_BUDGET (64u * 1024u * 1024u)  // Chunks + tile textures, in bytes
+#define MAP_STREAM_RADIUS         2                      // Chunks kept around the camera
+#define MAP_STREAM_LOOKAHEAD      2                      // Extra chunks ahead of the player
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Opens a .omap file for streaming and makes it the current map.
+//
+// Only the header and chunk table are read; every chunk starts non-resident.
+// A worker thread is started to service load requests.
+//
+// Args:
+//   filename: Path to a .omap file
+//   budget_bytes: Memory budget for resident chunks and tile textures
+//
+// Returns:
+//   1 on success, 0 if the file is not a valid .omap or the thread fails.
+int map_stream_open(const char* filename, size_t budget_bytes);
+
+// Stops the worker, frees every resident chunk and releases the file.
+// Called by map_free(); safe to call when no stream is open.
+void map_stream_close(void);
+
+// Returns 1 if a stream is currently open.
+int map_stream_active(void);
+
+// Per-tick residency update (simulation thread, non-blocking).
+//
+// 1. Installs chunks the worker has finished loading
+// 2. Requests chunks around the camera, plus chunks ahead of the player
+//    in direction (dir_x, dir_y), nearest first
+// 3. Evicts least-recently-wanted chunks while over budget
+//
+// Args:
+//   cam: Camera as updated by update_camera()
+//   dir_x, dir_y: Player movement direction (-1, 0 or 1 on each axis)
+void map_stream_update(const Camera* cam, int dir_x, int dir_y);
+
+// Frees evicted chunks no snapshot can still draw (simulation thread).
+// Call before map_stream_update() each tick.
+//
+// Args:
+//   published: Epoch of the newest snapshot published; chunks evicted from
+//              now on are in every snapshot up to it, and in none after
+//   drawn: Oldest epoch the renderer may still be drawing (published + 1
+//          when nothing draws)
+void map_stream_release_chunks(uint32_t published, uint32_t drawn);
+
+// Uploads tile images decoded by the worker into the atlas and releases
+// the atlas cells of tile types no resident chunk uses any more. Call from
+// the render path (render thread).
+void map_stream_upload_textures(void);
+
+// Blocks until every chunk within MAP_STREAM_RADIUS of tile (x, y) is
+// resident. Intended for scene setup (spawn area), never the main loop.
+void map_stream_prefetch(int tile_x, int tile_y);
+
+// Returns 1 if chunk (chunk_x, chunk_y) is resident. Always 1 when the map
+// is not streamed; 0 for chunks outside the map.
+int map_chunk_resident(int chunk_x, int chunk_y);
+
+// Returns the bytes currently charged against the budget.
+size_t map_stream_resident_bytes(void);
+
+#endif  // MAP_STREAM_H
@@ -0,0 +1,285 @@
+// Implementation file for profiler.h
+// See profiler.h for detailed documentation.
+
+#include "core/profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    const char* name;
+    Uint64 start;
+    Uint64 end;
+} ProfileZone;
+
+typedef struct {
+    const char* name;
+    Uint64 calls;
+    Uint64 total;
+    Uint64 worst;
+} ProfileStat;
+
+typedef struct {
+    ProfileZone ring[PROFILE_RING_SIZE];
+    SDL_atomic_t written;                   // Zones ever written; ring index = written % size
+    ProfileZone open[PROFILE_MAX_DEPTH];    // Zones begun but not ended
+    int depth;                              // May exceed PROFILE_MAX_DEPTH; deeper zones are dropped
+    const char* name;
+    ProfileStat stats[PROFILE_MAX_STATS];   // Totals by zone name (pointer identity)
+    int stat_count;
+} ProfileThread;
+
+int profiler_enabled = 0;
+
+static int dump_frames = PROFILE_DEFAULT_FRAMES;
+
+static ProfileThread* threads[PROFILE_MAX_THREADS];
+static SDL_atomic_t thread_count;
+
+static __thread ProfileThread* this_thread = NULL;
+static __thread int this_thread_full = 0;   // Registration failed; record nothing
+
+static Uint64 frame_marks[PROFILE_MAX_FRAMES];
+static int frame_count = 0;                 // Render thread only
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+static ProfileThread* current_thread(void) {
+    if (this_thread || this_thread_full) return this_thread;
+
+    ProfileThread* t = calloc(1, sizeof(ProfileThread));
+    int index = SDL_AtomicAdd(&thread_count, 1);
+    if (!t || index >= PROFILE_MAX_THREADS) {
+        free(t);
+        this_thread_full = 1;
+        return NULL;
+    }
+
+    SDL_AtomicSetPtr((void**)&threads[index], t);
+    this_thread = t;
+    return t;
+}
+
+// Adds a finished zone to the thread's totals. Zone names are string
+// literals, so the pointer identifies the name; the few names in use keep
+// this a short scan.
+static void add_stat(ProfileThread* t, const ProfileZone* zone) {
+    ProfileStat* stat = NULL;
+    for (int i = 0; i < t->stat_count; i++) {
+        if (t->stats[i].name == zone->name) {
+            stat = &t->stats[i];
+            break;
+        }
+    }
+    if (!stat) {
+        if (t->stat_count == PROFILE_MAX_STATS) return;
+        stat = &t->stats[t->stat_count++];
+        stat->name = zone->name;
+    }
+
+    Uint64 time = zone->end - zone->start;
+    stat->calls++;
+    stat->total += time;
+    if (time > stat->worst) stat->worst = time;
+}
+
+// Copies the zones of t that ended at or after since. Returns how many
+// were written to out (capacity PROFILE_RING_SIZE).
+static int copy_zones(ProfileThread* t, Uint64 since, ProfileZone* out) {
+    // Counters are unsigned so they wrap cleanly on long sessions
+    unsigned written = (unsigned)SDL_AtomicGet(&t->written);
+    unsigned available = written < PROFILE_RING_SIZE ? written : PROFILE_RING_SIZE;
+    unsigned first = written - available;
+
+    int count = 0;
+    for (unsigned i = first; i != written; i++) {
+        out[count++] = t->ring[i & (PROFILE_RING_SIZE - 1)];
+    }
+
+    // The thread kept writing while we copied; anything it reached may be
+    // torn. It fills slot `written` before bumping the counter, so the
+    // oldest record may be half written even if the counter did not move.
+    unsigned now_written = (unsigned)SDL_AtomicGet(&t->written);
+    unsigned advanced = now_written - written;
+    int skip = advanced >= (unsigned)count ? count : (int)advanced + 1;
+
+    int kept = 0;
+    for (int i = skip; i < count; i++) {
+        if (out[i].end >= since) out[kept++] = out[i];
+    }
+    return kept;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+void profiler_init(int enabled, int frames) {
+    profiler_enabled = enabled;
+    dump_frames = frames > 0 ? frames : PROFILE_DEFAULT_FRAMES;
+    if (dump_frames > PROFILE_MAX_FRAMES) dump_frames = PROFILE_MAX_FRAMES;
+}
+
+void profiler_shutdown(void) {
+    int count = SDL_AtomicGet(&thread_count);
+    if (count > PROFILE_MAX_THREADS) count = PROFILE_MAX_THREADS;
+
+    for (int i = 0; i < count; i++) {
+        free(threads[i]);
+        threads[i] = NULL;
+    }
+    SDL_AtomicSet(&thread_count, 0);
+    this_thread = NULL;
+    profiler_enabled = 0;
+}
+
+void profile_thread_name(const char* name) {
+    if (!profiler_enabled) return;
+
+    ProfileThread* t = current_thread();
+    if (t) t->name = name;
+}
+
+void profile_begin(const char* name) {
+    ProfileThread* t = current_thread();
+    if (!t) return;
+
+    if (t->depth < PROFILE_MAX_DEPTH) {
+        t->open[t->depth].name = name;
+        t->open[t->depth].start = SDL_GetPerformanceCounter();
+    }
+    t->depth++;
+}
+
+void profile_end(void) {
+    ProfileThread* t = current_thread();
+    if (!t || t->depth == 0) return;
+
+    t->depth--;
+    if (t->depth >= PROFILE_MAX_DEPTH) return;
+
+    ProfileZone* zone = &t->open[t->depth];
+    zone->end = SDL_GetPerformanceCounter();
+
+    unsigned written = (unsigned)SDL_AtomicGet(&t->written);
+    t->ring[written & (PROFILE_RING_SIZE - 1)] = *zone;
+    SDL_AtomicSet(&t->written, (int)(written + 1));     // Publishes the record to profiler_dump()
+
+    add_stat(t, zone);
+}
+
+void profiler_frame(void) {
+    if (!profiler_enabled) return;
+
+    frame_marks[frame_count % PROFILE_MAX_FRAMES] = SDL_GetPerformanceCounter();
+    frame_count++;
+}
+
+int profiler_dump(const char* path) {
+    if (!profiler_enabled) {
+        printf("Profiler: not enabled (run with --profile)\n");
+        return 0;
+    }
+
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        printf("Profiler: cannot write %s\n", path);
+        return 0;
+    }
+
+    ProfileZone* zones = malloc(sizeof(ProfileZone) * PROFILE_RING_SIZE);
+    if (!zones) {
+        fclose(f);
+        return 0;
+    }
+
+    int frames = frame_count < dump_frames ? frame_count : dump_frames;
+    Uint64 since = frames > 0 ? frame_marks[(frame_count - frames) % PROFILE_MAX_FRAMES] : 0;
+    Uint64 origin = since;      // Trace time 0
+    double us_per_tick = 1000000.0 / SDL_GetPerformanceFrequency();
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"oblique\"}}");
+
+    int count = SDL_AtomicGet(&thread_count);
+    if (count > PROFILE_MAX_THREADS) count = PROFILE_MAX_THREADS;
+
+    int total = 0;
+    for (int tid = 0; tid < count; tid++) {
+        ProfileThread* t = SDL_AtomicGetPtr((void**)&threads[tid]);
+        if (!t) continue;       // Still registering
+
+        if (t->name) {
+            fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    tid, t->name);
+        }
+
+        int n = copy_zones(t, since, zones);
+        for (int i = 0; i < n; i++) {
+            double ts = ((double)zones[i].start - (double)origin) * us_per_tick;   // < 0 if begun before the window
+            fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    zones[i].name, tid, ts, (zones[i].end - zones[i].start) * us_per_tick);
+        }
+        total += n;
+    }
+
+    // Frame boundaries as global instant events
+    for (int i = frame_count - frames; i < frame_count; i++) {
+        Uint64 mark = frame_marks[i % PROFILE_MAX_FRAMES];
+        fprintf(f, ",\n{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}",
+                (mark - origin) * us_per_tick);
+    }
+
+    fprintf(f, "\n]}\n");
+    free(zones);
+    fclose(f);
+
+    printf("Profiler: wrote %d zones over %d frames to %s\n", total, frames, path);
+    return 1;
+}
+
+void profiler_print_summary(void) {
+    if (!profiler_enabled) return;
+
+    // Merge per-thread totals by name (different threads, different literals)
+    ProfileStat merged[PROFILE_MAX_STATS];
+    int merged_count = 0;
+
+    int count = SDL_AtomicGet(&thread_count);
+    if (count > PROFILE_MAX_THREADS) count = PROFILE_MAX_THREADS;
+
+    for (int tid = 0; tid < count; tid++) {
+        ProfileThread* t = SDL_AtomicGetPtr((void**)&threads[tid]);
+        if (!t) continue;
+
+        for (int i = 0; i < t->stat_count; i++) {
+            const ProfileStat* s = &t->stats[i];
+            int m = 0;
+            while (m < merged_count && strcmp(merged[m].name, s->name) != 0) m++;
+            if (m == merged_count) {
+                if (merged_count == PROFILE_MAX_STATS) continue;
+                merged[merged_count++] = (ProfileStat){ s->name, 0, 0, 0 };
+            }
+            merged[m].calls += s->calls;
+            merged[m].total += s->total;
+            if (s->worst > merged[m].worst) merged[m].worst = s->worst;
+        }
+    }
+
+    double ms_per_tick = 1000.0 / SDL_GetPerformanceFrequency();
+    printf("%-22s %10s %12s %10s %10s\n", "zone", "calls", "total ms", "avg us", "max us");
+    for (int m = 0; m < merged_count; m++) {
+        const ProfileStat* s = &merged[m];
+        double total_ms = s->total * ms_per_tick;
+        printf("%-22s %10llu %12.3f %10.3f %10.3f\n",
+               s->name, (unsigned long long)s->calls, total_ms,
+               total_ms * 1000.0 / (double)s->calls, s->worst * ms_per_tick * 1000.0);
+    }
+}
@@ -0,0 +1,97 @@
+// -----------------------------------------------------------------------------
+// profiler.h
+//
+// Scoped timing zones with Chrome trace export.
+// This module handles:
+//
+// - Timing named zones (PROFILE_BEGIN / PROFILE_END pairs, nestable)
+// - Keeping the most recent zones of every thread in a per-thread ring
+// - Marking frame boundaries on the render thread
+// - Per-zone totals (calls, total and worst time) for end-of-run summaries
+// - Writing the last N frames as Chrome trace JSON (chrome://tracing,
+//   Perfetto, Speedscope)
+//
+// Usage:
+//
+//   PROFILE_BEGIN("draw_map");
+//   ...
+//   PROFILE_END();
+//
+// Every PROFILE_BEGIN must be matched by a PROFILE_END on the same thread
+// before the enclosing zone ends (watch early returns). Zones opened inside
+// other zones show up nested in the trace viewer.
+//
+// Cost:
+// - Disabled (default): one load and branch per macro
+// - Enabled: two performance-counter reads plus a ring write per zone, no
+//   locks and no allocation after the thread's first zone
+//
+// Threads:
+//   Each thread gets its own ring on its first zone (up to
+//   PROFILE_MAX_THREADS; zones of further threads are dropped). Rings are
+//   written only by their thread; profiler_dump() reads them from another
+//   thread and discards any record that was overwritten while it copied.
+//
+// Design goals:
+// - Cheap enough to leave the zones in shipping code
+// - Spikes inspectable after the fact (the rings always hold recent history)
+// -----------------------------------------------------------------------------
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define PROFILE_MAX_THREADS     16
+#define PROFILE_RING_SIZE       262144  // Zones kept per thread (power of two, 6 MB)
+#define PROFILE_MAX_DEPTH       32      // Nesting limit per thread
+#define PROFILE_MAX_FRAMES      1024    // Frame marks kept
+#define PROFILE_DEFAULT_FRAMES  120     // Frames written by profiler_dump()
+#define PROFILE_MAX_STATS       64      // Distinct zone names totalled per thread
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+extern int profiler_enabled;    // Set once by profiler_init(), before threads start
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+#define PROFILE_BEGIN(name) do { if (profiler_enabled) profile_begin(name); } while (0)
+#define PROFILE_END()       do { if (profiler_enabled) profile_end(); } while (0)
+
+// Turns zone recording on or off and sets how many frames profiler_dump()
+// writes (<= 0 keeps PROFILE_DEFAULT_FRAMES). Call before any zone runs.
+void profiler_init(int enabled, int dump_frames);
+
+// Frees the per-thread rings. Call after every profiled thread has stopped.
+void profiler_shutdown(void);
+
+// Names the calling thread in the trace ("main", "simulation").
+void profile_thread_name(const char* name);
+
+// Opens a zone. name must outlive the profiler (use string literals).
+void profile_begin(const char* name);
+
+// Closes the innermost open zone of the calling thread.
+void profile_end(void);
+
+// Marks the start of a frame. Call once per frame on the render thread.
+void profiler_frame(void);
+
+// Writes every zone of the last dump_frames frames, from all threads, to
+// path as Chrome trace JSON. Returns 1 on success, 0 on failure.
+int profiler_dump(const char* path);
+
+// Prints calls, total, average and worst time of every zone name since
+// profiler_init(), summed over all threads. Call once profiled threads
+// have stopped.
+void profiler_print_summary(void);
+
+#endif  // PROFILER_H
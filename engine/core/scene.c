@@ -1,6 +1,9 @@
 #include "core/scene.h"
 #include "core/map.h"
+#include "core/map_stream.h"
 #include "core/constants.h"
+#include "core/sim.h"
+#include "core/profiler.h"
 // #include "core/combat.h"
 #include "entity/entity.h"
 #include "render/camera.h"
@@ -9,10 +12,13 @@
 #include "navigation/grid.h"
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_image.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+#define PLAYER_SPAWN_X 5
+#define PLAYER_SPAWN_Y 5
+#define EXPLORE_MOVE_RANGE 10     // Move grid budget outside combat (AP in combat)
+
 static SceneType current_scene = SCENE_EXPLORE;
 static int player_id = -1;
 static Camera camera;
@@ -20,6 +26,7 @@ static int combat_active = 0;
 static int combat_forced = 0;
 static int active_turn_index = 0;
 static int turn_started = 0;
+static const char* scene_map = NULL;    // NULL = DEFAULT_MAP
 
 static void start_combat(void);
 static void end_combat(void);
@@ -98,16 +105,12 @@ static void update_combat_state(void) {
     }
 }
 
-static void draw_ap_counter(SDL_Renderer* renderer, Entity* entity) {
-    if (!entity) return;
-
+static void draw_ap_counter(SDL_Renderer* renderer, int ap_current, int ap_max) {
     const int start_x = 20;
     const int start_y = 20;
     const int box_size = 12;
     const int box_gap = 4;
 
-    int ap_max = entity->ap_max;
-    int ap_current = entity->ap_current;
     if (ap_max < 0) ap_max = 0;
     if (ap_current < 0) ap_current = 0;
     if (ap_current > ap_max) ap_current = ap_max;
@@ -175,21 +178,31 @@ static void update_combat_turns(void) {
     }
 }
 
+void set_scene_map(const char* path) {
+    scene_map = path;
+}
+
 void setup_explore_scene(SDL_Renderer* renderer) {
     init_entities();        // resets entities array
-    load_map(DEFAULT_MAP);
-    load_tile_textures(renderer);
+
+    // Stream .omap maps around the camera; fall back to loading text maps whole
+    const char* map_path = scene_map ? scene_map : DEFAULT_MAP;
+    if (map_stream_open(map_path, MAP_STREAM_DEFAULT_BUDGET)) {
+        map_stream_prefetch(PLAYER_SPAWN_X, PLAYER_SPAWN_Y);   // Block once for the spawn area
+        map_stream_upload_textures();
+    } else {
+        load_map(map_path);
+        load_tile_images();
+    }
 
     calculate_map_offset();
 
     // Load player sprites
-    SDL_Surface* surface = IMG_Load(PLAYER_SPRITE);
-    SDL_Texture* player_texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+    SpriteId player_sprite = atlas_add_image(PLAYER_SPRITE);
 
     player_id = add_entity(
-            5, 5,
-            player_texture,
+            PLAYER_SPAWN_X, PLAYER_SPAWN_Y,
+            player_sprite,
             32, 64,
             16,   // offset_x: center sprite horizontally (TILE_WIDTH/2 - sprite_width/2 = 32 - 16 = 16)
             -48,  // offset_y: align feet with tile center
@@ -201,15 +214,13 @@ void setup_explore_scene(SDL_Renderer* renderer) {
     );
 
     // NPC sprite (shared for idle/wander/chase for now)
-    SDL_Surface* npc_surf = IMG_Load(NPC_SPRITE);
-    SDL_Texture* npc_tex  = SDL_CreateTextureFromSurface(renderer, npc_surf);
-    SDL_FreeSurface(npc_surf);
+    SpriteId npc_sprite = atlas_add_image(NPC_SPRITE);
 
-    int npc_id = add_entity(10, 10, npc_tex, 32, 64, 16, -48, 0, wander_behavior);
+    int npc_id = add_entity(10, 10, npc_sprite, 32, 64, 16, -48, 0, wander_behavior);
     entities[npc_id].state = STATE_IDLE;
-    entities[npc_id].sprite_idle   = npc_tex;
-    entities[npc_id].sprite_wander = npc_tex;
-    entities[npc_id].sprite_chase  = npc_tex;
+    entities[npc_id].sprite_idle   = npc_sprite;
+    entities[npc_id].sprite_wander = npc_sprite;
+    entities[npc_id].sprite_chase  = npc_sprite;
 }
 
 void setup_combat_scene(SDL_Renderer* renderer) {
@@ -231,10 +242,24 @@ void set_scene(SceneType type, SDL_Renderer* renderer) {
 }
 
 void update_scene() {
+    PROFILE_BEGIN("update_scene");
+
     Entity* player = get_player();
     if (player) {
-        update_camera(&camera, player->x, player->y);
-        calculate_move_grid(player->x, player->y, 10);
+        // Follow the sliding position; snapshots interpolate the camera between ticks
+        update_camera(&camera, player->render_x, player->render_y);
+
+        // Stream ahead of where the player is heading
+        int dir_x = player->moving ? (player->to_x > player->x) - (player->to_x < player->x) : 0;
+        int dir_y = player->moving ? (player->to_y > player->y) - (player->to_y < player->y) : 0;
+        uint32_t published, drawn;
+        sim_view_epochs(&published, &drawn);
+        map_stream_release_chunks(published, drawn);
+        map_stream_update(&camera, dir_x, dir_y);
+
+        // Refilled only when the player, the budget or tiles in range change
+        calculate_move_grid(player->x, player->y,
+                            combat_active ? player->ap_current : EXPLORE_MOVE_RANGE);
     }
 
     switch (current_scene) {
@@ -249,17 +274,25 @@ void update_scene() {
 
     update_combat_state();
     update_combat_turns();
+
+    PROFILE_END();
 }
 
-void render_scene(SDL_Renderer* renderer) {
-    calculate_map_offset();
-    draw_map(renderer, &camera);            // 1. draw map tiles
-    draw_move_grid(renderer, &camera);      // 2. draw grid UNDER player
-    draw_entities(renderer, &camera);       // 3. draw player + NPCs
+void render_scene(SDL_Renderer* renderer, const WorldSnapshot* snapshot, float alpha) {
+    // Camera blended between the snapshot tick and the one before, like entities
+    Camera view = sim_snapshot_camera(snapshot, alpha);
+
+    map_stream_upload_textures();           // Tile images decoded by the streaming worker
+    draw_map(renderer, &view, &snapshot->map);                  // 1. draw map tiles
+
+    draw_move_grid(renderer, &view, &snapshot->selection,      // 2. draw grid UNDER player
+                   &snapshot->move_range);
+    draw_entities(renderer, &view, snapshot->entities,          // 3. draw player + NPCs
+                  snapshot->entity_count, alpha);
                                             // 4. UI (Coming soon)
 
-    if (is_combat_active()) {
-        draw_ap_counter(renderer, get_player());
+    if (snapshot->combat_active && snapshot->player_ap_max >= 0) {
+        draw_ap_counter(renderer, snapshot->player_ap_current, snapshot->player_ap_max);
     }
 }
 
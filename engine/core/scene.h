@@ -4,6 +4,7 @@
 #include <SDL2/SDL.h>
 
 struct Entity;
+struct WorldSnapshot;
 
 typedef enum {
     SCENE_EXPLORE,
@@ -14,6 +15,9 @@ typedef enum {
 
 void set_scene(SceneType type, SDL_Renderer* renderer);
 
+// Map loaded by the next scene setup (NULL = DEFAULT_MAP).
+void set_scene_map(const char* path);
+
 SceneType get_scene();
 int is_combat_active(void);
 int is_combat_forced(void);
@@ -23,7 +27,7 @@ int is_entity_turn(struct Entity* e);
 
 void update_scene();
 void setup_explore_scene(SDL_Renderer* renderer);
-void render_scene(SDL_Renderer* renderer);
+void render_scene(SDL_Renderer* renderer, const struct WorldSnapshot* snapshot, float alpha);
 
 Camera* get_camera(void);
 
@@ -0,0 +1,245 @@
+// Implementation file for sim.h
+// See sim.h for detailed documentation.
+
+#include "core/sim.h"
+#include "core/scene.h"
+#include "core/timestep.h"
+#include "core/profiler.h"
+#include "entity/entity.h"
+#include "entity/player.h"
+#include "navigation/pathfinding.h"
+#include "navigation/path_jobs.h"
+
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+#define SLOT_MASK   3       // Slot index bits of middle_slot
+#define SLOT_FRESH  4       // middle_slot holds a snapshot the renderer has not taken
+
+static WorldSnapshot snapshots[SIM_SNAPSHOT_SLOTS];
+static int write_slot = 0;                  // Simulation thread only
+static int read_slot = 1;                   // Render thread only
+static SDL_atomic_t middle_slot = { 2 };    // Slot index | SLOT_FRESH
+
+static SimInput input_queue[SIM_INPUT_QUEUE];
+static SDL_atomic_t input_head;             // Next slot to write (render thread)
+static SDL_atomic_t input_tail;             // Next slot to read (simulation thread)
+
+static SDL_Thread* sim_thread = NULL;
+static SDL_atomic_t sim_running;
+
+static Camera prev_camera;                  // Scene camera before the latest tick
+static int ticks_simulated = 0;
+
+static uint32_t published_epoch = 0;        // Simulation thread
+static SDL_atomic_t drawn_epoch;            // Epoch of the renderer's slot
+static int has_renderer = 1;               // Something reads the snapshots
+
+// -----------------------------------------------------------------------------
+// Simulation Thread
+// -----------------------------------------------------------------------------
+
+static void apply_input(SimInput* input) {
+    if (input->event.type == SDL_MOUSEBUTTONDOWN) {
+        Entity* player = get_player();
+        if (player) {
+            handle_player_input(player, &input->event, &input->camera);
+        }
+    }
+}
+
+static int sim_thread_main(void* data) {
+    profile_thread_name("simulation");
+
+    while (SDL_AtomicGet(&sim_running)) {
+        // Sleep until a tick is owed; timestep_advance() keeps the remainder
+        int ticks = timestep_advance();
+        if (ticks == 0) {
+            SDL_Delay(1);
+            continue;
+        }
+
+        while (ticks-- > 0) {
+            sim_tick();
+        }
+
+        sim_publish();
+    }
+
+    release_path_workspace();
+    return 0;
+}
+
+// Captures the chunks under both cameras of a snapshot, or only the newer
+// camera's if both do not fit in one MapView (a jump).
+static void capture_map_view(MapView* view, const Camera* prev, const Camera* cam) {
+    int x0, y0, x1, y1;
+    int px0, py0, px1, py1;
+    camera_visible_chunks(cam, &x0, &y0, &x1, &y1);
+    camera_visible_chunks(prev, &px0, &py0, &px1, &py1);
+
+    int ux0 = px0 < x0 ? px0 : x0;
+    int uy0 = py0 < y0 ? py0 : y0;
+    int ux1 = px1 > x1 ? px1 : x1;
+    int uy1 = py1 > y1 ? py1 : y1;
+    if (ux1 - ux0 < MAP_VIEW_SIDE && uy1 - uy0 < MAP_VIEW_SIDE) {
+        x0 = ux0;
+        y0 = uy0;
+        x1 = ux1;
+        y1 = uy1;
+    }
+    map_view_capture(view, x0, y0, x1, y1);
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+int sim_init(int rendering) {
+    has_renderer = rendering;
+
+    SDL_AtomicSet(&input_head, 0);
+    SDL_AtomicSet(&input_tail, 0);
+    ticks_simulated = 0;
+    prev_camera = *get_camera();
+
+    // Same snapshot in the renderer's slot and the middle one, so the first
+    // frame has something to draw whether or not the middle is taken
+    sim_publish();
+    snapshots[read_slot] = snapshots[SDL_AtomicGet(&middle_slot) & SLOT_MASK];
+    SDL_AtomicSet(&drawn_epoch, (int)snapshots[read_slot].epoch);
+    return 1;
+}
+
+int sim_start(void) {
+    if (sim_thread) return 1;
+
+    // Without workers the simulation thread serves path requests itself
+    path_jobs_start();
+
+    SDL_AtomicSet(&sim_running, 1);
+    sim_thread = SDL_CreateThread(sim_thread_main, "simulation", NULL);
+    if (!sim_thread) {
+        printf("Failed to start simulation thread: %s\n", SDL_GetError());
+        SDL_AtomicSet(&sim_running, 0);
+        path_jobs_stop();
+        return 0;
+    }
+    return 1;
+}
+
+void sim_stop(void) {
+    if (!sim_thread) return;
+
+    SDL_AtomicSet(&sim_running, 0);
+    SDL_WaitThread(sim_thread, NULL);
+    sim_thread = NULL;
+    path_jobs_stop();
+}
+
+void sim_shutdown(void) {
+    path_jobs_stop();
+}
+
+void sim_tick(void) {
+    path_jobs_update();
+
+    SimInput input;
+    while (sim_pop_input(&input)) {
+        apply_input(&input);
+    }
+
+    prev_camera = *get_camera();
+    update_scene();
+    ticks_simulated++;
+}
+
+void sim_publish(void) {
+    WorldSnapshot* s = &snapshots[write_slot];
+
+    s->published = SDL_GetPerformanceCounter();
+    s->tick = ticks_simulated;
+    s->epoch = ++published_epoch;
+    s->prev_camera = prev_camera;
+    s->camera = *get_camera();
+    capture_map_view(&s->map, &s->prev_camera, &s->camera);
+    s->selection = selected_tile;
+    s->combat_active = is_combat_active();
+
+    Entity* player = get_player();
+    s->player_ap_current = player ? player->ap_current : -1;
+    s->player_ap_max = player ? player->ap_max : -1;
+    if (s->combat_active && player) {
+        get_move_range_view(&s->move_range);
+    } else {
+        s->move_range.radius = -1;
+    }
+
+    s->entity_count = build_entity_views(s->entities);
+
+    // Hand the finished slot over and take back whichever one was in the middle
+    int old = SDL_AtomicSet(&middle_slot, write_slot | SLOT_FRESH);
+    write_slot = old & SLOT_MASK;
+}
+
+const WorldSnapshot* sim_latest_snapshot(void) {
+    if (SDL_AtomicGet(&middle_slot) & SLOT_FRESH) {
+        int old = SDL_AtomicSet(&middle_slot, read_slot);
+        read_slot = old & SLOT_MASK;
+
+        // Done with every older snapshot: the one given back is never read again
+        SDL_AtomicSet(&drawn_epoch, (int)snapshots[read_slot].epoch);
+    }
+    return &snapshots[read_slot];
+}
+
+float sim_snapshot_alpha(const WorldSnapshot* snapshot) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (now <= snapshot->published) return 0.0f;
+
+    double elapsed = (double)(now - snapshot->published) / SDL_GetPerformanceFrequency();
+    float alpha = (float)(elapsed * tick_rate);
+    return alpha < 1.0f ? alpha : 1.0f;
+}
+
+Camera sim_snapshot_camera(const WorldSnapshot* snapshot, float alpha) {
+    const Camera* a = &snapshot->prev_camera;
+    const Camera* b = &snapshot->camera;
+    Camera view = {
+        (int)(a->x + (b->x - a->x) * alpha),
+        (int)(a->y + (b->y - a->y) * alpha)
+    };
+    return view;
+}
+
+int sim_push_input(const SDL_Event* event, const Camera* camera) {
+    int head = SDL_AtomicGet(&input_head);
+    int tail = SDL_AtomicGet(&input_tail);
+    if (head - tail >= SIM_INPUT_QUEUE) return 0;
+
+    SimInput* slot = &input_queue[head & (SIM_INPUT_QUEUE - 1)];
+    slot->event = *event;
+    slot->camera = *camera;
+
+    SDL_AtomicSet(&input_head, head + 1);   // Publishes the slot to the consumer
+    return 1;
+}
+
+int sim_pop_input(SimInput* input) {
+    int tail = SDL_AtomicGet(&input_tail);
+    int head = SDL_AtomicGet(&input_head);
+    if (tail == head) return 0;
+
+    *input = input_queue[tail & (SIM_INPUT_QUEUE - 1)];
+
+    SDL_AtomicSet(&input_tail, tail + 1);   // Returns the slot to the producer
+    return 1;
+}
+
+void sim_view_epochs(uint32_t* published, uint32_t* drawn) {
+    *published = published_epoch;
+    *drawn = has_renderer ? (uint32_t)SDL_AtomicGet(&drawn_epoch) : published_epoch + 1;
+}
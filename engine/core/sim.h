@@ -0,0 +1,162 @@
+// -----------------------------------------------------------------------------
+// sim.h
+//
+// Simulation thread and the hand-off between simulation and rendering.
+// This module handles:
+//
+// - Running update_scene() on its own thread at the fixed tick rate
+//   (see timestep.h), independent of how long frames take to render
+// - Publishing an immutable WorldSnapshot after each batch of ticks
+//   through a lock-free triple buffer
+// - Carrying input events from the render thread to the simulation over a
+//   single-producer / single-consumer queue
+// - Snapshot epochs, which tell the map streamer when the renderer can no
+//   longer be drawing a chunk it evicted
+//
+// Threads:
+//
+//   Simulation thread            Render (main) thread
+//   -----------------            --------------------
+//   pop input -> handle          poll SDL events -> sim_push_input()
+//   update_scene() x ticks       sim_latest_snapshot()
+//   sim_publish()                render_scene(snapshot, alpha)
+//
+// Triple buffer:
+//
+//   Three snapshot slots: the simulation owns one (write), the renderer owns
+//   one (read), and the third (middle) is exchanged with a single atomic
+//   swap. Publishing swaps write <-> middle and marks middle fresh; reading
+//   swaps read <-> middle only when it is fresh. Neither side ever waits on
+//   the other, the renderer always sees the newest complete tick, and
+//   snapshots it skipped are simply overwritten.
+//
+// Ownership:
+// - Entities, AI, pathfinding, the move grid and the scene camera belong to
+//   the simulation thread; path workers (see path_jobs.h) search snapshots
+//   of the navigation planes, never world_map itself
+// - SDL rendering, the atlas and the terrain cache belong to the main thread
+// - world_map belongs to the simulation; each snapshot carries the chunks
+//   around its camera (MapView, see map.h), and the streamer frees an
+//   evicted chunk only once sim_view_epochs() says no snapshot drawn from
+//   then on can hold it
+//
+// Design goals:
+// - A slow frame never slows the simulation, a slow tick never stalls a frame
+// - The renderer reads only snapshot data, never live entity state
+// - No allocation and no locking on the snapshot path
+// -----------------------------------------------------------------------------
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "entity/entity.h"
+#include "navigation/grid.h"
+#include "render/camera.h"
+#include "core/map.h"
+
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define SIM_SNAPSHOT_SLOTS  3
+#define SIM_INPUT_QUEUE     256     // Power of two; events past a full queue are dropped
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Everything the renderer needs from one simulation tick. Written only by
+// the simulation, read only by the renderer, never both at once.
+typedef struct WorldSnapshot {
+    Uint64 published;           // SDL_GetPerformanceCounter() when published
+    int tick;                   // Ticks simulated when published
+    uint32_t epoch;             // Publish count, see sim_view_epochs()
+
+    Camera prev_camera;         // Camera one tick earlier (interpolated like entities)
+    Camera camera;
+
+    GridSelection selection;    // Highlighted tile
+    int combat_active;
+    int player_ap_current;      // AP counter, -1 without a player
+    int player_ap_max;
+    MoveRangeView move_range;   // Player's AP range in combat (radius -1 otherwise)
+
+    MapView map;                // Chunks around both cameras
+
+    int entity_count;
+    EntityView entities[MAX_ENTITIES];
+} WorldSnapshot;
+
+// An input event plus the camera of the frame it was made against, so a
+// click maps to the tile that was under the cursor on screen.
+typedef struct {
+    SDL_Event event;
+    Camera camera;
+} SimInput;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Publishes an initial snapshot of the current scene. Call after
+// set_scene(), before sim_start().
+//
+// Args:
+//   rendering: 0 if nothing will read snapshots (headless runs without
+//              rendering), so evicted map chunks need not wait for a frame
+//
+// Returns:
+//   1 on success.
+int sim_init(int rendering);
+
+// Starts the path workers (see path_jobs.h) and the simulation thread.
+// Returns 1 on success, 0 on failure.
+int sim_start(void);
+
+// Stops the simulation thread and waits for it to finish its current tick,
+// then stops the path workers.
+void sim_stop(void);
+
+// Drops outstanding path requests. Call after sim_stop().
+void sim_shutdown(void);
+
+// Runs one simulation tick: attaches finished path requests and starts
+// pending ones (path_jobs_update()), applies queued input, then
+// update_scene().
+// The simulation thread calls this; headless runs call it directly.
+void sim_tick(void);
+
+// Copies the current simulation state into the write slot and makes it the
+// newest snapshot. Called by the simulation thread after its ticks; safe to
+// call directly when the simulation is driven without the thread.
+void sim_publish(void);
+
+// Returns the newest published snapshot. The snapshot stays valid and
+// unchanged until the next call (render thread only).
+const WorldSnapshot* sim_latest_snapshot(void);
+
+// Position of the current moment between the snapshot's tick and the next
+// one, 0..1, for interpolation.
+float sim_snapshot_alpha(const WorldSnapshot* snapshot);
+
+// The snapshot's camera blended from prev_camera by alpha, matching the
+// interpolated entity positions. This is the camera a frame is drawn with.
+Camera sim_snapshot_camera(const WorldSnapshot* snapshot, float alpha);
+
+// Queues an input event for the simulation (render thread only).
+// Returns 0 if the queue is full and the event was dropped.
+int sim_push_input(const SDL_Event* event, const Camera* camera);
+
+// Takes the oldest queued input event (simulation thread only).
+// Returns 0 if the queue is empty.
+int sim_pop_input(SimInput* input);
+
+// Gets the epoch of the newest published snapshot and the oldest epoch the
+// renderer may still be drawing (published + 1 without a renderer).
+// Anything a snapshot referenced that was dropped after epoch E was
+// published can be freed once drawn > E (simulation thread only).
+void sim_view_epochs(uint32_t* published, uint32_t* drawn);
+
+#endif  // SIM_H
@@ -1,19 +1,18 @@
 #include "core/tile.h"
 #include "core/map.h"
 
-TileDef tile_defs[] = {
+TileDef tile_defs[TILE_COUNT] = {
     [TILE_GRASS]    = { 1, 1 },
     [TILE_ROAD]     = { 1, 1 },
     [TILE_RUBBLE]   = { 1, 2 },
     [TILE_WATER]    = { 0, 0 }
 };
 
+// Both read the precomputed planes kept by map.c (see map_walkable())
 int is_tile_walkable(int x, int y) {
-    int id = tile_map[y][x];
-    return tile_defs[id].walkable;
+    return map_walkable(x, y);
 }
 
 int tile_move_cost(int x, int y) {
-    int id = tile_map[y][x];
-    return tile_defs[id].move_cost;
+    return map_move_cost(x, y);
 }
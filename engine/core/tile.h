@@ -1,3 +1,6 @@
+#ifndef TILE_H
+#define TILE_H
+
 typedef struct {
     int walkable;
     int move_cost;
@@ -7,9 +10,14 @@ enum {
     TILE_GRASS  = 0,
     TILE_ROAD   = 1,
     TILE_RUBBLE = 2,
-    TILE_WATER  = 3
+    TILE_WATER  = 3,
+    TILE_COUNT          // Number of tile types; ids >= TILE_COUNT (e.g. MAP_TILE_VOID) are never walkable
 };
 
+extern TileDef tile_defs[TILE_COUNT];
+
 int is_tile_walkable(int x, int y);
 
 int tile_move_cost(int x, int y);
+
+#endif
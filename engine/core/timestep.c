@@ -0,0 +1,55 @@
+// Implementation file for timestep.h
+// See timestep.h for detailed documentation.
+
+#include "core/timestep.h"
+
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+int tick_rate = DEFAULT_TICK_RATE;
+float tick_seconds = 1.0f / DEFAULT_TICK_RATE;
+
+static Uint64 last_counter = 0;
+static double accumulator = 0.0;
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+void set_tick_rate(int ticks_per_second) {
+    if (ticks_per_second < 1) ticks_per_second = 1;
+    if (ticks_per_second > MAX_TICK_RATE) ticks_per_second = MAX_TICK_RATE;
+
+    tick_rate = ticks_per_second;
+    tick_seconds = 1.0f / ticks_per_second;
+}
+
+int timestep_advance(void) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (last_counter == 0) {
+        last_counter = now;
+        return 0;
+    }
+
+    double frame = (double)(now - last_counter) / SDL_GetPerformanceFrequency();
+    last_counter = now;
+    if (frame > MAX_FRAME_SECONDS) frame = MAX_FRAME_SECONDS;
+
+    accumulator += frame;
+    int ticks = (int)(accumulator * tick_rate);
+    accumulator -= (double)ticks / tick_rate;
+    return ticks;
+}
+
+int seconds_to_ticks(float seconds) {
+    int ticks = (int)(seconds * tick_rate + 0.5f);
+    return ticks > 0 ? ticks : 1;
+}
+
+int tick_chance(float rate_per_second) {
+    return rand() < (double)rate_per_second * tick_seconds * ((double)RAND_MAX + 1.0);
+}
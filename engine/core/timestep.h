@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------
+// timestep.h
+//
+// Fixed-timestep simulation clock.
+// This module handles:
+//
+// - The simulation tick rate (configurable, DEFAULT_TICK_RATE by default)
+// - Turning real frame time into a whole number of simulation ticks
+//   (accumulator), independent of how fast frames are rendered
+// - Converting gameplay durations and rates from seconds to ticks
+//
+// Simulation loop shape (see sim.h, which runs it on its own thread):
+//
+//   int ticks = timestep_advance();       // Real time -> ticks owed
+//   while (ticks-- > 0) update_scene();   // Each tick advances tick_seconds
+//   sim_publish();                        // Snapshot for the renderer
+//
+// Rendering:
+//
+//   Entities keep the render position of the previous tick
+//   (prev_render_x/y) next to the current one (render_x/y), and snapshots
+//   carry both. A frame drawn between two ticks shows
+//   prev + (current - prev) * alpha, with alpha the time since the snapshot
+//   in ticks (sim_snapshot_alpha()), so motion is smooth at any refresh rate
+//   while the simulation only ever sees whole ticks.
+//
+// Design goals:
+// - Deterministic simulation: same inputs and tick rate, same result,
+//   whatever the frame rate
+// - Gameplay code written in seconds, not frames
+// - Bounded catch-up after a stall (MAX_FRAME_SECONDS)
+// -----------------------------------------------------------------------------
+
+#ifndef TIMESTEP_H
+#define TIMESTEP_H
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define DEFAULT_TICK_RATE   30      // Simulation ticks per second
+#define MAX_TICK_RATE       1000
+#define MAX_FRAME_SECONDS   0.25f   // Longer frames are clamped (drops time instead of spiralling)
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+extern int tick_rate;           // Simulation ticks per second
+extern float tick_seconds;      // 1 / tick_rate
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Sets the simulation rate. Out-of-range values are clamped to
+// [1, MAX_TICK_RATE]. Call before the loop starts.
+void set_tick_rate(int ticks_per_second);
+
+// Measures real time since the previous call, adds it to the accumulator
+// and returns how many ticks to simulate now; the remainder carries over.
+// The first call returns 0 and only starts the clock.
+int timestep_advance(void);
+
+// Whole ticks for a duration in seconds (at least 1).
+int seconds_to_ticks(float seconds);
+
+// Returns 1 with probability rate_per_second * tick_seconds, so an event
+// expected rate_per_second times a second keeps that rate at any tick rate.
+int tick_chance(float rate_per_second);
+
+#endif  // TIMESTEP_H
@@ -4,15 +4,26 @@
 #include "entity/entity.h"
 #include "render/camera.h"
 #include "render/render.h"
+#include "render/batch.h"
 #include "ai/behavior.h"
 #include "core/constants.h"
 #include "core/scene.h"
+#include "core/timestep.h"
+#include "core/profiler.h"
+#include "navigation/path_pool.h"
+
+#include <stdlib.h>
 
 // -----------------------------------------------------------------------------
 // Constants
 // -----------------------------------------------------------------------------
 
-#define MOVE_PROGRESS 0.2f
+#define MOVE_SECONDS 0.5f           // Time to slide from one tile to the next
+#define DEFAULT_MOVE_DELAY 0.6f     // Pause between tiles, in seconds
+
+// Insertion sort shifts allowed per entity before the draw list is re-sorted
+// with qsort (scene setup, teleports); normal frames stay far below this
+#define DRAW_SORT_SHIFT_LIMIT 8
 
 // -----------------------------------------------------------------------------
 // Global State
@@ -21,6 +32,28 @@
 Entity entities[MAX_ENTITIES];
 int entity_count = 0;
 
+// Draw ordering. draw_items holds every entity and keeps its order from
+// frame to frame, so re-sorting after small moves is nearly free.
+typedef struct {
+    float depth;        // x + y of the draw position
+    float draw_x;       // Tie-break within a depth
+    int entity;         // View index (views mirror the entities array)
+} DrawItem;
+
+// NPC tint per AIState, applied as vertex color (the player is never tinted)
+static const SDL_Color state_tints[] = {
+    [STATE_IDLE]   = { 64, 64, 64, 255 },      // Gray
+    [STATE_WANDER] = { 0, 255, 0, 255 },       // Green
+    [STATE_CHASE]  = { 255, 0, 0, 255 },       // Red
+    [STATE_COMBAT] = { 255, 255, 255, 255 },
+};
+
+static DrawItem draw_items[MAX_ENTITIES];
+static int draw_item_count = 0;
+
+static int visible_entities[MAX_ENTITIES];
+static int visible_count = 0;
+
 // -----------------------------------------------------------------------------
 // Entity Management
 // -----------------------------------------------------------------------------
@@ -29,7 +62,7 @@ void init_entities() {
     entity_count = 0;
 }
 
-int add_entity(int x, int y, SDL_Texture* sprite, int width, int height, int offset_x, int offset_y, int is_player, BehaviorFunc behavior) {
+int add_entity(int x, int y, SpriteId sprite, int width, int height, int offset_x, int offset_y, int is_player, BehaviorFunc behavior) {
     if (entity_count >= MAX_ENTITIES) return -1;
 
     Entity* e = &entities[entity_count++];
@@ -37,6 +70,8 @@ int add_entity(int x, int y, SDL_Texture* sprite, int width, int height, int off
     e->y = y;
     e->render_x = (float)x;
     e->render_y = (float)y;
+    e->prev_render_x = e->render_x;
+    e->prev_render_y = e->render_y;
     e->sprite = sprite;
     e->width = width;
     e->height = height;
@@ -44,7 +79,10 @@ int add_entity(int x, int y, SDL_Texture* sprite, int width, int height, int off
     e->offset_y = offset_y;
     e->is_player = is_player;
     e->behavior = behavior;
-    
+    e->sprite_idle = SPRITE_NONE;
+    e->sprite_wander = SPRITE_NONE;
+    e->sprite_chase = SPRITE_NONE;
+
     e->move_progress = 0.0f;
     e->moving = 0;
     e->from_x = x;
@@ -52,8 +90,9 @@ int add_entity(int x, int y, SDL_Texture* sprite, int width, int height, int off
     e->to_x = x;
     e->to_y = y;
     e->path = NULL;
-    e->move_cooldown = 0;
-    e->move_delay = 6;
+    e->path_ticket = 0;
+    e->move_cooldown = 0.0f;
+    e->move_delay = DEFAULT_MOVE_DELAY;
     e->ap_max = DEFAULT_AP_MAX;
     e->ap_current = DEFAULT_AP_MAX;
 
@@ -64,54 +103,153 @@ int add_entity(int x, int y, SDL_Texture* sprite, int width, int height, int off
 // Entity Rendering
 // -----------------------------------------------------------------------------
 
-void draw_entities(SDL_Renderer* renderer, Camera* cam) {
-    for (int i = 0; i < entity_count; i++) {
-        Entity* e = &entities[i];
+void entity_view_position(const EntityView* view, float alpha, float* x, float* y) {
+    *x = view->prev_x + (view->x - view->prev_x) * alpha;
+    *y = view->prev_y + (view->y - view->prev_y) * alpha;
+}
+
+static int draw_item_before(const DrawItem* a, const DrawItem* b) {
+    if (a->depth != b->depth) return a->depth < b->depth;
+    if (a->draw_x != b->draw_x) return a->draw_x < b->draw_x;
+    return a->entity < b->entity;
+}
 
-        float rx = e->render_x;
-        float ry = e->render_y;
+static int compare_draw_items(const void* a, const void* b) {
+    const DrawItem* da = a;
+    const DrawItem* db = b;
+    if (draw_item_before(da, db)) return -1;
+    if (draw_item_before(db, da)) return 1;
+    return 0;
+}
 
-        int screen_x = (rx - ry) * (TILE_WIDTH / 2) - cam->x + map_offset_x;
-        int screen_y = (rx + ry) * (TILE_HEIGHT / 2) - cam->y + map_offset_y;
-        
-        screen_x += e->offset_x;
-        screen_y += e->offset_y;
+// Refreshes depth keys and restores back-to-front order.
+static void sort_draw_items(const EntityView* views, int count, float alpha) {
+    // Entities are only ever appended, or all dropped by init_entities()
+    if (draw_item_count > count) draw_item_count = 0;
+    while (draw_item_count < count) {
+        draw_items[draw_item_count].entity = draw_item_count;
+        draw_item_count++;
+    }
 
-        SDL_Rect dest = {
-            screen_x,
-            screen_y,
-            e->width,
-            e->height
-        };
+    for (int i = 0; i < draw_item_count; i++) {
+        float x, y;
+        entity_view_position(&views[draw_items[i].entity], alpha, &x, &y);
+        draw_items[i].depth = x + y;
+        draw_items[i].draw_x = x;
+    }
 
-        if (!e->is_player) {
-            switch (e->state) {
-                case STATE_IDLE:
-                    SDL_SetTextureColorMod(e->sprite, 64, 64, 64);
-                    break;
-                case STATE_WANDER:
-                    SDL_SetTextureColorMod(e->sprite, 0, 255, 0);
-                    break;
-                case STATE_CHASE:
-                    SDL_SetTextureColorMod(e->sprite, 255, 0, 0);
-                    break;
-                default:
-                    SDL_SetTextureColorMod(e->sprite, 255, 255, 255);
-                    break;
-            }
-        } else {
-            SDL_SetTextureColorMod(e->sprite, 255, 255, 255);
+    // Insertion sort: O(n + shifts), and entities move at most a fraction
+    // of a tile per frame, so last frame's order is almost right
+    long shifts_left = (long)draw_item_count * DRAW_SORT_SHIFT_LIMIT;
+    for (int i = 1; i < draw_item_count; i++) {
+        DrawItem item = draw_items[i];
+        int j = i - 1;
+        while (j >= 0 && draw_item_before(&item, &draw_items[j])) {
+            draw_items[j + 1] = draw_items[j];
+            j--;
         }
+        draw_items[j + 1] = item;
 
-        SDL_RenderCopy(renderer, e->sprite, NULL, &dest);
+        shifts_left -= i - 1 - j;
+        if (shifts_left < 0) {
+            // Order mostly lost (new scene); finish with O(n log n)
+            qsort(draw_items, draw_item_count, sizeof(DrawItem), compare_draw_items);
+            break;
+        }
     }
 }
 
+// Screen rectangle of an entity's sprite.
+static SDL_Rect entity_screen_rect(const EntityView* e, const Camera* cam, float alpha) {
+    float rx, ry;
+    entity_view_position(e, alpha, &rx, &ry);
+
+    int screen_x = (rx - ry) * (TILE_WIDTH / 2) - cam->x + map_offset_x;
+    int screen_y = (rx + ry) * (TILE_HEIGHT / 2) - cam->y + map_offset_y;
+
+    SDL_Rect dest = {
+        screen_x + e->offset_x,
+        screen_y + e->offset_y,
+        e->width,
+        e->height
+    };
+    return dest;
+}
+
+int build_entity_draw_list(const EntityView* views, int count, Camera* cam, float alpha, const int** list) {
+    sort_draw_items(views, count, alpha);
+
+    visible_count = 0;
+    for (int i = 0; i < draw_item_count; i++) {
+        int index = draw_items[i].entity;
+        SDL_Rect dest = entity_screen_rect(&views[index], cam, alpha);
+
+        if (dest.x + dest.w <= 0 || dest.x >= WINDOW_WIDTH ||
+            dest.y + dest.h <= 0 || dest.y >= WINDOW_HEIGHT) {
+            continue;
+        }
+        visible_entities[visible_count++] = index;
+    }
+
+    *list = visible_entities;
+    return visible_count;
+}
+
+static SDL_Color entity_tint(const Entity* e) {
+    if (e->is_player || (unsigned)e->state >= sizeof(state_tints) / sizeof(state_tints[0])) {
+        return (SDL_Color){ 255, 255, 255, 255 };
+    }
+    return state_tints[e->state];
+}
+
+int build_entity_views(EntityView* out) {
+    for (int i = 0; i < entity_count; i++) {
+        const Entity* e = &entities[i];
+        EntityView* v = &out[i];
+        v->prev_x = e->prev_render_x;
+        v->prev_y = e->prev_render_y;
+        v->x = e->render_x;
+        v->y = e->render_y;
+        v->sprite = e->sprite;
+        v->tint = entity_tint(e);
+        v->width = e->width;
+        v->height = e->height;
+        v->offset_x = e->offset_x;
+        v->offset_y = e->offset_y;
+    }
+    return entity_count;
+}
+
+void draw_entities(SDL_Renderer* renderer, Camera* cam, const EntityView* views, int count, float alpha) {
+    PROFILE_BEGIN("draw_entities");
+
+    const int* list;
+    int visible = build_entity_draw_list(views, count, cam, alpha, &list);
+
+    batch_begin(BATCH_ORDERED);
+
+    for (int i = 0; i < visible; i++) {
+        const EntityView* v = &views[list[i]];
+        SDL_Rect dest = entity_screen_rect(v, cam, alpha);
+        batch_quad_tinted(renderer, v->sprite, &dest, v->tint);
+    }
+
+    batch_flush(renderer);
+    PROFILE_END();
+}
+
 // -----------------------------------------------------------------------------
 // Entity Updates
 // -----------------------------------------------------------------------------
 
 void update_entities() {
+    PROFILE_BEGIN("update_entities");
+
+    for (int i = 0; i < entity_count; i++) {
+        entities[i].prev_render_x = entities[i].render_x;
+        entities[i].prev_render_y = entities[i].render_y;
+    }
+
     for (int i = 0; i < entity_count; i++) {
         Entity* e = &entities[i];
 
@@ -125,6 +263,8 @@ void update_entities() {
 
         update_entity_movement(e);
     }
+
+    PROFILE_END();
 }
 
 void update_entity_movement(Entity* e) {
@@ -140,14 +280,14 @@ void update_entity_movement(Entity* e) {
 
     // Skip first node if it matches current position
     if (e->path->current < e->path->length) {
-        PathNode first = e->path->nodes[e->path->current];
+        PathNode first = path_node(e->path, e->path->current);
         if (first.x == e->x && first.y == e->y) {
             e->path->current++;
         }
     }
 
-    // Path complete
-    if (e->path->current >= e->path->length) {
+    // Path complete (hierarchical paths fill in their next leg here)
+    if (!refine_path(e->path)) {
         free_path(e->path);
         e->path = NULL;
         e->moving = 0;
@@ -156,7 +296,7 @@ void update_entity_movement(Entity* e) {
 
     // Interpolating between tiles
     if (e->moving) {
-        e->move_progress += MOVE_PROGRESS;
+        e->move_progress += tick_seconds / MOVE_SECONDS;
 
         if (e->move_progress >= 1.0f) {
             e->x = e->to_x;
@@ -166,6 +306,7 @@ void update_entity_movement(Entity* e) {
             e->move_progress = 0.0f;
             e->moving = 0;
             e->path->current++;
+            refine_path(e->path);
             e->move_cooldown = e->move_delay;
         } else {
             float t = e->move_progress;
@@ -177,19 +318,22 @@ void update_entity_movement(Entity* e) {
     }
 
     // Cooldown check
-    if (e->move_cooldown > 0) {
-        e->move_cooldown--;
+    if (e->move_cooldown > 0.0f) {
+        e->move_cooldown -= tick_seconds;
         return;
     }
 
     // Start movement to next tile
-    PathNode next = e->path->nodes[e->path->current];
+    PathNode next = path_node(e->path, e->path->current);
 
+    // Entering a tile costs its move cost in AP, like the move grid counts it
     if (is_combat_active()) {
-        if (e->ap_current <= 0) {
+        int cost = map_move_cost(next.x, next.y);
+        if (e->ap_current <= 0 || e->ap_current < cost) {
+            e->ap_current = 0;      // Cannot afford the next step: the turn is over
             return;
         }
-        e->ap_current -= 1;
+        e->ap_current -= cost;
     }
 
     e->from_x = (float)e->x;
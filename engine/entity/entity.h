@@ -24,6 +24,7 @@
 #define ENTITY_H
 
 #include "render/camera.h"
+#include "render/atlas.h"
 #include "ai/ai.h"
 #include "navigation/pathfinding.h"
 
@@ -33,8 +34,8 @@
 // Constants
 // -----------------------------------------------------------------------------
 
-#define MAX_ENTITIES 128  // Maximum number of entities in the world
-#define DEFAULT_AP_MAX 6  // Default action points per combat turn
+#define MAX_ENTITIES 16384  // Maximum number of entities in the world
+#define DEFAULT_AP_MAX 6      // Default action points per combat turn
 
 // -----------------------------------------------------------------------------
 // Types
@@ -62,17 +63,21 @@ typedef void (*BehaviorFunc)(Entity* self);
 // Position System:
 // - x, y: Logical tile position (integer, updated when tile is reached)
 // - render_x, render_y: Visual position (float, interpolated for smooth movement)
+// - prev_render_x, prev_render_y: render_x/y as of the previous tick; frames
+//   drawn between ticks blend the two (see timestep.h)
 //
 // Movement System:
 // - path: Current pathfinding path (NULL if idle)
+// - path_ticket: Outstanding asynchronous path request (see path_jobs.h),
+//   0 if none
 // - moving: Whether entity is currently interpolating between tiles
 // - move_progress: Interpolation progress (0.0 -> 1.0)
 // - from_x/y, to_x/y: Start and destination tiles for current movement
-// - move_cooldown: Ticks remaining until next tile movement
-// - move_delay: Ticks to wait between tile movements
+// - move_cooldown: Seconds remaining until next tile movement
+// - move_delay: Seconds to wait between tile movements
 //
 // Rendering:
-// - sprite: Main sprite texture
+// - sprite: Main sprite (atlas region)
 // - width, height: Sprite dimensions
 // - offset_x, offset_y: Pixel offsets to align sprite feet with tile center
 // - sprite_idle/wander/chase: Optional state-specific sprites for NPCs
@@ -93,6 +98,8 @@ struct Entity {
     // Visual position for rendering (float, interpolated for smooth movement)
     float render_x;
     float render_y;
+    float prev_render_x;    // render_x/y at the end of the previous tick
+    float prev_render_y;
 
     // Movement interpolation state
     float move_progress;    // 0.0 -> 1.0, progress between from and to positions
@@ -101,7 +108,7 @@ struct Entity {
     int to_x, to_y;         // Destination tile for current movement
 
     // Sprite rendering
-    SDL_Texture* sprite;    // Main sprite texture
+    SpriteId sprite;        // Main sprite (atlas region)
     int width, height;      // Sprite dimensions
     int offset_x, offset_y; // Pixel offsets to align sprite feet with tile center
 
@@ -113,20 +120,33 @@ struct Entity {
     AIState state;          // Current AI state (for NPCs)
 
     // Optional state-specific sprites for NPCs
-    SDL_Texture* sprite_idle;
-    SDL_Texture* sprite_wander;
-    SDL_Texture* sprite_chase;
+    SpriteId sprite_idle;
+    SpriteId sprite_wander;
+    SpriteId sprite_chase;
 
     // Pathfinding and movement
     Path* path;             // Current pathfinding path (NULL if idle)
-    int move_cooldown;      // Ticks remaining until next tile movement
-    int move_delay;         // Ticks to wait between tile movements (speed control)
+    uint32_t path_ticket;   // Outstanding request_path() ticket (0 = none)
+    float move_cooldown;    // Seconds remaining until next tile movement
+    float move_delay;       // Seconds to wait between tile movements (speed control)
 
     // Combat action points (used only in combat)
     int ap_max;             // Maximum AP per turn
     int ap_current;         // Remaining AP this turn
 };
 
+// What the renderer needs to draw one entity. Copied out of the entities
+// array into each simulation snapshot (see sim.h), so drawing never touches
+// live entity state.
+typedef struct {
+    float prev_x, prev_y;   // prev_render_x/y at the snapshot tick
+    float x, y;             // render_x/y at the snapshot tick
+    SpriteId sprite;
+    SDL_Color tint;         // Vertex color (white for the player)
+    int width, height;
+    int offset_x, offset_y;
+} EntityView;
+
 // -----------------------------------------------------------------------------
 // Global State
 // -----------------------------------------------------------------------------
@@ -158,7 +178,7 @@ void init_entities();
 // Args:
 //   x: Initial tile X coordinate
 //   y: Initial tile Y coordinate
-//   sprite: SDL texture to render for this entity
+//   sprite: Atlas sprite to render for this entity
 //   width: Sprite width in pixels
 //   height: Sprite height in pixels
 //   offset_x: Horizontal pixel offset for sprite alignment
@@ -175,15 +195,13 @@ void init_entities();
 // - render_x, render_y set to the initial position (for smooth rendering)
 // - movement fields initialized to idle state
 // - path set to NULL (no movement)
-// - move_delay set to 6 ticks (default movement speed)
+// - move_delay set to 0.6 seconds (default movement speed)
 //
-// Ownership:
-// - The sprite texture is NOT copied or freed by this function
-// - The caller retains ownership of the sprite texture
+// The state-specific sprites start as SPRITE_NONE (fall back to sprite).
 int add_entity(
     int x,
     int y,
-    SDL_Texture* sprite,
+    SpriteId sprite,
     int width,
     int height,
     int offset_x,
@@ -196,22 +214,59 @@ int add_entity(
 // Entity Rendering
 // -----------------------------------------------------------------------------
 
-// Renders all entities to the screen using isometric projection.
+// Fills out[0..entity_count) with the render view of every entity, tint
+// included. Called by the simulation when it publishes a snapshot.
+//
+// Returns:
+//   Number of views written (entity_count).
+int build_entity_views(EntityView* out);
+
+// Gets the position to draw a view at: its render position blended between
+// the snapshot tick and the one before by alpha (0..1, see
+// sim_snapshot_alpha()).
+void entity_view_position(const EntityView* view, float alpha, float* x, float* y);
+
+// Builds this frame's list of entities to draw: every view whose sprite
+// overlaps the window, back to front.
+//
+// Isometric depth grows with x + y, so entities are ordered by x + y of
+// their draw position (entity_view_position(); sub-tile positions included,
+// so an entity sliding between tiles sorts correctly mid-move), then by x,
+// then by index.
+// The order is kept between frames and repaired with an insertion sort,
+// which costs O(n) when little has moved; a heavily shuffled list (new
+// scene) falls back to qsort.
+//
+// Args:
+//   views: Entity views of the snapshot being drawn
+//   count: Number of views
+//   cam: Camera structure containing current camera offset
+//   alpha: Interpolation factor between the snapshot tick and the one before
+//   list: Receives the view indices in draw order; valid until the next call
+//
+// Returns:
+//   Number of entries in list.
+int build_entity_draw_list(const EntityView* views, int count, Camera* cam, float alpha, const int** list);
+
+// Renders the visible entities to the screen using isometric projection.
 //
-// This function iterates through all active entities and draws them using
-// the same coordinate transformation as tiles and grid, ensuring perfect
+// This function draws the list from build_entity_draw_list() using the
+// same coordinate transformation as tiles and grid, ensuring perfect
 // alignment. Entities are drawn with their interpolated render positions
-// for smooth movement animation.
+// for smooth movement animation. Off-screen entities cost nothing.
 //
 // Args:
 //   renderer: SDL renderer to draw with
 //   cam: Camera structure containing current camera offset
+//   views, count: Entity views of the snapshot being drawn
+//   alpha: Interpolation factor between the snapshot tick and the one before
 //
 // Rendering process:
-// 1. Calculate screen position using isometric projection with render_x/render_y
+// 1. Calculate screen position using isometric projection with the
+//    interpolated view position
 // 2. Apply sprite offsets to align sprite feet with tile center
-// 3. Apply color tint based on AI state (for NPCs)
-// 4. Render sprite to screen
+// 3. Queue the sprite's atlas quad with the tint as vertex color; all
+//    entities on one atlas page go out in a single call (see batch.h)
 //
 // Sprite alignment:
 // - offset_x, offset_y align the sprite's feet with the tile center
@@ -219,18 +274,21 @@ int add_entity(
 //
 // Color tinting:
 // - Player: Always full color (white)
-// - NPCs: Tinted based on AI state (gray=idle, green=wander, red=chase)
+// - NPCs: Tinted based on AI state (gray=idle, green=wander, red=chase),
+//   looked up from a per-AIState table when the view is built and passed
+//   as vertex color, so the shared sprite texture is never modified
 //
 // Entities are rendered after the grid to appear on top of the grid overlay.
-void draw_entities(SDL_Renderer* renderer, Camera* cam);
+void draw_entities(SDL_Renderer* renderer, Camera* cam, const EntityView* views, int count, float alpha);
 
 // -----------------------------------------------------------------------------
 // Entity Updates
 // -----------------------------------------------------------------------------
 
-// Updates all entities for one frame.
+// Updates all entities for one simulation tick.
 //
-// This function processes all active entities in the following order:
+// First every entity's render position is saved as prev_render_x/y, then
+// all active entities are processed in the following order:
 // 1. AI brain update (for NPCs only) - determines state transitions
 // 2. Behavior function execution - handles entity-specific logic
 // 3. Movement system update - processes pathfinding and interpolation
@@ -240,7 +298,7 @@ void draw_entities(SDL_Renderer* renderer, Camera* cam);
 // - Behavior functions can set paths or modify state
 // - Movement system processes paths and interpolates positions
 //
-// This should be called once per frame in the game loop.
+// This should be called once per tick (see timestep.h), not once per frame.
 void update_entities();
 
 // Updates a single entity's movement system.
@@ -254,7 +312,7 @@ void update_entities();
 // 4. If not moving: starts movement to next tile in path (if cooldown expired)
 //
 // Movement process:
-// - Each tile movement is interpolated over multiple frames
+// - Each tile movement is interpolated over multiple ticks
 // - render_x/render_y smoothly transition from from_x/y to to_x/y
 // - When move_progress reaches 1.0, logical position (x, y) is updated
 // - Cooldown prevents entities from moving too fast
@@ -268,11 +326,11 @@ void update_entities();
 // - First path node is skipped if it matches current position (path includes start)
 //
 // Interpolation:
-// - move_progress increases by MOVE_PROGRESS per frame (typically 0.2)
-// - Takes ~5 frames per tile at 100ms delay = ~500ms per tile
+// - move_progress increases by tick_seconds / MOVE_SECONDS per tick, so a
+//   tile takes MOVE_SECONDS (0.5s) at any tick rate
 // - Visual position interpolates while logical position stays on current tile
 //
-// This function should be called once per frame for each entity via update_entities().
+// This function should be called once per tick for each entity via update_entities().
 // It can also be called individually if per-entity control is needed.
 void update_entity_movement(Entity* e);
 
@@ -10,8 +10,7 @@
 #include "core/scene.h"
 #include "navigation/grid.h"
 #include "navigation/pathfinding.h"
-
-#include <SDL2/SDL_image.h>
+#include "navigation/path_jobs.h"
 
 // -----------------------------------------------------------------------------
 // Legacy Functions
@@ -21,16 +20,8 @@ int init_player(Player* player, SDL_Renderer* renderer) {
     player->x = 5;
     player->y = 5;
 
-    SDL_Surface* surface = IMG_Load(PLAYER_SPRITE);
-    if (!surface) {
-        printf("Failed to load player sprite: %s\n", SDL_GetError());
-        return 0;
-    }
-
-    player->sprite = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
-
-    return player->sprite != NULL;
+    player->sprite = atlas_add_image(PLAYER_SPRITE);
+    return player->sprite != SPRITE_NONE;
 }
 
 void draw_player(Player* player, SDL_Renderer* renderer, Camera* cam) {
@@ -44,14 +35,14 @@ void draw_player(Player* player, SDL_Renderer* renderer, Camera* cam) {
         64
     };
 
-    SDL_RenderCopy(renderer, player->sprite, NULL, &dest);
+    atlas_draw(renderer, player->sprite, &dest);
 }
 
 // -----------------------------------------------------------------------------
 // Player Input
 // -----------------------------------------------------------------------------
 
-void handle_player_input(Entity* entity, SDL_Event* event) {
+void handle_player_input(Entity* entity, SDL_Event* event, Camera* cam) {
     if (is_combat_active() && !is_entity_turn(entity)) {
         return;
     }
@@ -60,33 +51,23 @@ void handle_player_input(Entity* entity, SDL_Event* event) {
         int mouse_x = event->button.x;
         int mouse_y = event->button.y;
 
-        Camera* cam = get_camera();
-        if (!cam) return;
-
         int tile_x, tile_y;
         screen_to_iso(mouse_x, mouse_y, cam, &tile_x, &tile_y);
 
-        if (tile_x >= 0 && tile_x < MAP_WIDTH &&
-            tile_y >= 0 && tile_y < MAP_HEIGHT) {
+        if (map_in_bounds(tile_x, tile_y)) {
 
             select_tile(tile_x, tile_y);
 
-            if (move_tiles[tile_y][tile_x].valid) {
+            const HighlightTile* move_tile = get_move_tile(tile_x, tile_y);
+            if (move_tile && move_tile->valid) {
                 if (entity->path) {
                     free_path(entity->path);
                     entity->path = NULL;
                 }
 
-                Path* path = find_path(entity->x, entity->y, tile_x, tile_y);
-                
-                if (path && path->length > 0) {
-                    entity->path = path;
-                    entity->path->current = 0;
-                    entity->moving = 0;
-                    entity->move_progress = 0.0f;
-                } else if (path) {
-                    free_path(path);
-                }
+                // Searched off the simulation thread ahead of NPC requests;
+                // the path arrives next tick
+                request_path_urgent(entity, tile_x, tile_y);
             }
         }
     }
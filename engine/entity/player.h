@@ -36,7 +36,7 @@
 // Most player functionality now uses the Entity system directly.
 typedef struct {
     int x, y;
-    SDL_Texture* sprite;
+    SpriteId sprite;
 } Player;
 
 // -----------------------------------------------------------------------------
@@ -61,6 +61,8 @@ typedef struct {
 // Args:
 //   entity: Pointer to the player entity (should have is_player flag set)
 //   event: SDL event containing mouse click information
+//   cam: Camera of the frame the click was made on (from the SimInput, see
+//        sim.h), so the tile under the cursor is the one picked
 //
 // The function performs:
 // - Screen coordinate to isometric tile coordinate conversion
@@ -78,10 +80,10 @@ typedef struct {
 // - If pathfinding fails or tile is unwalkable, no movement occurs
 // - The path is assigned to entity->path for processing by update_entity_movement()
 //
-// This function should be called from the main event loop when SDL_MOUSEBUTTONDOWN
-// events are detected. It integrates with the entity system and does not
-// perform direct position updates.
-void handle_player_input(Entity* entity, SDL_Event* event);
+// This function is called on the simulation thread for each queued
+// SDL_MOUSEBUTTONDOWN event (see sim.h). It integrates with the entity
+// system and does not perform direct position updates.
+void handle_player_input(Entity* entity, SDL_Event* event, Camera* cam);
 
 // -----------------------------------------------------------------------------
 // Legacy Functions (may be unused)
@@ -90,11 +92,11 @@ void handle_player_input(Entity* entity, SDL_Event* event);
 // Initializes a Player struct (legacy function, may be unused).
 //
 // This function initializes the legacy Player struct with a starting position
-// and loads the player sprite texture.
+// and adds the player sprite to the atlas.
 //
 // Args:
 //   player: Pointer to Player struct to initialize
-//   renderer: SDL renderer for texture creation
+//   renderer: Unused; the atlas (see init_render()) owns the renderer
 //
 // Returns:
 //   1 on success, 0 on failure (sprite loading failed)
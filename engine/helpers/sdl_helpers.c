@@ -1,8 +1,9 @@
 #include "helpers/sdl_helpers.h"
+#include "core/constants.h"
 
 #include <stdio.h>
 
-int init_sdl(SDL_Window** window, SDL_Renderer** renderer) {
+int init_sdl(SDL_Window** window, SDL_Renderer** renderer, int vsync) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         fprintf(stderr, "SDL could not initialize! SDL_ERROR: %s\n", SDL_GetError());
         return 0;
@@ -13,13 +14,14 @@ int init_sdl(SDL_Window** window, SDL_Renderer** renderer) {
         return 0;
     }
 
-    *window = SDL_CreateWindow("Oblique Engine", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 600, SDL_WINDOW_SHOWN);
+    *window = SDL_CreateWindow("Oblique Engine", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
     if (!*window) {
         fprintf(stderr, "Window could not be created! SDL_ERROR: %s\n", SDL_GetError());
         return 0;
     }
 
-    *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 flags = SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+    *renderer = SDL_CreateRenderer(*window, -1, flags);
     if (!*renderer) {
         fprintf(stderr, "Renderer could not be created! SDL_ERROR: %s\n", SDL_GetError());
         return 0;
@@ -28,6 +30,41 @@ int init_sdl(SDL_Window** window, SDL_Renderer** renderer) {
     return 1;
 }
 
+int init_sdl_headless(SDL_Surface** target, SDL_Renderer** renderer) {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        fprintf(stderr, "SDL could not initialize! SDL_ERROR: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        fprintf(stderr, "SDL_image could not initialize PNG support! IMG_ERROR: %s\n", IMG_GetError());
+        return 0;
+    }
+
+    *target = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!*target) {
+        fprintf(stderr, "Off-screen surface could not be created! SDL_ERROR: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    *renderer = SDL_CreateSoftwareRenderer(*target);
+    if (!*renderer) {
+        fprintf(stderr, "Software renderer could not be created! SDL_ERROR: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    return 1;
+}
+
+void shutdown_sdl_headless(SDL_Surface* target, SDL_Renderer* renderer) {
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (target) SDL_FreeSurface(target);
+    IMG_Quit();
+    SDL_Quit();
+}
+
 void shutdown_sdl(SDL_Window* window, SDL_Renderer* renderer) {
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
@@ -4,7 +4,15 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 
-int init_sdl(SDL_Window** window, SDL_Renderer** renderer);
+// Creates the window and renderer. With vsync, SDL_RenderPresent() waits
+// for the display refresh; without it frames are rendered as fast as possible.
+int init_sdl(SDL_Window** window, SDL_Renderer** renderer, int vsync);
 void shutdown_sdl(SDL_Window* window, SDL_Renderer* renderer);
 
+// Starts SDL on the dummy video driver (no display needed) and creates a
+// software renderer drawing into an off-screen WINDOW_WIDTH x WINDOW_HEIGHT
+// surface. Used by headless runs; pair with shutdown_sdl_headless().
+int init_sdl_headless(SDL_Surface** target, SDL_Renderer** renderer);
+void shutdown_sdl_headless(SDL_Surface* target, SDL_Renderer* renderer);
+
 #endif
@@ -0,0 +1,156 @@
+// Implementation file for flowfield.h
+// See flowfield.h for detailed documentation.
+
+#include "navigation/flowfield.h"
+#include "navigation/search.h"
+#include "navigation/path_pool.h"
+#include "core/map.h"
+
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+// Internal Constants
+// -----------------------------------------------------------------------------
+
+#define FIELD_TILES     (FLOW_FIELD_SIDE * FLOW_FIELD_SIDE)
+#define FIELD_QUEUE_SIZE (FIELD_TILES * SEARCH_DIRS + 1)   // Every tile relaxes each neighbour once
+#define FIELD_UNREACHED UINT16_MAX
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+static FlowField fields[FLOW_FIELD_SLOTS];
+static int field_built[FLOW_FIELD_SLOTS];
+static uint64_t use_clock = 0;
+static BucketQueue queue;               // Allocated by the first flow_field_get()
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+// Index of (x, y) in field, or -1 outside it.
+static inline int field_index(const FlowField* field, int x, int y) {
+    int lx = x - field->x0;
+    int ly = y - field->y0;
+    if (lx < 0 || ly < 0 || lx >= FLOW_FIELD_SIDE || ly >= FLOW_FIELD_SIDE) return -1;
+    return ly * FLOW_FIELD_SIDE + lx;
+}
+
+// A field is current if no chunk under it changed since it was built.
+static int field_is_current(const FlowField* field) {
+    return field->serial == nav_map->serial &&
+           !map_chunks_changed_since(field->x0, field->y0, field->x0 + FLOW_FIELD_SIDE - 1,
+                                     field->y0 + FLOW_FIELD_SIDE - 1, field->revision);
+}
+
+// Dijkstra outwards from the goal over the field's square. Stepping onto a
+// tile costs that tile's move cost, so a neighbour of a tile that is d from
+// the goal is at most d + the tile's move cost from it.
+static void build_field(FlowField* field, int goal_x, int goal_y) {
+    field->goal_x = goal_x;
+    field->goal_y = goal_y;
+    field->x0 = goal_x - FLOW_FIELD_RADIUS;
+    field->y0 = goal_y - FLOW_FIELD_RADIUS;
+    field->serial = nav_map->serial;
+    field->revision = nav_map->revision;
+
+    for (int i = 0; i < FIELD_TILES; i++) {
+        field->cost[i] = FIELD_UNREACHED;
+        field->step[i] = FLOW_NO_STEP;
+    }
+
+    int origin = field_index(field, goal_x, goal_y);
+    field->cost[origin] = 0;
+
+    bucket_queue_begin(&queue, FLOW_FIELD_MAX_COST);
+    bucket_queue_push(&queue, origin, 0);
+
+    int index, cost;
+    while ((index = bucket_queue_pop(&queue, &cost)) >= 0) {
+        if (cost > field->cost[index]) continue;       // Stale entry
+
+        int x = field->x0 + index % FLOW_FIELD_SIDE;
+        int y = field->y0 + index / FLOW_FIELD_SIDE;
+        int nd = cost + map_move_cost(x, y);
+        if (nd > FLOW_FIELD_MAX_COST) continue;
+
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int nx = x + search_dirs[dir][0];
+            int ny = y + search_dirs[dir][1];
+            int next = field_index(field, nx, ny);
+            if (next < 0 || !map_in_bounds(nx, ny) || !map_walkable(nx, ny)) continue;
+            if (nd >= field->cost[next] || !bucket_queue_push(&queue, next, nd)) continue;
+
+            field->cost[next] = (uint16_t)nd;
+            field->step[next] = (uint8_t)(dir ^ 1);    // Opposite of dir: back towards (x, y)
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+const FlowField* flow_field_get(int goal_x, int goal_y) {
+    if (!map_in_bounds(goal_x, goal_y) || !map_walkable(goal_x, goal_y)) return NULL;
+    if (!bucket_queue_reserve(&queue, FLOW_FIELD_MAX_COST, FIELD_QUEUE_SIZE)) return NULL;
+
+    // Same goal, else an empty slot, else the least recently used one
+    int slot = -1;
+    int same_goal = 0;
+    for (int i = 0; i < FLOW_FIELD_SLOTS && !same_goal; i++) {
+        if (field_built[i] && fields[i].goal_x == goal_x && fields[i].goal_y == goal_y) {
+            slot = i;
+            same_goal = 1;
+        } else if (slot < 0 || (field_built[slot] && (!field_built[i] ||
+                                                      fields[i].last_used < fields[slot].last_used))) {
+            slot = i;
+        }
+    }
+
+    FlowField* field = &fields[slot];
+    if (!same_goal || !field_is_current(field)) {
+        build_field(field, goal_x, goal_y);
+        field_built[slot] = 1;
+    }
+    field->last_used = ++use_clock;
+    return field;
+}
+
+int flow_field_cost(const FlowField* field, int x, int y) {
+    int index = field_index(field, x, y);
+    if (index < 0 || field->cost[index] == FIELD_UNREACHED) return -1;
+    return field->cost[index];
+}
+
+int flow_field_step(const FlowField* field, int x, int y, int* next_x, int* next_y) {
+    int index = field_index(field, x, y);
+    if (index < 0 || field->step[index] == FLOW_NO_STEP) return 0;
+
+    *next_x = x + search_dirs[field->step[index]][0];
+    *next_y = y + search_dirs[field->step[index]][1];
+    return 1;
+}
+
+Path* flow_field_path(const FlowField* field, int x, int y, int max_steps) {
+    int length = 0;
+    int cx = x, cy = y, nx, ny;
+    while (length < max_steps && flow_field_step(field, cx, cy, &nx, &ny)) {
+        cx = nx;
+        cy = ny;
+        length++;
+    }
+    if (length == 0) return NULL;
+
+    PathNode* nodes = path_scratch(length);
+    if (!nodes) return NULL;
+
+    cx = x;
+    cy = y;
+    for (int i = 0; i < length; i++) {
+        flow_field_step(field, cx, cy, &cx, &cy);
+        nodes[i] = (PathNode) { cx, cy };
+    }
+    return path_from_nodes(nodes, length);
+}
@@ -0,0 +1,95 @@
+// -----------------------------------------------------------------------------
+// flowfield.h
+//
+// Shared Dijkstra flow fields towards a goal tile.
+// This module handles:
+//
+// - One reverse Dijkstra from a goal (usually the player) over the square
+//   of FLOW_FIELD_RADIUS tiles around it, up to FLOW_FIELD_MAX_COST
+// - Per tile: cost to reach the goal and the direction of the next step
+// - Caching a few fields (one per goal) until the goal moves or a chunk
+//   under the field changes (world_map.chunk_revisions)
+//
+// Usage:
+//
+//   const FlowField* field = flow_field_get(player->x, player->y);
+//   Path* path = flow_field_path(field, self->x, self->y, 4);
+//
+// Any number of pursuers of the same goal share one field, so each of them
+// pays a lookup per step instead of a search.
+//
+// Design goals:
+// - N chasers of one target cost about one search, not N
+// - No per-tile allocation; fields are reused across rebuilds
+// -----------------------------------------------------------------------------
+
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include "navigation/pathfinding.h"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define FLOW_FIELD_RADIUS       32      // Field covers goal +/- this many tiles on each axis
+#define FLOW_FIELD_MAX_COST     96      // Tiles costlier than this to the goal are left unreached
+#define FLOW_FIELD_SLOTS        4       // Fields cached at once (least recently used is replaced)
+#define FLOW_FIELD_SIDE         (FLOW_FIELD_RADIUS * 2 + 1)
+#define FLOW_NO_STEP            0xFF    // Direction of the goal and unreached tiles
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Costs and directions towards one goal.
+//
+// Fields:
+//   goal_x, goal_y: Goal tile
+//   x0, y0: Map tile at the field's top-left corner (goal - FLOW_FIELD_RADIUS)
+//   cost: Cost from each tile to the goal, UINT16_MAX if unreached;
+//         cost[(y - y0) * FLOW_FIELD_SIDE + (x - x0)]
+//   step: Index into search_dirs (search.h) of the next step towards the
+//         goal, FLOW_NO_STEP at the goal and for unreached tiles
+//   serial, revision: Map and world_map.revision the field was built for
+//   last_used: Use counter for replacement
+typedef struct {
+    int goal_x, goal_y;
+    int x0, y0;
+    uint16_t cost[FLOW_FIELD_SIDE * FLOW_FIELD_SIDE];
+    uint8_t step[FLOW_FIELD_SIDE * FLOW_FIELD_SIDE];
+    uint32_t serial;
+    uint32_t revision;
+    uint64_t last_used;
+} FlowField;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Returns the field towards (goal_x, goal_y), from the cache if it is still
+// valid, otherwise rebuilt in place of the least recently used one.
+// Returns NULL if the goal is out of bounds or unwalkable, or if the fill's
+// queue cannot be allocated.
+//
+// The pointer stays valid until FLOW_FIELD_SLOTS other goals have been
+// requested.
+const FlowField* flow_field_get(int goal_x, int goal_y);
+
+// Returns the cost from (x, y) to the field's goal, or -1 if (x, y) lies
+// outside the field or was not reached.
+int flow_field_cost(const FlowField* field, int x, int y);
+
+// Stores the next tile on the way from (x, y) to the goal in next_x,
+// next_y. Returns 0 at the goal, outside the field, or if the goal was not
+// reached from (x, y). O(1).
+int flow_field_step(const FlowField* field, int x, int y, int* next_x, int* next_y);
+
+// Builds a path of at most max_steps tiles from (x, y) towards the goal by
+// following the field (not including (x, y), like find_path()). Returns
+// NULL if no step can be taken. Free with free_path().
+Path* flow_field_path(const FlowField* field, int x, int y, int max_steps);
+
+#endif  // FLOWFIELD_H
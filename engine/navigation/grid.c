@@ -5,7 +5,11 @@
 #include "core/map.h"
 #include "core/constants.h"
 #include "core/tile.h"
+#include "core/profiler.h"
+#include "navigation/search.h"
+#include "navigation/path_pool.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <SDL2/SDL.h>
 
@@ -13,63 +17,174 @@
 // Global State
 // -----------------------------------------------------------------------------
 
-HighlightTile move_tiles[MAP_WIDTH][MAP_HEIGHT];
 GridSelection selected_tile = { -1, -1, 0 };
 
+// The player's movement grid (calculate_move_grid() / get_move_tile())
+static MoveGrid player_grid = { 0 };
+
+// -----------------------------------------------------------------------------
+// Internal State
 // -----------------------------------------------------------------------------
-// Internal Types and Constants
+
+// Queue shared by every fill (simulation thread only), grown to the largest
+// budget and window seen
+static BucketQueue queue;
+
 // -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+// Index of (x, y) in grid's window, or -1 outside it.
+static inline int window_index(const MoveGrid* grid, int x, int y) {
+    int dx = x - grid->origin_x + grid->budget;
+    int dy = y - grid->origin_y + grid->budget;
+    if (dx < 0 || dx >= grid->side || dy < 0 || dy >= grid->side) return -1;
+    return dy * grid->side + dx;
+}
+
+// A filled grid is current if it was filled for this origin and budget
+// and no chunk under its window changed since.
+static int grid_is_current(const MoveGrid* grid, int origin_x, int origin_y, int budget) {
+    if (grid->side == 0 || grid->origin_x != origin_x || grid->origin_y != origin_y ||
+        grid->budget != budget || grid->serial != world_map.serial) {
+        return 0;
+    }
+    return !map_chunks_changed_since(origin_x - budget, origin_y - budget,
+                                     origin_x + budget, origin_y + budget, grid->revision);
+}
+
+// Grows the window and the shared queue for budget. Returns 0 on failure.
+static int reserve(MoveGrid* grid, int budget) {
+    int side = 2 * budget + 1;
+    int tiles = side * side;
+
+    if (tiles > grid->capacity) {
+        HighlightTile* grown = realloc(grid->tiles, sizeof(HighlightTile) * tiles);
+        if (!grown) return 0;
+        grid->tiles = grown;
+        grid->capacity = tiles;
+    }
 
-typedef struct {
-    int x, y, cost;
-} Node;
+    // Every tile relaxes each neighbour at most once
+    return bucket_queue_reserve(&queue, budget, tiles * SEARCH_DIRS + 1);
+}
+
+// Dijkstra outwards from the origin over the window, up to the budget.
+static void fill_grid(MoveGrid* grid) {
+    memset(grid->tiles, 0, sizeof(HighlightTile) * grid->side * grid->side);
+
+    int origin = window_index(grid, grid->origin_x, grid->origin_y);
+    if (!map_in_bounds(grid->origin_x, grid->origin_y)) return;
+    grid->tiles[origin] = (HighlightTile){ grid->origin_x, grid->origin_y, 1, 0, -1 };
+
+    bucket_queue_begin(&queue, grid->budget);
+    bucket_queue_push(&queue, origin, 0);
 
-#define MAX_QUEUE 2048
+    int index, cost;
+    while ((index = bucket_queue_pop(&queue, &cost)) >= 0) {
+        HighlightTile* tile = &grid->tiles[index];
+        if (cost > tile->ap_cost) continue;         // Stale entry
+
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int nx = tile->x + search_dirs[dir][0];
+            int ny = tile->y + search_dirs[dir][1];
+            if (!map_in_bounds(nx, ny) || !map_walkable(nx, ny)) continue;
+
+            int nd = cost + map_move_cost(nx, ny);
+            int next = window_index(grid, nx, ny);
+            if (next < 0) continue;
+            if (grid->tiles[next].valid && nd >= grid->tiles[next].ap_cost) continue;
+            if (!bucket_queue_push(&queue, next, nd)) continue;
+
+            grid->tiles[next] = (HighlightTile){ nx, ny, 1, nd, dir };
+        }
+    }
+}
 
 // -----------------------------------------------------------------------------
 // Movement Grid Calculation
 // -----------------------------------------------------------------------------
 
-void clear_move_grid(void) {
-    memset(move_tiles, 0, sizeof(move_tiles));
+int move_grid_update(MoveGrid* grid, int origin_x, int origin_y, int budget) {
+    if (budget < 0) return 0;
+    if (grid_is_current(grid, origin_x, origin_y, budget)) return 1;
+
+    if (!reserve(grid, budget)) {
+        grid->side = 0;
+        return 0;
+    }
+
+    grid->origin_x = origin_x;
+    grid->origin_y = origin_y;
+    grid->budget = budget;
+    grid->side = 2 * budget + 1;
+    grid->serial = world_map.serial;
+    grid->revision = world_map.revision;
+    fill_grid(grid);
+    return 1;
 }
 
-void calculate_move_grid(int start_x, int start_y, int max_cost) {
-    clear_move_grid();
+const HighlightTile* move_grid_tile(const MoveGrid* grid, int x, int y) {
+    int index = window_index(grid, x, y);
+    return index < 0 ? NULL : &grid->tiles[index];
+}
 
-    Node queue[MAX_QUEUE];
-    int head = 0, tail = 0;
+Path* move_grid_path(const MoveGrid* grid, int x, int y) {
+    const HighlightTile* tile = move_grid_tile(grid, x, y);
+    if (!tile || !tile->valid || tile->step < 0) return NULL;
 
-    queue[tail++] = (Node){start_x, start_y, 0};
+    int length = 0;
+    for (const HighlightTile* t = tile; t->step >= 0; length++) {
+        t = move_grid_tile(grid, t->x - search_dirs[t->step][0], t->y - search_dirs[t->step][1]);
+    }
 
-    while (head < tail) {
-        Node current = queue[head++];
+    PathNode* nodes = path_scratch(length);
+    if (!nodes) return NULL;
 
-        if (current.x < 0 || current.x >= MAP_WIDTH ||
-            current.y < 0 || current.y >= MAP_HEIGHT) {
-            continue;
-        }
+    // Walk back from (x, y), filling from the end
+    for (int i = length - 1; i >= 0; i--) {
+        nodes[i] = (PathNode){ tile->x, tile->y };
+        tile = move_grid_tile(grid, tile->x - search_dirs[tile->step][0], tile->y - search_dirs[tile->step][1]);
+    }
+    return path_from_nodes(nodes, length);
+}
 
-        HighlightTile* tile = &move_tiles[current.y][current.x];
+void move_grid_free(MoveGrid* grid) {
+    free(grid->tiles);
+    *grid = (MoveGrid){ 0 };
+}
 
-        if (tile->valid && current.cost >= tile->ap_cost) {
-            continue;
-        }
+void clear_move_grid(void) {
+    if (player_grid.tiles && player_grid.side > 0) {
+        memset(player_grid.tiles, 0, sizeof(HighlightTile) * player_grid.side * player_grid.side);
+    }
+    player_grid.serial = 0;     // Forces the next calculate_move_grid() to refill
+}
 
-        if (current.cost > max_cost) {
-            continue;
-        }
+const HighlightTile* get_move_tile(int x, int y) {
+    return move_grid_tile(&player_grid, x, y);
+}
+
+void calculate_move_grid(int start_x, int start_y, int max_cost) {
+    PROFILE_BEGIN("calculate_move_grid");
+    move_grid_update(&player_grid, start_x, start_y, max_cost);
+    PROFILE_END();
+}
+
+void get_move_range_view(MoveRangeView* view) {
+    view->radius = -1;
+    if (player_grid.side == 0) return;
 
-        tile->x = current.x;
-        tile->y = current.y;
-        tile->ap_cost = current.cost;
-        tile->valid = 1;
+    int radius = player_grid.budget < MOVE_RANGE_RADIUS ? player_grid.budget : MOVE_RANGE_RADIUS;
+    view->origin_x = player_grid.origin_x;
+    view->origin_y = player_grid.origin_y;
+    view->radius = radius;
 
-        // Explore 4-directional neighbors
-        queue[tail++] = (Node){current.x + 1, current.y, current.cost + 1};
-        queue[tail++] = (Node){current.x - 1, current.y, current.cost + 1};
-        queue[tail++] = (Node){current.x, current.y + 1, current.cost + 1};
-        queue[tail++] = (Node){current.x, current.y - 1, current.cost + 1};
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            const HighlightTile* tile = move_grid_tile(&player_grid, view->origin_x + dx, view->origin_y + dy);
+            view->reachable[(dy + radius) * MOVE_RANGE_SIDE + (dx + radius)] = tile && tile->valid;
+        }
     }
 }
 
@@ -118,21 +233,41 @@ static void fill_iso_tile(SDL_Renderer* renderer, int screen_x, int screen_y, SD
 // Grid Rendering
 // -----------------------------------------------------------------------------
 
-void draw_move_grid(SDL_Renderer* renderer, Camera* cam) {
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
+void draw_move_grid(SDL_Renderer* renderer, Camera* cam, const GridSelection* selection,
+                    const MoveRangeView* range) {
+    PROFILE_BEGIN("draw_move_grid");
+
+    TileView view;
+    camera_visible_tiles(cam, &view);
+
+    for (int y = view.min_y; y <= view.max_y; y++) {
+        int x_min, x_max;
+        if (!tile_view_row(&view, y, &x_min, &x_max)) continue;
+
+        for (int x = x_min; x <= x_max; x++) {
             int screen_x = (x - y) * (TILE_WIDTH / 2) - cam->x + map_offset_x;
             int screen_y = (x + y) * (TILE_HEIGHT / 2) - cam->y + map_offset_y;
 
             SDL_Color white = {255, 255, 255, 80};
             draw_iso_tile_outline(renderer, screen_x, screen_y, white);
 
-            if (selected_tile.selected && selected_tile.x == x && selected_tile.y == y) {
+            int rx = range ? x - range->origin_x + range->radius : -1;
+            int ry = range ? y - range->origin_y + range->radius : -1;
+            if (range && range->radius >= 0 && rx >= 0 && ry >= 0 &&
+                rx <= 2 * range->radius && ry <= 2 * range->radius &&
+                range->reachable[ry * MOVE_RANGE_SIDE + rx]) {
+                SDL_Color blue = {0, 120, 255, 60};
+                fill_iso_tile(renderer, screen_x, screen_y, blue);
+            }
+
+            if (selection->selected && selection->x == x && selection->y == y) {
                 SDL_Color red = {255, 0, 0, 120};
                 fill_iso_tile(renderer, screen_x, screen_y, red);
             }
         }
     }
+
+    PROFILE_END();
 }
 
 // -----------------------------------------------------------------------------
@@ -163,6 +298,6 @@ void screen_to_iso(int screen_x, int screen_y, Camera* cam, int* tile_x, int* ti
 // -----------------------------------------------------------------------------
 
 int is_tile_in_bounds(int x, int y) {
-    return (x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT);
+    return map_in_bounds(x, y);
 }
 
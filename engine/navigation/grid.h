@@ -7,16 +7,24 @@
 // - Visual grid overlay rendering (white outlines, red highlights)
 // - Tile selection and highlighting
 // - Screen-to-isometric coordinate conversion (for mouse clicks)
-// - Movement grid calculation (BFS-based reachability)
+// - Movement grid calculation (cost-aware reachability within an AP budget)
 // - Walkability checks for pathfinding integration
 //
 // The grid system provides visual feedback for player interaction and
 // movement planning, similar to classic tactics RPGs.
 //
+// Movement grids: a MoveGrid holds every tile reachable from an origin for
+// at most a budget of AP, where entering a tile costs its move cost
+// (map_move_cost()). It is filled by a Dijkstra over a bucket queue and
+// only refilled when the origin, the budget or a chunk under its window
+// changed (world_map.chunk_revisions). The player's grid drives clicks and
+// the AP-range overlay; NPCs fill their own to pick where to go in a
+// combat turn (see behavior.c).
+//
 // Design goals:
 // - Clear visual feedback for tile selection
 // - Accurate coordinate conversion accounting for camera and map offsets
-// - Efficient movement grid calculation using breadth-first search
+// - Movement grids that cost nothing while nothing changes
 // - Integration with pathfinding system for walkability checks
 // -----------------------------------------------------------------------------
 
@@ -25,10 +33,19 @@
 
 #include "core/constants.h"
 #include "core/map.h"
+#include "navigation/pathfinding.h"
 #include "render/camera.h"
 
+#include <stdint.h>
 #include <SDL2/SDL.h>
 
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define MOVE_RANGE_RADIUS   16      // Largest budget the AP-range overlay shows in full
+#define MOVE_RANGE_SIDE     (MOVE_RANGE_RADIUS * 2 + 1)
+
 // -----------------------------------------------------------------------------
 // Types
 // -----------------------------------------------------------------------------
@@ -42,12 +59,49 @@
 //   x, y: Tile coordinates in the map grid
 //   valid: 1 if the tile is reachable, 0 otherwise
 //   ap_cost: Movement cost (AP cost) to reach this tile from the start
+//   step: Index into search_dirs (search.h) of the step that reached this
+//         tile on a cheapest route, -1 at the origin
 typedef struct {
     int x, y;
     int valid;      // Can be moved to
     int ap_cost;    // Cost to move here
+    int step;       // Last step of the route here
 } HighlightTile;
 
+// Tiles reachable from an origin within a budget: a (2 * budget + 1)^2
+// window centred on the origin. Zero-initialise before first use; free
+// with move_grid_free().
+//
+// Fields:
+//   tiles: Window entries, row-major
+//   capacity: Entries allocated (grows on demand, never shrinks)
+//   origin_x, origin_y, budget: What the window was filled for
+//   side: Window side (2 * budget + 1), 0 before the first fill
+//   serial, revision: world_map.serial / revision at the last fill
+typedef struct {
+    HighlightTile* tiles;
+    int capacity;
+    int origin_x, origin_y;
+    int budget;
+    int side;
+    uint32_t serial;
+    uint32_t revision;
+} MoveGrid;
+
+// Copy of the player's movement grid for the renderer's AP-range overlay.
+// Budgets above MOVE_RANGE_RADIUS are clipped to that radius.
+//
+// Fields:
+//   origin_x, origin_y: Centre tile
+//   radius: Half the side of reachable, -1 when there is nothing to show
+//   reachable: 1 for tiles in range,
+//              reachable[(y - origin_y + radius) * MOVE_RANGE_SIDE + (x - origin_x + radius)]
+typedef struct {
+    int origin_x, origin_y;
+    int radius;
+    uint8_t reachable[MOVE_RANGE_SIDE * MOVE_RANGE_SIDE];
+} MoveRangeView;
+
 // Represents the currently selected tile for visual highlighting.
 //
 // The selected tile is displayed with a red fill overlay in draw_move_grid()
@@ -67,53 +121,85 @@ typedef struct {
 // -----------------------------------------------------------------------------
 
 // Currently selected tile for highlighting.
-// Set by select_tile() and used by draw_move_grid() for red highlight.
+// Set by select_tile() on the simulation thread; snapshots carry a copy to
+// draw_move_grid() for the red highlight.
 extern GridSelection selected_tile;
 
-// 2D array storing valid movement tiles and their costs.
-// Used by the movement grid calculation and pathfinding system.
-//
-// This array is populated by calculate_move_grid() and can be queried
-// by other systems to determine valid movement targets.
-extern HighlightTile move_tiles[MAP_WIDTH][MAP_HEIGHT];
-
 // -----------------------------------------------------------------------------
 // Movement Grid Calculation
 // -----------------------------------------------------------------------------
 
+// Fills grid with every tile reachable from (origin_x, origin_y) for at
+// most budget AP, where entering a tile costs map_move_cost(). Does nothing
+// if grid already holds that origin and budget and no chunk under its
+// window changed since.
+//
+// Returns 1 on success, 0 if budget is negative or memory ran out (grid is
+// then empty).
+int move_grid_update(MoveGrid* grid, int origin_x, int origin_y, int budget);
+
+// Returns grid's entry for (x, y), or NULL outside its window.
+const HighlightTile* move_grid_tile(const MoveGrid* grid, int x, int y);
+
+// Builds the cheapest path from grid's origin to (x, y) out of the steps
+// recorded in the grid (not including the origin, like find_path()), so
+// no search is needed. Returns NULL if (x, y) is not reachable or is the
+// origin. Free with free_path().
+Path* move_grid_path(const MoveGrid* grid, int x, int y);
+
+// Frees grid's tiles and empties it.
+void move_grid_free(MoveGrid* grid);
+
 // Clears all movement tiles, resetting the grid to an empty state.
 //
-// This should be called before calculate_move_grid() to ensure a clean slate.
-// All tiles are marked as invalid (not reachable).
-//
-// Typically called internally by calculate_move_grid(), but exposed for
-// manual grid management if needed.
+// All tiles are marked as invalid (not reachable) and the next
+// calculate_move_grid() call refills the grid even if nothing changed.
 void clear_move_grid(void);
 
-// Calculates all reachable tiles from a starting position using breadth-first search.
+// Returns the movement grid entry for tile (x, y).
 //
-// This function performs a BFS traversal from (start_x, start_y) to find all
-// tiles that can be reached within max_cost moves. Each tile is marked as valid
-// and stores its movement cost (AP cost).
+// The movement grid only covers a (2 * max_cost + 1)^2 window centred on the
+// origin of the last calculate_move_grid() call, so its size is independent
+// of the map size.
 //
-// The algorithm:
+// Args:
+//   x: Tile X coordinate
+//   y: Tile Y coordinate
+//
+// Returns:
+//   Pointer to the tile's entry (check ->valid for reachability), or NULL if
+//   (x, y) lies outside the current window (and is therefore unreachable).
+const HighlightTile* get_move_tile(int x, int y);
+
+// Calculates all tiles reachable from a starting position: the player's
+// movement grid (see move_grid_update()).
+//
+// The algorithm is a Dijkstra over a bucket queue (costs are small
+// integers up to max_cost):
 // 1. Start with the initial position at cost 0
-// 2. For each tile, explore its 4 neighbors (cardinal directions)
-// 3. Mark neighbors as valid if they're walkable and within max_cost
-// 4. Continue until no more reachable tiles are found
+// 2. Pop the cheapest tile and explore its 4 neighbors (cardinal directions)
+// 3. A walkable neighbor costs the tile's cost plus its own move cost;
+//    keep it if that is within max_cost and cheaper than before
+// 4. Continue until the queue is empty
 //
 // Args:
 //   start_x: Starting tile X coordinate
 //   start_y: Starting tile Y coordinate
 //   max_cost: Maximum movement cost (AP cost) allowed
 //
-// The results are stored in the global move_tiles array, which can be queried
-// by other systems (e.g., pathfinding, UI) to determine valid movement targets.
+// The results are stored in the movement grid window, which can be queried
+// with get_move_tile() by other systems (e.g., pathfinding, UI) to determine
+// valid movement targets. Calling it again with the same arguments while
+// nothing in range changed costs a few comparisons, so it is safe to call
+// every tick.
 //
 // The algorithm uses only cardinal directions (no diagonals), matching the
 // pathfinding system's movement constraints.
 void calculate_move_grid(int start_x, int start_y, int max_cost);
 
+// Copies the player's movement grid into view for the AP-range overlay.
+void get_move_range_view(MoveRangeView* view);
+
 // -----------------------------------------------------------------------------
 // Tile Selection
 // -----------------------------------------------------------------------------
@@ -139,13 +225,17 @@ void select_tile(int tile_x, int tile_y);
 // Renders the movement grid overlay on the map.
 //
 // This function draws the visual grid that overlays the isometric map, providing
-// visual feedback for tile boundaries and selection. Each tile is drawn with:
+// visual feedback for tile boundaries and selection. Only tiles overlapping
+// the window (see camera_visible_tiles()) are visited. Each tile is drawn with:
 // - A white outline (diamond shape) for all tiles
+// - A blue fill for tiles in the AP range (if range is not NULL)
 // - A red fill for the currently selected tile (if any)
 //
 // Args:
 //   renderer: SDL renderer to draw with
 //   cam: Camera structure containing current camera offset
+//   selection: Tile to highlight (the snapshot's copy of selected_tile)
+//   range: Reachable tiles to tint (the snapshot's MoveRangeView), or NULL
 //
 // The grid is drawn using the same coordinate transformation as the map tiles,
 // ensuring perfect alignment. The selected tile highlight is drawn on top of
@@ -153,11 +243,13 @@ void select_tile(int tile_x, int tile_y);
 //
 // Rendering order:
 // 1. White grid outlines (all tiles)
-// 2. Red fill for selected tile (if selected)
+// 2. Blue fill for tiles in range
+// 3. Red fill for selected tile (if selected)
 //
 // This should be called after drawing the map but before drawing entities,
 // so entities appear on top of the grid.
-void draw_move_grid(SDL_Renderer* renderer, Camera* cam);
+void draw_move_grid(SDL_Renderer* renderer, Camera* cam, const GridSelection* selection,
+                    const MoveRangeView* range);
 
 // -----------------------------------------------------------------------------
 // Coordinate Conversion
@@ -209,7 +301,7 @@ void screen_to_iso(int screen_x, int screen_y, Camera* cam, int* tile_x, int* ti
 //   y: Tile Y coordinate to check
 //
 // Returns:
-//   1 if the tile is within bounds (0 <= x < MAP_WIDTH, 0 <= y < MAP_HEIGHT)
+//   1 if the tile is within bounds (0 <= x < map_width(), 0 <= y < map_height())
 //   0 otherwise
 //
 // This is a utility function used by pathfinding and other systems to validate
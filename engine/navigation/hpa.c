@@ -0,0 +1,646 @@
+// Implementation file for hpa.h
+// See hpa.h for detailed documentation.
+
+#include "navigation/hpa.h"
+#include "navigation/path_pool.h"
+#include "core/map.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types and Constants
+// -----------------------------------------------------------------------------
+
+#define LOCAL_QUEUE_SIZE (MAP_CHUNK_TILES * SEARCH_DIRS + 1)  // Every tile relaxes each neighbour once
+
+#define PIN_MIN_CAPACITY 64
+
+// Never changed once built; a stale cluster is replaced by a new one.
+typedef struct {
+    SDL_atomic_t refs;                          // Table entry + searches that pinned it
+    uint32_t revision;                          // nav_map->revision when built
+    int node_count;
+    PathNode nodes[HPA_MAX_CLUSTER_NODES];      // Entrance tiles inside the cluster
+    int* costs;                                 // costs[from * node_count + to], INT_MAX = no route
+} Cluster;
+
+// A cluster the current search uses, by chunk index
+typedef struct {
+    int index;                                  // -1 = empty
+    Cluster* cluster;
+} Pin;
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+// Shared by every thread. clusters_lock is held only to read or swap
+// entries, never while building or searching.
+static Cluster** clusters = NULL;               // NULL entries are not built yet
+static int clusters_x = 0;
+static int clusters_y = 0;
+static uint32_t clusters_serial = 0;
+static int clusters_generation = 0;             // Bumped whenever the table is replaced
+static int clusters_complete = 0;               // Every cluster was current at clusters_revision
+static uint32_t clusters_revision = 0;
+static SDL_SpinLock clusters_lock = 0;
+
+// Sweep of hpa_update() (simulation thread): the table and map revision it
+// is checking, and the next cluster to check
+static int sweep_generation = 0;
+static uint32_t sweep_revision = 0;
+static int sweep_next = 0;
+
+// Per search thread. A search pins every cluster it reaches, so node
+// indices stay valid even if another thread replaces the cluster meanwhile.
+static __thread Pin* pins = NULL;               // Open addressing, capacity a power of two
+static __thread int pin_capacity = 0;
+static __thread int pin_count = 0;
+static __thread int pins_shared = 0;            // Searching the map the table is for
+
+// Per search thread: the queue of cluster_dijkstra()
+static __thread BucketQueue local_queue;
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+static int heuristic(int x1, int y1, int x2, int y2) {
+    return abs(x1 - x2) + abs(y1 - y2);
+}
+
+static void release_cluster(Cluster* c) {
+    if (c && SDL_AtomicDecRef(&c->refs)) {
+        free(c->costs);
+        free(c);
+    }
+}
+
+static void release_table(Cluster** table, int count) {
+    for (int i = 0; table && i < count; i++) {
+        release_cluster(table[i]);
+    }
+    free(table);
+}
+
+// Points the shared table at nav_map's map if that map is newer than the
+// one the table is for. Searches on an older map (a worker still on a
+// snapshot from before a map load) build private clusters instead.
+static int ensure_table(void) {
+    int count = nav_map->chunks_x * nav_map->chunks_y;
+
+    SDL_AtomicLock(&clusters_lock);
+    int current = clusters && clusters_serial == nav_map->serial;
+    int older = clusters && clusters_serial > nav_map->serial;
+    SDL_AtomicUnlock(&clusters_lock);
+
+    if (current || older) {
+        pins_shared = current;
+        return 1;
+    }
+
+    Cluster** table = calloc((size_t)count, sizeof(Cluster*));
+    if (!table) return 0;
+
+    Cluster** old = NULL;
+    int old_count = 0;
+    SDL_AtomicLock(&clusters_lock);
+    if (!clusters || clusters_serial < nav_map->serial) {
+        old = clusters;
+        old_count = clusters_x * clusters_y;
+        clusters = table;
+        clusters_x = nav_map->chunks_x;
+        clusters_y = nav_map->chunks_y;
+        clusters_serial = nav_map->serial;
+        clusters_generation++;
+        clusters_complete = 0;
+        table = NULL;
+    }
+    pins_shared = clusters_serial == nav_map->serial;
+    SDL_AtomicUnlock(&clusters_lock);
+
+    free(table);                        // Another search got there first
+    release_table(old, old_count);
+    return 1;
+}
+
+// A cluster depends on its own tiles and, through its entrances, on the
+// tiles of its four neighbours: the row and the column of chunks through it.
+static int cluster_stale(const Cluster* c, int cx, int cy) {
+    int x0 = cx << MAP_CHUNK_SHIFT;
+    int y0 = cy << MAP_CHUNK_SHIFT;
+    return map_chunks_changed_since(x0 - MAP_CHUNK_SIZE, y0, x0 + 2 * MAP_CHUNK_SIZE - 1, y0 + MAP_CHUNK_MASK, c->revision) ||
+           map_chunks_changed_since(x0, y0 - MAP_CHUNK_SIZE, x0 + MAP_CHUNK_MASK, y0 + 2 * MAP_CHUNK_SIZE - 1, c->revision);
+}
+
+static Pin* find_pin(int index) {
+    if (pin_capacity == 0) return NULL;
+    unsigned mask = (unsigned)pin_capacity - 1;
+    for (unsigned i = (unsigned)index * 2654435761u & mask; ; i = (i + 1) & mask) {
+        if (pins[i].index == index || pins[i].index < 0) return &pins[i];
+    }
+}
+
+// Pins c under index, taking over the caller's reference. Returns 0 on
+// allocation failure.
+static int add_pin(int index, Cluster* c) {
+    if ((pin_count + 1) * 2 > pin_capacity) {
+        int capacity = pin_capacity ? pin_capacity * 2 : PIN_MIN_CAPACITY;
+        Pin* grown = malloc(sizeof(Pin) * capacity);
+        if (!grown) return 0;
+
+        Pin* old = pins;
+        int old_capacity = pin_capacity;
+        for (int i = 0; i < capacity; i++) grown[i].index = -1;
+        pins = grown;
+        pin_capacity = capacity;
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].index >= 0) *find_pin(old[i].index) = old[i];
+        }
+        free(old);
+    }
+
+    *find_pin(index) = (Pin) { index, c };
+    pin_count++;
+    return 1;
+}
+
+// Drops every cluster the last search pinned.
+static void release_pins(void) {
+    for (int i = 0; pin_count > 0 && i < pin_capacity; i++) {
+        if (pins[i].index < 0) continue;
+        release_cluster(pins[i].cluster);
+        pins[i].index = -1;
+        pin_count--;
+    }
+}
+
+static int local_index(int x, int y) {
+    return ((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK);
+}
+
+static int find_node(const Cluster* c, int x, int y) {
+    for (int i = 0; i < c->node_count; i++) {
+        if (c->nodes[i].x == x && c->nodes[i].y == y) return i;
+    }
+    return -1;
+}
+
+static void add_node(Cluster* c, int x, int y) {
+    if (c->node_count == HPA_MAX_CLUSTER_NODES || find_node(c, x, y) >= 0) return;
+    c->nodes[c->node_count++] = (PathNode) { x, y };
+}
+
+// Returns 1 if tile (x, y) reaches (to_x, to_y) in at most
+// HPA_ENTRANCE_SPACING steps without leaving chunk (cx, cy).
+static int close_in_cluster(int cx, int cy, int x, int y, int to_x, int to_y) {
+    int x0 = cx << MAP_CHUNK_SHIFT;
+    int y0 = cy << MAP_CHUNK_SHIFT;
+    int x1 = x0 + MAP_CHUNK_SIZE < nav_map->width ? x0 + MAP_CHUNK_SIZE : nav_map->width;
+    int y1 = y0 + MAP_CHUNK_SIZE < nav_map->height ? y0 + MAP_CHUNK_SIZE : nav_map->height;
+    const uint8_t* costs = map_planes_at(nav_map, x0, y0)->costs;     // 0 = unwalkable
+
+    uint64_t seen[MAP_CHUNK_TILES / 64] = { 0 };
+    uint16_t queue[MAP_CHUNK_TILES];
+    int head = 0, tail = 0;
+    int origin = local_index(x, y);
+    int target = local_index(to_x, to_y);
+    if (origin == target) return 1;
+    seen[origin >> 6] |= 1ull << (origin & 63);
+    queue[tail++] = (uint16_t)origin;
+
+    // Breadth first, one step per pass
+    for (int step = 0; step < HPA_ENTRANCE_SPACING && head < tail; step++) {
+        int reached = tail;
+        while (head < reached) {
+            int tile = queue[head++];
+            int tx = x0 + (tile & MAP_CHUNK_MASK);
+            int ty = y0 + (tile >> MAP_CHUNK_SHIFT);
+            for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+                int nx = tx + search_dirs[dir][0];
+                int ny = ty + search_dirs[dir][1];
+                if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1) continue;
+
+                int next = ((ny - y0) << MAP_CHUNK_SHIFT) | (nx - x0);
+                if (!costs[next] || (seen[next >> 6] >> (next & 63) & 1)) continue;
+                if (next == target) return 1;
+                seen[next >> 6] |= 1ull << (next & 63);
+                queue[tail++] = (uint16_t)next;
+            }
+        }
+    }
+    return 0;
+}
+
+// Adds the transitions on the border of cluster (cx, cy) in direction dir.
+// Each border is always scanned from its west / north cluster, so both
+// clusters agree on where its transitions are.
+//
+// Scattered obstacles break a border into many short runs, and a node for
+// each would make the abstract graph denser than the tiles it stands for.
+// So a transition is skipped if, on both sides of the border, its tile is
+// at most HPA_ENTRANCE_SPACING steps from the tile of one already kept: a
+// route through it can cross at the kept one instead for a few steps more.
+static void add_border_nodes(Cluster* c, int cx, int cy, int dir) {
+    int owner_cx = dir == 1 ? cx - 1 : cx;
+    int owner_cy = dir == 3 ? cy - 1 : cy;
+    int vertical = dir < 2;     // East / west border: runs along y
+    int far_side = dir == 1 || dir == 3;
+
+    if (owner_cx < 0 || owner_cy < 0) return;
+    if (vertical ? owner_cx + 1 >= nav_map->chunks_x : owner_cy + 1 >= nav_map->chunks_y) return;
+
+    int x0 = owner_cx << MAP_CHUNK_SHIFT;
+    int y0 = owner_cy << MAP_CHUNK_SHIFT;
+    int x1 = x0 + MAP_CHUNK_SIZE < nav_map->width ? x0 + MAP_CHUNK_SIZE : nav_map->width;
+    int y1 = y0 + MAP_CHUNK_SIZE < nav_map->height ? y0 + MAP_CHUNK_SIZE : nav_map->height;
+
+    // Owner-side tile at position 0, step along the border, step across it
+    int ax = vertical ? x1 - 1 : x0;
+    int ay = vertical ? y0 : y1 - 1;
+    int step_x = vertical ? 0 : 1, step_y = vertical ? 1 : 0;
+    int cross_x = vertical ? 1 : 0, cross_y = vertical ? 0 : 1;
+    int length = vertical ? y1 - y0 : x1 - x0;
+    int far_cx = owner_cx + cross_x, far_cy = owner_cy + cross_y;
+
+    int kept[MAP_CHUNK_SIZE];       // Positions of the transitions kept, ascending
+    int kept_count = 0;
+
+    int run_start = -1;
+    for (int i = 0; i <= length; i++) {
+        int x = ax + i * step_x;
+        int y = ay + i * step_y;
+        int open = i < length && map_walkable(x, y) && map_walkable(x + cross_x, y + cross_y);
+
+        if (open && run_start < 0) run_start = i;
+        if (open || run_start < 0) continue;
+
+        // Run [run_start, i - 1] ended
+        int first = run_start, last = i - 1;
+        run_start = -1;
+
+        int picks[2] = { (first + last) / 2, -1 };
+        if (last - first + 1 >= HPA_ENTRANCE_SPLIT) {
+            picks[0] = first;
+            picks[1] = last;
+        }
+        for (int p = 0; p < 2 && picks[p] >= 0; p++) {
+            int px = ax + picks[p] * step_x, py = ay + picks[p] * step_y;
+            int covered = 0;
+            for (int k = kept_count - 1; k >= 0 && !covered && picks[p] - kept[k] <= HPA_ENTRANCE_SPACING; k--) {
+                int kx = ax + kept[k] * step_x, ky = ay + kept[k] * step_y;
+                covered = close_in_cluster(owner_cx, owner_cy, px, py, kx, ky) &&
+                          close_in_cluster(far_cx, far_cy, px + cross_x, py + cross_y, kx + cross_x, ky + cross_y);
+            }
+            if (covered) continue;
+
+            kept[kept_count++] = picks[p];
+            add_node(c, px + far_side * cross_x, py + far_side * cross_y);
+        }
+    }
+}
+
+// Dijkstra from (x, y) that never leaves cluster (cx, cy). Fills dist,
+// indexed by local tile ((ly << MAP_CHUNK_SHIFT) | lx), with the cost of
+// reaching each tile, or of reaching (x, y) from it when reverse is set.
+// Returns 0 on allocation failure.
+static int cluster_dijkstra(int cx, int cy, int x, int y, int reverse, int* dist) {
+    int x0 = cx << MAP_CHUNK_SHIFT;
+    int y0 = cy << MAP_CHUNK_SHIFT;
+    int x1 = x0 + MAP_CHUNK_SIZE < nav_map->width ? x0 + MAP_CHUNK_SIZE : nav_map->width;
+    int y1 = y0 + MAP_CHUNK_SIZE < nav_map->height ? y0 + MAP_CHUNK_SIZE : nav_map->height;
+    const uint8_t* costs = map_planes_at(nav_map, x0, y0)->costs;     // 0 = unwalkable
+
+    // No route inside the cluster costs more than all of its tiles
+    int max_cost = 0;
+    for (int i = 0; i < MAP_CHUNK_TILES; i++) max_cost += costs[i];
+    if (!bucket_queue_reserve(&local_queue, max_cost, LOCAL_QUEUE_SIZE)) return 0;
+    bucket_queue_begin(&local_queue, max_cost);
+
+    for (int i = 0; i < MAP_CHUNK_TILES; i++) dist[i] = INT_MAX;
+    int origin = ((y - y0) << MAP_CHUNK_SHIFT) | (x - x0);
+    dist[origin] = 0;
+    bucket_queue_push(&local_queue, origin, 0);
+
+    int local, d;
+    while ((local = bucket_queue_pop(&local_queue, &d)) >= 0) {
+        if (d != dist[local]) continue;     // Superseded entry
+
+        int tx = x0 + (local & MAP_CHUNK_MASK);
+        int ty = y0 + (local >> MAP_CHUNK_SHIFT);
+
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int nx = tx + search_dirs[dir][0];
+            int ny = ty + search_dirs[dir][1];
+            if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1) continue;
+
+            int next = ((ny - y0) << MAP_CHUNK_SHIFT) | (nx - x0);
+            if (!costs[next]) continue;
+            int nd = d + (reverse ? costs[local] : costs[next]);
+            if (nd < dist[next]) {
+                dist[next] = nd;
+                bucket_queue_push(&local_queue, next, nd);
+            }
+        }
+    }
+    return 1;
+}
+
+// Builds cluster (cx, cy) from nav_map. Returns it with one reference,
+// or NULL on allocation failure.
+static Cluster* build_cluster(int cx, int cy) {
+    Cluster* c = calloc(1, sizeof(Cluster));
+    if (!c) return NULL;
+
+    for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+        add_border_nodes(c, cx, cy, dir);
+    }
+
+    int n = c->node_count;
+    if (n > 0) {
+        c->costs = malloc(sizeof(int) * n * n);
+        if (!c->costs) {
+            free(c);
+            return NULL;
+        }
+    }
+
+    int dist[MAP_CHUNK_TILES];
+    for (int i = 0; i < n; i++) {
+        if (!cluster_dijkstra(cx, cy, c->nodes[i].x, c->nodes[i].y, 0, dist)) {
+            free(c->costs);
+            free(c);
+            return NULL;
+        }
+        for (int j = 0; j < n; j++) {
+            c->costs[i * n + j] = dist[local_index(c->nodes[j].x, c->nodes[j].y)];
+        }
+    }
+
+    c->revision = nav_map->revision;
+    SDL_AtomicSet(&c->refs, 1);
+    return c;
+}
+
+// Returns the table's cluster at index with a reference taken, or NULL if
+// it is not built or the table is not for nav_map's map.
+static Cluster* shared_cluster(int index) {
+    Cluster* c = NULL;
+    SDL_AtomicLock(&clusters_lock);
+    if (clusters_serial == nav_map->serial) {
+        c = clusters[index];
+        if (c) SDL_AtomicIncRef(&c->refs);
+    }
+    SDL_AtomicUnlock(&clusters_lock);
+    return c;
+}
+
+// Offers a cluster just built to the table, keeping whichever build saw the
+// newer map. The caller keeps its reference.
+static void offer_cluster(int index, Cluster* c) {
+    Cluster* dropped = NULL;
+    SDL_AtomicLock(&clusters_lock);
+    if (clusters_serial == nav_map->serial &&
+        (!clusters[index] || clusters[index]->revision < c->revision)) {
+        dropped = clusters[index];
+        clusters[index] = c;
+        SDL_AtomicIncRef(&c->refs);
+    }
+    SDL_AtomicUnlock(&clusters_lock);
+    release_cluster(dropped);
+}
+
+// Returns the cluster holding tile (x, y) for this search, or NULL if it
+// could not be built. The first call for a cluster pins the shared one,
+// or builds a new one outside the lock if it is missing or stale and
+// offers it to the table; later calls return the same pin.
+static Cluster* get_cluster(int x, int y) {
+    int cx = x >> MAP_CHUNK_SHIFT;
+    int cy = y >> MAP_CHUNK_SHIFT;
+    int index = cy * nav_map->chunks_x + cx;
+
+    Pin* pin = find_pin(index);
+    if (pin && pin->index == index) return pin->cluster;
+
+    Cluster* c = pins_shared ? shared_cluster(index) : NULL;
+    if (!c || cluster_stale(c, cx, cy)) {
+        release_cluster(c);
+        c = build_cluster(cx, cy);
+        if (!c) return NULL;
+        if (pins_shared) offer_cluster(index, c);
+    }
+
+    if (!add_pin(index, c)) {
+        release_cluster(c);
+        return NULL;
+    }
+    return c;
+}
+
+static int relax(SearchSpace* space, int x, int y, int g, int parent, int goal_x, int goal_y) {
+    SearchNode* node = search_node(space, x, y);
+    if (!node) return 0;
+    if (node->heap_index == SEARCH_CLOSED || g >= node->g) return 1;
+
+    int h = heuristic(x, y, goal_x, goal_y);
+    node->g = g;
+    node->parent = (uint8_t)parent;
+    return search_open(space, node, x, y, g + h, h);
+}
+
+// Walks parents back from the goal; returns the number of waypoints and
+// fills out (if not NULL) in start -> goal order.
+static int collect_waypoints(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y,
+                             PathNode* out, int count) {
+    int x = goal_x, y = goal_y;
+    int n = 0;
+
+    for (;;) {
+        if (out) out[count - 1 - n] = (PathNode) { x, y };
+        n++;
+        if (x == start_x && y == start_y) break;
+
+        int parent = search_peek(space, x, y)->parent;
+        if (parent == SEARCH_NO_PARENT) {
+            // Seeded from the start
+            x = start_x;
+            y = start_y;
+        } else if (parent >= HPA_PARENT_INTER) {
+            x -= search_dirs[parent - HPA_PARENT_INTER][0];
+            y -= search_dirs[parent - HPA_PARENT_INTER][1];
+        } else {
+            PathNode prev = get_cluster(x, y)->nodes[parent];
+            x = prev.x;
+            y = prev.y;
+        }
+    }
+    return n;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+static int find_waypoints(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y,
+                          PathNode** waypoints, int* count) {
+    if (!ensure_table() || !search_begin(space)) return 0;
+
+    int dist[MAP_CHUNK_TILES];
+
+    // Cost from each goal-cluster node to the goal
+    Cluster* goal_cluster = get_cluster(goal_x, goal_y);
+    if (!goal_cluster) return 0;
+    int goal_costs[HPA_MAX_CLUSTER_NODES];
+    if (!cluster_dijkstra(goal_x >> MAP_CHUNK_SHIFT, goal_y >> MAP_CHUNK_SHIFT, goal_x, goal_y, 1, dist)) return 0;
+    for (int i = 0; i < goal_cluster->node_count; i++) {
+        goal_costs[i] = dist[local_index(goal_cluster->nodes[i].x, goal_cluster->nodes[i].y)];
+    }
+
+    // Seed the search with the start cluster's nodes (and the goal, if the
+    // goal shares the cluster)
+    Cluster* start_cluster = get_cluster(start_x, start_y);
+    if (!start_cluster) return 0;
+    if (!cluster_dijkstra(start_x >> MAP_CHUNK_SHIFT, start_y >> MAP_CHUNK_SHIFT, start_x, start_y, 0, dist)) return 0;
+    for (int i = 0; i < start_cluster->node_count; i++) {
+        int d = dist[local_index(start_cluster->nodes[i].x, start_cluster->nodes[i].y)];
+        if (d != INT_MAX &&
+            !relax(space, start_cluster->nodes[i].x, start_cluster->nodes[i].y, d, SEARCH_NO_PARENT, goal_x, goal_y)) {
+            return 0;
+        }
+    }
+    if (start_cluster == goal_cluster && dist[local_index(goal_x, goal_y)] != INT_MAX &&
+        !relax(space, goal_x, goal_y, dist[local_index(goal_x, goal_y)], SEARCH_NO_PARENT, goal_x, goal_y)) {
+        return 0;
+    }
+
+    SearchNode* current;
+    int x, y;
+    while ((current = search_pop(space, &x, &y))) {
+        if (x == goal_x && y == goal_y) {
+            int n = collect_waypoints(space, start_x, start_y, goal_x, goal_y, NULL, 0);
+            *waypoints = path_pool_alloc(sizeof(PathNode) * n);
+            if (!*waypoints) return 0;
+            collect_waypoints(space, start_x, start_y, goal_x, goal_y, *waypoints, n);
+            *count = n;
+            return 1;
+        }
+
+        Cluster* c = get_cluster(x, y);
+        if (!c) return 0;
+        int i = find_node(c, x, y);
+        if (i < 0) continue;
+        int n = c->node_count;
+
+        // Intra-cluster edges
+        for (int j = 0; j < n; j++) {
+            int cost = c->costs[i * n + j];
+            if (j == i || cost == INT_MAX) continue;
+            if (!relax(space, c->nodes[j].x, c->nodes[j].y, current->g + cost, i, goal_x, goal_y)) return 0;
+        }
+
+        // Transitions into neighbouring clusters
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int nx = x + search_dirs[dir][0];
+            int ny = y + search_dirs[dir][1];
+            if (!map_in_bounds(nx, ny) || !map_walkable(nx, ny)) continue;
+            if ((nx >> MAP_CHUNK_SHIFT) == (x >> MAP_CHUNK_SHIFT) &&
+                (ny >> MAP_CHUNK_SHIFT) == (y >> MAP_CHUNK_SHIFT)) continue;
+
+            Cluster* other = get_cluster(nx, ny);
+            if (!other) return 0;
+            if (find_node(other, nx, ny) < 0) continue;
+            if (!relax(space, nx, ny, current->g + map_move_cost(nx, ny), HPA_PARENT_INTER + dir, goal_x, goal_y)) {
+                return 0;
+            }
+        }
+
+        // Final leg to the goal
+        if (c == goal_cluster && goal_costs[i] != INT_MAX &&
+            !relax(space, goal_x, goal_y, current->g + goal_costs[i], i, goal_x, goal_y)) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+int hpa_find_waypoints(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y,
+                       PathNode** waypoints, int* count) {
+    int found = find_waypoints(space, start_x, start_y, goal_x, goal_y, waypoints, count);
+    release_pins();
+    return found;
+}
+
+void hpa_update(int max_builds) {
+    if (!ensure_table() || !pins_shared) return;
+
+    SDL_AtomicLock(&clusters_lock);
+    int generation = clusters_generation;
+    int complete = clusters_complete && clusters_revision == nav_map->revision;
+    SDL_AtomicUnlock(&clusters_lock);
+    if (complete) return;
+
+    // Clusters already checked may be stale again after an edit
+    if (sweep_generation != generation || sweep_revision != nav_map->revision) {
+        sweep_generation = generation;
+        sweep_revision = nav_map->revision;
+        sweep_next = 0;
+    }
+
+    int count = nav_map->chunks_x * nav_map->chunks_y;
+    int built = 0;
+    for (; sweep_next < count; sweep_next++) {
+        int cx = sweep_next % nav_map->chunks_x;
+        int cy = sweep_next / nav_map->chunks_x;
+
+        Cluster* c = shared_cluster(sweep_next);
+        int current = c && !cluster_stale(c, cx, cy);
+        release_cluster(c);
+        if (current) continue;
+
+        if (built == max_builds) return;
+        c = build_cluster(cx, cy);
+        if (!c) return;                 // Out of memory: try again next tick
+        offer_cluster(sweep_next, c);
+        release_cluster(c);
+        built++;
+    }
+
+    SDL_AtomicLock(&clusters_lock);
+    if (clusters_generation == sweep_generation) {
+        clusters_complete = 1;
+        clusters_revision = sweep_revision;
+    }
+    SDL_AtomicUnlock(&clusters_lock);
+}
+
+int hpa_ready(void) {
+    SDL_AtomicLock(&clusters_lock);
+    int ready = clusters_serial == nav_map->serial && clusters_complete &&
+                clusters_revision >= nav_map->revision;
+    SDL_AtomicUnlock(&clusters_lock);
+    return ready;
+}
+
+void hpa_reset(void) {
+    SDL_AtomicLock(&clusters_lock);
+    Cluster** old = clusters;
+    int old_count = clusters_x * clusters_y;
+    clusters = NULL;
+    clusters_x = clusters_y = 0;
+    clusters_serial = 0;
+    clusters_generation++;
+    clusters_complete = 0;
+    SDL_AtomicUnlock(&clusters_lock);
+
+    release_table(old, old_count);
+}
+
+void hpa_release_workspace(void) {
+    release_pins();
+    bucket_queue_free(&local_queue);
+    free(pins);
+    pins = NULL;
+    pin_capacity = 0;
+}
@@ -0,0 +1,96 @@
+// -----------------------------------------------------------------------------
+// hpa.h
+//
+// Hierarchical pathfinding (HPA*) over map chunks.
+// This module handles:
+//
+// - Clusters: one per map chunk (MAP_CHUNK_SIZE x MAP_CHUNK_SIZE tiles)
+// - Entrances: each maximal run of walkable tile pairs across a cluster
+//   border gets one transition in its middle, or one at each end if it is
+//   HPA_ENTRANCE_SPLIT tiles or longer, unless on both sides a transition
+//   already kept is at most HPA_ENTRANCE_SPACING steps away; the tile on
+//   each side is an abstract node of its cluster
+// - Intra-cluster costs: cheapest route between every pair of a cluster's
+//   nodes that stays inside the cluster
+// - Searching the abstract graph for a list of waypoints, which
+//   find_path() refines into tiles one leg at a time (see refine_path())
+//
+// Clusters are built ahead of searches: hpa_update() runs every tick and
+// builds a few clusters that are missing, or stale because
+// world_map.chunk_revisions shows that their chunk or a neighbouring chunk
+// changed since. find_path() only plans through the hierarchy once
+// hpa_ready() says every cluster is current, so a search never waits on a
+// map's worth of builds; until then long trips are searched tile by tile.
+// A search that still meets a stale cluster (a worker on a newer snapshot)
+// builds it itself. A new map (world_map.serial) drops every cluster.
+//
+// Paths are near optimal: routes are forced through entrance tiles, so
+// they can be a few tiles longer than an A* path.
+//
+// Threading: the cluster table is shared by searches on every thread (see
+// path_jobs.h). Built clusters never change: a stale one is replaced by a
+// new build, and reference counts keep it alive while searches use it. A
+// search pins each cluster it reaches for its whole run, holding the table's
+// spin lock only to read or swap one entry; building and searching happen
+// outside it, so searches on different threads run side by side.
+// A search reads the map through nav_map; clusters built from a worker's
+// snapshot carry that snapshot's revision and are rebuilt once the live map
+// is newer, while a worker on an older snapshot may reuse newer clusters.
+// Either way the legs are searched tile by tile later, on the live map.
+//
+// Design goals:
+// - Cross-map queries cost a search over a few nodes per chunk
+// - Tile edits invalidate only the chunks around them
+// -----------------------------------------------------------------------------
+
+#ifndef HPA_H
+#define HPA_H
+
+#include "navigation/search.h"
+#include "navigation/pathfinding.h"
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define HPA_ENTRANCE_SPLIT      6       // Entrance runs this long get two transitions
+#define HPA_ENTRANCE_SPACING    8       // Steps to a kept transition that make another redundant
+#define HPA_MAX_CLUSTER_NODES   64      // 4 borders x at most 16 runs each
+#define HPA_PARENT_INTER        HPA_MAX_CLUSTER_NODES  // + direction: reached across a border
+#define HPA_TICK_BUILDS         4       // Clusters hpa_update() builds per tick
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Searches the abstract graph from (start_x, start_y) to (goal_x, goal_y),
+// building or rebuilding the clusters it reaches. Both tiles must be in
+// bounds and walkable. Uses space for the search.
+//
+// On success stores an array of waypoints from the path pool (see
+// path_pool.h; free it with path_pool_free()) in *waypoints
+// (start first, goal last; consecutive waypoints are either adjacent or in
+// the same cluster) and its length in *count, and returns 1.
+// Returns 0 if the goal is unreachable or memory ran out.
+int hpa_find_waypoints(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y,
+                       PathNode** waypoints, int* count);
+
+// Builds or rebuilds up to max_builds clusters that are missing or stale,
+// carrying on from where the last call stopped; once every cluster has been
+// found current, calls cost nothing until the map changes. Simulation
+// thread only (path_jobs_update() calls it every tick with
+// HPA_TICK_BUILDS).
+void hpa_update(int max_builds);
+
+// Returns 1 if every cluster is built and current for the map searches on
+// this thread read (nav_map), 0 while hpa_update() is still catching up.
+int hpa_ready(void);
+
+// Drops every cluster. They are rebuilt by hpa_update() or by the next search;
+// searches already running keep the clusters they pinned.
+void hpa_reset(void);
+
+// Frees the calling thread's pin table. Called by release_path_workspace().
+void hpa_release_workspace(void);
+
+#endif  // HPA_H
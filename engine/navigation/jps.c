@@ -0,0 +1,222 @@
+// Implementation file for jps.h
+// See jps.h for detailed documentation.
+
+#include "navigation/jps.h"
+#include "core/map.h"
+
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    SearchSpace* space;
+    const Map* map;         // nav_map, read once for the row scans
+    int goal_x, goal_y;
+} JumpSearch;
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+// Word w of row y of the flat bits; 0 outside the map, so tiles off the
+// edge read as blocked.
+static inline uint64_t flat_word(const Map* map, int y, int w) {
+    if (y < 0 || y >= map->height || w < 0 || w >= map->walk_stride) return 0;
+    return map_flat_word(map, y, w);
+}
+
+// Word w of row y of the weighted tiles (walkable, not flat).
+static inline uint64_t weighted_word(const Map* map, int y, int w) {
+    if (y < 0 || y >= map->height || w < 0 || w >= map->walk_stride) return 0;
+    return map_walk_word(map, y, w) & ~map_flat_word(map, y, w);
+}
+
+// Bit x of each word moved to x + 1 / x - 1, carrying across words.
+static inline uint64_t flat_shifted_up(const Map* map, int y, int w) {
+    return (flat_word(map, y, w) << 1) | (flat_word(map, y, w - 1) >> 63);
+}
+
+static inline uint64_t flat_shifted_down(const Map* map, int y, int w) {
+    return (flat_word(map, y, w) >> 1) | (flat_word(map, y, w + 1) << 63);
+}
+
+static inline uint64_t weighted_shifted_up(const Map* map, int y, int w) {
+    return (weighted_word(map, y, w) << 1) | (weighted_word(map, y, w - 1) >> 63);
+}
+
+static inline uint64_t weighted_shifted_down(const Map* map, int y, int w) {
+    return (weighted_word(map, y, w) >> 1) | (weighted_word(map, y, w + 1) << 63);
+}
+
+static inline int is_flat(int x, int y) {
+    return map_in_bounds(x, y) && map_flat(x, y);
+}
+
+static inline int is_weighted(int x, int y) {
+    return map_in_bounds(x, y) && map_walkable(x, y) && !map_flat(x, y);
+}
+
+// A flat tile next to a weighted one: routes may leave the flat region here.
+static int is_border(int x, int y) {
+    return is_weighted(x + 1, y) || is_weighted(x - 1, y) ||
+           is_weighted(x, y + 1) || is_weighted(x, y - 1);
+}
+
+static int heuristic(const JumpSearch* s, int x, int y) {
+    return abs(x - s->goal_x) + abs(y - s->goal_y);
+}
+
+// Scans row y from x in direction dx (+1 / -1), one 64-bit word per step.
+// Returns the x of the first jump point before the first non-flat tile, or
+// -1 if there is none. A tile is a jump point if it is the goal, has a
+// forced vertical neighbour (flat, with the tile behind it not flat), or
+// is a border tile.
+static int jump_horizontal(const JumpSearch* s, int x, int y, int dx) {
+    const Map* map = s->map;
+    int goal_row = s->goal_y == y;
+    int c = x + dx;
+    if (c < 0 || c >= map->width) return -1;
+
+    int w = c >> 6;
+    uint64_t mask = dx > 0 ? ~0ull << (c & 63) : ~0ull >> (63 - (c & 63));
+
+    for (; w >= 0 && w < map->walk_stride; w += dx, mask = ~0ull) {
+        uint64_t blocked = ~flat_word(map, y, w) & mask;
+
+        uint64_t stops = weighted_word(map, y - 1, w) | weighted_word(map, y + 1, w);
+        if (goal_row && (s->goal_x >> 6) == w) stops |= 1ull << (s->goal_x & 63);
+
+        if (dx > 0) {
+            stops |= flat_word(map, y - 1, w) & ~flat_shifted_up(map, y - 1, w);
+            stops |= flat_word(map, y + 1, w) & ~flat_shifted_up(map, y + 1, w);
+            stops |= weighted_shifted_down(map, y, w);   // Next tile weighted
+            stops &= mask;
+
+            // Stops below the first blocked bit are still reachable
+            uint64_t reachable = blocked ? (blocked & -blocked) - 1 : ~0ull;
+            if (stops & reachable) return (w << 6) + __builtin_ctzll(stops & reachable);
+        } else {
+            stops |= flat_word(map, y - 1, w) & ~flat_shifted_down(map, y - 1, w);
+            stops |= flat_word(map, y + 1, w) & ~flat_shifted_down(map, y + 1, w);
+            stops |= weighted_shifted_up(map, y, w);     // Next tile weighted
+            stops &= mask;
+
+            // Stops above the highest blocked bit are still reachable
+            int top = blocked ? 63 - __builtin_clzll(blocked) : -1;
+            uint64_t reachable = top == 63 ? 0 : ~0ull << (top + 1);
+            if (stops & reachable) return (w << 6) + 63 - __builtin_clzll(stops & reachable);
+        }
+
+        if (blocked) return -1;
+    }
+    return -1;
+}
+
+// Walks column x from y in direction dy (+1 / -1). Returns the y of the
+// first jump point (goal, border tile, or a tile whose horizontal scans find
+// a jump point), or -1 if a non-flat tile comes first.
+static int jump_vertical(const JumpSearch* s, int x, int y, int dy) {
+    for (;;) {
+        y += dy;
+        if (!is_flat(x, y)) return -1;
+        if (x == s->goal_x && y == s->goal_y) return y;
+        if (is_border(x, y)) return y;
+        if (jump_horizontal(s, x, y, 1) >= 0 || jump_horizontal(s, x, y, -1) >= 0) return y;
+    }
+}
+
+// Offers (x, y) at cost g, reached along direction dir. Returns 0 only if
+// the workspace could not grow.
+static int relax(const JumpSearch* s, int x, int y, int g, int dir) {
+    SearchNode* node = search_node(s->space, x, y);
+    if (!node) return 0;
+    if (node->heap_index == SEARCH_CLOSED || g >= node->g) return 1;
+
+    int h = heuristic(s, x, y);
+    node->g = g;
+    node->parent = (uint8_t)dir;
+    return search_open(s->space, node, x, y, g + h, h);
+}
+
+// Jumps from (x, y) along direction dir and offers the jump point found.
+static int jump(const JumpSearch* s, int x, int y, int g, int dir) {
+    int dx = search_dirs[dir][0];
+    int dy = search_dirs[dir][1];
+
+    if (dx != 0) {
+        int jx = jump_horizontal(s, x, y, dx);
+        return jx < 0 || relax(s, jx, y, g + abs(jx - x), dir);
+    }
+
+    int jy = jump_vertical(s, x, y, dy);
+    return jy < 0 || relax(s, x, jy, g + abs(jy - y), dir);
+}
+
+// Expands one popped node. Returns 0 only if the workspace could not grow.
+static int expand(const JumpSearch* s, SearchNode* node, int x, int y) {
+    int g = node->g;
+    int parent = node->parent;
+
+    // Weighted tiles: plain A* steps
+    if (!map_flat(x, y)) {
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int nx = x + search_dirs[dir][0];
+            int ny = y + search_dirs[dir][1];
+            if (!map_in_bounds(nx, ny) || !map_walkable(nx, ny)) continue;
+            if (!relax(s, nx, ny, g + map_move_cost(nx, ny), dir)) return 0;
+        }
+        return 1;
+    }
+
+    // Start and border tiles: jump every way, step onto weighted neighbours
+    if (parent == SEARCH_NO_PARENT || is_border(x, y)) {
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int nx = x + search_dirs[dir][0];
+            int ny = y + search_dirs[dir][1];
+            if (is_weighted(nx, ny)) {
+                if (!relax(s, nx, ny, g + map_move_cost(nx, ny), dir)) return 0;
+            } else if (!jump(s, x, y, g, dir)) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    int dx = search_dirs[parent][0];
+
+    // Vertical travel: straight on, or turn either way
+    if (dx == 0) {
+        return jump(s, x, y, g, parent) && jump(s, x, y, g, 0) && jump(s, x, y, g, 1);
+    }
+
+    // Horizontal travel: straight on, plus forced vertical neighbours
+    if (!jump(s, x, y, g, parent)) return 0;
+    if (is_flat(x, y - 1) && !is_flat(x - dx, y - 1) && !jump(s, x, y, g, 3)) return 0;
+    if (is_flat(x, y + 1) && !is_flat(x - dx, y + 1) && !jump(s, x, y, g, 2)) return 0;
+    return 1;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+SearchNode* jps_search(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y) {
+    JumpSearch s = { space, nav_map, goal_x, goal_y };
+    if (!search_begin(space)) return NULL;
+
+    SearchNode* start = search_node(space, start_x, start_y);
+    if (!start) return NULL;
+    int start_h = heuristic(&s, start_x, start_y);
+    start->g = 0;
+    if (!search_open(space, start, start_x, start_y, start_h, start_h)) return NULL;
+
+    SearchNode* current;
+    int x, y;
+    while ((current = search_pop(space, &x, &y))) {
+        if (x == goal_x && y == goal_y) return current;
+        if (!expand(&s, current, x, y)) return NULL;
+    }
+    return NULL;
+}
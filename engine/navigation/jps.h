@@ -0,0 +1,50 @@
+// -----------------------------------------------------------------------------
+// jps.h
+//
+// Jump point search for 4-directional grids with mixed move costs.
+// This module handles:
+//
+// - Jumping straight across flat tiles (walkable at MAP_FLAT_COST, see
+//   map_flat()) instead of expanding them one by one
+// - Scanning rows 64 tiles at a time with the flat and walk bitsets
+// - Falling back to plain weighted A* steps around tiles of any other cost
+//
+// Canonical ordering: among equal-cost routes over flat tiles, the search
+// only keeps the one that moves vertically first and turns horizontal as
+// late as possible. So:
+//
+// - A vertical jump continues until some horizontal scan from the tile it
+//   is on would find something; that tile becomes a jump point
+// - A horizontal jump stops at the goal or at a tile whose vertical
+//   neighbour cannot be reached vertical-first (a forced neighbour)
+//
+// Weighted tiles (walkable but not flat) count as walls for jumping. Flat
+// tiles next to them are jump points that expand in all four directions,
+// and weighted tiles expand into their neighbours one step at a time, so
+// every route through them is still considered at its real cost.
+//
+// Design goals:
+// - Same path costs as plain A* (find_path_astar()) on every map
+// - Orders of magnitude fewer heap operations on open, flat terrain
+// -----------------------------------------------------------------------------
+
+#ifndef JPS_H
+#define JPS_H
+
+#include "navigation/search.h"
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Runs a jump point search from (start_x, start_y) to (goal_x, goal_y) in
+// space. Both tiles must be in bounds and walkable.
+//
+// Nodes exist only at jump points; a node's parent field is the direction
+// of the straight segment that reached it (see search_dirs).
+//
+// Returns the goal's node, or NULL if the goal is unreachable or the
+// workspace could not grow.
+SearchNode* jps_search(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y);
+
+#endif  // JPS_H
@@ -0,0 +1,190 @@
+// Implementation file for path_cache.h
+// See path_cache.h for detailed documentation.
+
+#include "navigation/path_cache.h"
+#include "navigation/path_pool.h"
+#include "core/map.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    int used;
+    int start_x, start_y;
+    int goal_x, goal_y;
+    Path* route;                // Tiles after the start, as find_path() returns them
+    int cost;
+
+    // Tiles any route as cheap could cross, inclusive
+    int x0, y0, x1, y1;
+
+    uint32_t map_serial;
+    uint32_t map_revision;      // Latest revision the route is known good for
+    uint32_t last_used;
+} CacheEntry;
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+static CacheEntry entries[PATH_CACHE_ENTRIES];
+static uint32_t use_clock = 0;
+static PathCacheStats stats;
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+static int distance(int x1, int y1, int x2, int y2) {
+    return abs(x1 - x2) + abs(y1 - y2);
+}
+
+static void drop_entry(CacheEntry* entry) {
+    free_path(entry->route);
+    memset(entry, 0, sizeof(*entry));
+}
+
+// Returns 1 if entry's route is still a cheapest one on world_map, else
+// drops it and returns 0.
+static int entry_valid(CacheEntry* entry) {
+    if (entry->map_serial == world_map.serial &&
+        !map_chunks_changed_since(entry->x0, entry->y0, entry->x1, entry->y1, entry->map_revision)) {
+        entry->map_revision = world_map.revision;       // Skip the scan until the next edit
+        return 1;
+    }
+
+    stats.invalidations++;
+    drop_entry(entry);
+    return 0;
+}
+
+// Index in entry's route of the tile after (x, y), or -1 if the route does
+// not start at or pass (x, y).
+static int route_offset(CacheEntry* entry, int x, int y) {
+    if (x == entry->start_x && y == entry->start_y) return 0;
+
+    // Tiles the route could pass satisfy the same bound as the whole route
+    if (distance(entry->start_x, entry->start_y, x, y) + distance(x, y, entry->goal_x, entry->goal_y) >
+        entry->cost) {
+        return -1;
+    }
+
+    // The goal itself is excluded: serving from there would be empty
+    for (int i = 0; i < entry->route->length - 1; i++) {
+        PathNode node = path_node(entry->route, i);
+        if (node.x == x && node.y == y) return i + 1;
+    }
+    return -1;
+}
+
+// Entry to overwrite for a route from (start_x, start_y) to (goal_x,
+// goal_y): the one with the same endpoints, else an unused one, else the
+// least recently used.
+static CacheEntry* pick_slot(int start_x, int start_y, int goal_x, int goal_y) {
+    CacheEntry* oldest = &entries[0];
+    CacheEntry* unused = NULL;
+    for (int i = 0; i < PATH_CACHE_ENTRIES; i++) {
+        CacheEntry* entry = &entries[i];
+        if (!entry->used) {
+            if (!unused) unused = entry;
+            continue;
+        }
+        if (entry->start_x == start_x && entry->start_y == start_y &&
+            entry->goal_x == goal_x && entry->goal_y == goal_y) {
+            return entry;
+        }
+        if (entry->last_used < oldest->last_used || !oldest->used) oldest = entry;
+    }
+    return unused ? unused : oldest;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+Path* path_cache_lookup(int start_x, int start_y, int goal_x, int goal_y) {
+    if (start_x == goal_x && start_y == goal_y) return NULL;
+
+    for (int i = 0; i < PATH_CACHE_ENTRIES; i++) {
+        CacheEntry* entry = &entries[i];
+        if (!entry->used || entry->goal_x != goal_x || entry->goal_y != goal_y) continue;
+
+        int offset = route_offset(entry, start_x, start_y);
+        if (offset < 0 || !entry_valid(entry)) continue;
+
+        Path* path = path_copy(entry->route, offset);
+        if (!path) break;
+        entry->last_used = ++use_clock;
+        stats.hits++;
+        return path;
+    }
+
+    stats.misses++;
+    return NULL;
+}
+
+void path_cache_store(Path* path, int start_x, int start_y, int goal_x, int goal_y,
+                      uint32_t map_serial, uint32_t map_revision) {
+    if (!path || path->length <= 0 || path->waypoints) return;
+    if (path->length > PATH_CACHE_MAX_LENGTH || map_serial != world_map.serial) return;
+
+    // Start == goal is never looked up, and a one-step trip (every wander
+    // step) is cheaper to search than the long route it would evict
+    if (distance(start_x, start_y, goal_x, goal_y) <= 1) return;
+
+    Path* route = path_copy(path, 0);
+    if (!route) return;
+    CacheEntry* entry = pick_slot(start_x, start_y, goal_x, goal_y);
+    free_path(entry->route);
+    entry->route = route;
+
+    // Costs as of now; if they differ from the searched map's, a chunk on
+    // the route changed since and the entry is dropped on first use anyway
+    int cost = 0;
+    for (int i = 0; i < route->length; i++) {
+        PathNode node = path_node(route, i);
+        cost += map_move_cost(node.x, node.y);
+    }
+
+    // Box of every tile t with dist(start, t) + dist(t, goal) <= cost
+    int slack = (cost - distance(start_x, start_y, goal_x, goal_y) + 1) / 2;
+    entry->x0 = (start_x < goal_x ? start_x : goal_x) - slack;
+    entry->y0 = (start_y < goal_y ? start_y : goal_y) - slack;
+    entry->x1 = (start_x > goal_x ? start_x : goal_x) + slack;
+    entry->y1 = (start_y > goal_y ? start_y : goal_y) + slack;
+
+    entry->used = 1;
+    entry->start_x = start_x;
+    entry->start_y = start_y;
+    entry->goal_x = goal_x;
+    entry->goal_y = goal_y;
+    entry->cost = cost;
+    entry->map_serial = map_serial;
+    entry->map_revision = map_revision;
+    entry->last_used = ++use_clock;
+}
+
+Path* find_path_cached(int start_x, int start_y, int goal_x, int goal_y) {
+    Path* path = path_cache_lookup(start_x, start_y, goal_x, goal_y);
+    if (path) return path;
+
+    path = find_path(start_x, start_y, goal_x, goal_y);
+    path_cache_store(path, start_x, start_y, goal_x, goal_y, world_map.serial, world_map.revision);
+    return path;
+}
+
+PathCacheStats path_cache_stats(void) {
+    return stats;
+}
+
+void path_cache_reset(void) {
+    for (int i = 0; i < PATH_CACHE_ENTRIES; i++) {
+        drop_entry(&entries[i]);
+    }
+    use_clock = 0;
+    memset(&stats, 0, sizeof(stats));
+}
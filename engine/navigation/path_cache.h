@@ -0,0 +1,104 @@
+// -----------------------------------------------------------------------------
+// path_cache.h
+//
+// Recently found paths, kept for requests that repeat or overlap them.
+// This module handles:
+//
+// - A bounded cache of PATH_CACHE_ENTRIES routes keyed on their start and
+//   goal tiles, evicting the least recently used entry
+// - Sub-path reuse: a request whose start lies on a cached route to the
+//   same goal is served the rest of that route (every part of a cheapest
+//   path is itself a cheapest path)
+// - Invalidation by chunk revision: an entry is dropped once a chunk that
+//   any equally cheap route could cross has changed since the route was
+//   found (see below), and never because of edits elsewhere
+// - Hit, miss and invalidation counters
+//
+// Which chunks matter: every tile costs at least 1 to enter, so a route of
+// cost C from s to g can only pass tiles t with dist(s, t) + dist(t, g) <= C
+// (Manhattan distance). Each entry records the chunks overlapping the box
+// around that area, and the cached route stays a cheapest one as long as
+// none of their world_map.chunk_revisions moves past the revision the route
+// was found on. Long detours cover large boxes and are dropped more often.
+//
+// request_path() (path_jobs.h) looks here before queueing a search and
+// stores every result it attaches; wander steps use find_path_cached(),
+// but as one-step trips they only ever read it.
+// find_path() itself never uses the cache.
+//
+// Usage:
+//
+//   Path* path = path_cache_lookup(x, y, goal_x, goal_y);
+//   if (!path) {
+//       path = find_path(x, y, goal_x, goal_y);
+//       path_cache_store(path, x, y, goal_x, goal_y, world_map.serial, world_map.revision);
+//   }
+//
+// Threading: simulation thread only (reads world_map).
+//
+// Design goals:
+// - A repeated or overlapping request costs a scan of a few entries and a
+//   copy, not a search
+// - Edits drop only the routes they could change
+// -----------------------------------------------------------------------------
+
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include "navigation/pathfinding.h"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define PATH_CACHE_ENTRIES      64      // Routes kept at once
+#define PATH_CACHE_MAX_LENGTH   1024    // Longer routes are not kept
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Counters since the last path_cache_reset().
+//
+// Fields:
+//   hits: Lookups served from a cached route (whole or from a later tile)
+//   misses: Lookups that found nothing usable
+//   invalidations: Entries dropped because a chunk they depend on changed
+//                  or another map was loaded
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t invalidations;
+} PathCacheStats;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Returns a new copy of a cached cheapest path from (start_x, start_y) to
+// (goal_x, goal_y), laid out like find_path()'s (the start not included),
+// or NULL on a miss. Free it with free_path(). Start == goal is never a
+// lookup and counts as neither.
+Path* path_cache_lookup(int start_x, int start_y, int goal_x, int goal_y);
+
+// Keeps a copy of path (from the path pool, compact when long), found from
+// (start_x, start_y) to (goal_x, goal_y) on a map with the given serial and
+// revision (a snapshot's, for paths searched by workers). Replaces any
+// entry with the same endpoints. NULL, empty, hierarchical (only one leg
+// is known) and over-long paths, paths for another map, and trips whose
+// endpoints are equal or adjacent are ignored.
+void path_cache_store(Path* path, int start_x, int start_y, int goal_x, int goal_y,
+                      uint32_t map_serial, uint32_t map_revision);
+
+// path_cache_lookup(), or on a miss find_path() with the result stored.
+Path* find_path_cached(int start_x, int start_y, int goal_x, int goal_y);
+
+// Returns the counters.
+PathCacheStats path_cache_stats(void);
+
+// Drops every entry and zeroes the counters.
+void path_cache_reset(void);
+
+#endif  // PATH_CACHE_H
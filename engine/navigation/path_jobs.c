@@ -0,0 +1,484 @@
+// Implementation file for path_jobs.h
+// See path_jobs.h for detailed documentation.
+
+#include "navigation/path_jobs.h"
+#include "navigation/pathfinding.h"
+#include "navigation/hpa.h"
+#include "navigation/regions.h"
+#include "navigation/path_cache.h"
+#include "core/map.h"
+
+#include <stdio.h>
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types
+// -----------------------------------------------------------------------------
+
+// One request. Fields up to path are written by the simulation thread
+// before the job is handed out; cancelled and path are guarded by jobs_lock
+// while a worker owns the job.
+typedef struct {
+    PathTicket ticket;
+    int entity;             // Index into entities
+    int start_x, start_y;
+    int goal_x, goal_y;
+    int snapshot;           // Index into snapshots, -1 if not handed out
+    int urgent;             // Served before every other request
+    int cancelled;
+    Path* path;             // Result (NULL if no path)
+    uint32_t map_serial;    // Map the result was searched on (0: served from the path cache)
+    uint32_t map_revision;
+} PathJob;
+
+typedef struct {
+    Map map;
+    int readers;            // Jobs handed out against this snapshot
+} PlaneSnapshot;
+
+// Fixed-capacity FIFO of job indices
+typedef struct {
+    int items[PATH_JOB_QUEUE];
+    int head;
+    int count;
+} JobQueue;
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+// Simulation thread
+static PathJob jobs[PATH_JOB_QUEUE];
+static int free_jobs[PATH_JOB_QUEUE];
+static int free_count = -1;             // -1 until the free list is filled
+static JobQueue pending;                // Requested, not yet handed out
+static JobQueue cached;                 // Served from the path cache, not yet attached
+static PlaneSnapshot snapshots[PATH_JOB_SNAPSHOTS];
+static int newest_snapshot = -1;
+static PathTicket last_ticket = PATH_TICKET_NONE;
+static int started_this_tick = 0;
+
+// Without workers: searches in progress, each sliced over as many ticks as
+// it needs. search_jobs[i] is the job searches[i] serves, or -1.
+static PathSearch searches[PATH_JOB_SEARCHES];
+static int search_jobs[PATH_JOB_SEARCHES];
+
+// Shared with the workers, guarded by jobs_lock
+static SDL_Thread* workers[PATH_JOB_WORKERS];
+static int worker_count = 0;
+static SDL_mutex* jobs_lock = NULL;
+static SDL_cond* work_available = NULL;
+static int workers_quit = 0;
+static JobQueue work;                   // Handed out, not yet taken
+static JobQueue done;                   // Finished (or skipped), not yet attached
+
+static PathTicket queue_request(Entity* entity, int goal_x, int goal_y, int urgent);
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+static void queue_push(JobQueue* q, int job) {
+    q->items[(q->head + q->count++) % PATH_JOB_QUEUE] = job;
+}
+
+static void queue_push_front(JobQueue* q, int job) {
+    q->head = (q->head + PATH_JOB_QUEUE - 1) % PATH_JOB_QUEUE;
+    q->items[q->head] = job;
+    q->count++;
+}
+
+static int queue_pop(JobQueue* q) {
+    int job = q->items[q->head];
+    q->head = (q->head + 1) % PATH_JOB_QUEUE;
+    q->count--;
+    return job;
+}
+
+static void ensure_free_list(void) {
+    if (free_count >= 0) return;
+    free_count = 0;
+    for (int i = PATH_JOB_QUEUE - 1; i >= 0; i--) {
+        free_jobs[free_count++] = i;
+    }
+    for (int i = 0; i < PATH_JOB_SEARCHES; i++) {
+        search_jobs[i] = -1;
+    }
+}
+
+// Returns a snapshot of the current map for a new job to read, or -1 if
+// every older snapshot is still being read (the job then waits a tick).
+static int acquire_snapshot(void) {
+    if (newest_snapshot >= 0) {
+        const Map* map = &snapshots[newest_snapshot].map;
+        if (map->serial == world_map.serial && map->revision == world_map.revision) {
+            snapshots[newest_snapshot].readers++;
+            return newest_snapshot;
+        }
+    }
+
+    // Prefer updating the newest snapshot: it has the fewest changed chunks
+    int slot = newest_snapshot >= 0 && snapshots[newest_snapshot].readers == 0 ? newest_snapshot : -1;
+    for (int i = 0; i < PATH_JOB_SNAPSHOTS && slot < 0; i++) {
+        if (snapshots[i].readers == 0) slot = i;
+    }
+    if (slot < 0 || !map_snapshot_planes(&snapshots[slot].map)) return -1;
+
+    newest_snapshot = slot;
+    snapshots[slot].readers++;
+    return slot;
+}
+
+static void release_job(int index) {
+    PathJob* job = &jobs[index];
+    if (job->snapshot >= 0) snapshots[job->snapshot].readers--;
+    job->snapshot = -1;
+    job->ticket = PATH_TICKET_NONE;
+    free_jobs[free_count++] = index;
+}
+
+// Hands a pending job to the workers. Returns 0 if no snapshot is free.
+static int hand_out(int index) {
+    int snapshot = acquire_snapshot();
+    if (snapshot < 0) return 0;
+
+    jobs[index].snapshot = snapshot;
+    jobs[index].map_serial = snapshots[snapshot].map.serial;
+    jobs[index].map_revision = snapshots[snapshot].map.revision;
+    SDL_LockMutex(jobs_lock);
+    if (jobs[index].urgent) queue_push_front(&work, index);
+    else queue_push(&work, index);
+    SDL_CondSignal(work_available);
+    SDL_UnlockMutex(jobs_lock);
+    return 1;
+}
+
+// Gives a finished job's path to its entity if the entity still wants it,
+// and frees the job.
+static void attach_result(int index) {
+    PathJob job = jobs[index];
+    release_job(index);
+
+    if (job.map_serial != 0) {
+        path_cache_store(job.path, job.start_x, job.start_y, job.goal_x, job.goal_y,
+                         job.map_serial, job.map_revision);
+    }
+
+    Entity* e = job.entity < entity_count ? &entities[job.entity] : NULL;
+    if (job.cancelled || !e || e->path_ticket != job.ticket) {
+        free_path(job.path);
+        return;
+    }
+    e->path_ticket = PATH_TICKET_NONE;
+
+    // Moved while the search ran: plan again from here, just as urgently
+    if (e->x != job.start_x || e->y != job.start_y) {
+        free_path(job.path);
+        queue_request(e, job.goal_x, job.goal_y, job.urgent);
+        return;
+    }
+
+    if (job.path && job.path->length > 0) {
+        if (e->path) {
+            free_path(e->path);
+        }
+        e->path = job.path;
+        e->path->current = 0;
+        e->moving = 0;
+        e->move_progress = 0.0f;
+    } else {
+        free_path(job.path);
+    }
+}
+
+// Returns an idle search slot for a job, or -1. The last slot is kept for
+// urgent jobs, so a player's click never waits behind NPC searches.
+static int idle_search(int urgent) {
+    for (int i = urgent ? PATH_JOB_SEARCHES - 1 : PATH_JOB_SEARCHES - 2; i >= 0; i--) {
+        if (search_jobs[i] < 0) return i;
+    }
+    return -1;
+}
+
+// Orders search slot a before b: urgent first, then by ticket (oldest
+// first; tickets wrap).
+static int search_before(int a, int b) {
+    const PathJob* ja = &jobs[search_jobs[a]];
+    const PathJob* jb = &jobs[search_jobs[b]];
+    if (ja->urgent != jb->urgent) return ja->urgent;
+    return (int32_t)(ja->ticket - jb->ticket) < 0;
+}
+
+// Without workers: starts pending jobs while search slots are idle, then
+// spends PATH_JOB_TICK_NODES expansions on the searches in progress.
+// Urgent searches go first and may use the whole budget. The rest split
+// what is left evenly, oldest ticket first, and a search that finishes
+// under its share passes the remainder on, so one long search cannot
+// starve the others.
+static void run_searches(void) {
+    ensure_free_list();
+
+    while (pending.count > 0) {
+        int index = pending.items[pending.head];
+        if (jobs[index].cancelled) {
+            queue_pop(&pending);
+            release_job(index);
+            continue;
+        }
+
+        int slot = idle_search(jobs[index].urgent);
+        if (slot < 0) break;
+        queue_pop(&pending);
+        search_jobs[slot] = index;
+        jobs[index].map_serial = world_map.serial;
+        jobs[index].map_revision = world_map.revision;
+        path_search_begin(&searches[slot], jobs[index].start_x, jobs[index].start_y,
+                          jobs[index].goal_x, jobs[index].goal_y);
+    }
+
+    // Running slots in the order they are served
+    int order[PATH_JOB_SEARCHES];
+    int count = 0;
+    int urgent_count = 0;
+    for (int i = 0; i < PATH_JOB_SEARCHES; i++) {
+        int index = search_jobs[i];
+        if (index < 0) continue;
+
+        if (jobs[index].cancelled) {
+            search_jobs[i] = -1;
+            release_job(index);
+            continue;
+        }
+
+        int at = count++;
+        while (at > 0 && search_before(i, order[at - 1])) {
+            order[at] = order[at - 1];
+            at--;
+        }
+        order[at] = i;
+        urgent_count += jobs[index].urgent;
+    }
+
+    int budget = PATH_JOB_TICK_NODES;
+    for (int n = 0; n < count && budget > 0; n++) {
+        int i = order[n];
+        int index = search_jobs[i];
+        int share = n < urgent_count ? budget : budget / (count - n);
+        if (share < 1) share = 1;
+
+        budget -= path_search_step(&searches[i], share);
+        if (searches[i].state == PATH_SEARCH_DONE) {
+            search_jobs[i] = -1;
+            jobs[index].path = path_search_take(&searches[i]);
+            attach_result(index);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Worker Threads
+// -----------------------------------------------------------------------------
+
+static int path_worker(void* unused) {
+    SDL_LockMutex(jobs_lock);
+
+    while (1) {
+        while (!workers_quit && work.count == 0) {
+            SDL_CondWait(work_available, jobs_lock);
+        }
+        if (workers_quit) break;
+
+        PathJob* job = &jobs[queue_pop(&work)];
+        if (!job->cancelled) {
+            SDL_UnlockMutex(jobs_lock);
+            nav_map = &snapshots[job->snapshot].map;
+            Path* path = find_path(job->start_x, job->start_y, job->goal_x, job->goal_y);
+            SDL_LockMutex(jobs_lock);
+            job->path = path;
+        }
+        queue_push(&done, (int)(job - jobs));
+    }
+
+    SDL_UnlockMutex(jobs_lock);
+    release_path_workspace();
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+int path_jobs_start(void) {
+    if (worker_count > 0) return 1;
+
+    jobs_lock = SDL_CreateMutex();
+    work_available = SDL_CreateCond();
+    if (!jobs_lock || !work_available) {
+        printf("Failed to create path job queue: %s\n", SDL_GetError());
+        path_jobs_stop();
+        return 0;
+    }
+
+    workers_quit = 0;
+    for (int i = 0; i < PATH_JOB_WORKERS; i++) {
+        workers[i] = SDL_CreateThread(path_worker, "path_worker", NULL);
+        if (!workers[i]) {
+            printf("Failed to start path worker: %s\n", SDL_GetError());
+            path_jobs_stop();
+            return 0;
+        }
+        worker_count++;
+    }
+    return 1;
+}
+
+void path_jobs_stop(void) {
+    if (jobs_lock) {
+        SDL_LockMutex(jobs_lock);
+        workers_quit = 1;
+        SDL_CondBroadcast(work_available);
+        SDL_UnlockMutex(jobs_lock);
+    }
+    for (int i = 0; i < worker_count; i++) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+    worker_count = 0;
+
+    // Workers are gone; drop whatever they left behind
+    while (work.count > 0) release_job(queue_pop(&work));
+    while (done.count > 0) {
+        int index = queue_pop(&done);
+        free_path(jobs[index].path);
+        release_job(index);
+    }
+    while (pending.count > 0) release_job(queue_pop(&pending));
+    while (cached.count > 0) {
+        int index = queue_pop(&cached);
+        free_path(jobs[index].path);
+        release_job(index);
+    }
+    ensure_free_list();
+    for (int i = 0; i < PATH_JOB_SEARCHES; i++) {
+        if (search_jobs[i] >= 0) release_job(search_jobs[i]);
+        search_jobs[i] = -1;
+        path_search_free(&searches[i]);
+    }
+
+    for (int i = 0; i < entity_count; i++) {
+        entities[i].path_ticket = PATH_TICKET_NONE;
+    }
+    for (int i = 0; i < PATH_JOB_SNAPSHOTS; i++) {
+        map_free_snapshot(&snapshots[i].map);
+        snapshots[i].readers = 0;
+    }
+    newest_snapshot = -1;
+
+    if (work_available) SDL_DestroyCond(work_available);
+    if (jobs_lock) SDL_DestroyMutex(jobs_lock);
+    work_available = NULL;
+    jobs_lock = NULL;
+}
+
+// Queues a request; urgent ones go ahead of everything still waiting and
+// start at once regardless of the tick budget.
+static PathTicket queue_request(Entity* entity, int goal_x, int goal_y, int urgent) {
+    cancel_path_request(entity);
+    ensure_free_list();
+    if (free_count == 0) return PATH_TICKET_NONE;
+
+    // Unreachable goals never take a worker's time
+    if (!regions_connected(entity->x, entity->y, goal_x, goal_y)) return PATH_TICKET_NONE;
+
+    if (++last_ticket == PATH_TICKET_NONE) ++last_ticket;
+
+    int index = free_jobs[--free_count];
+    jobs[index] = (PathJob){
+        last_ticket, (int)(entity - entities),
+        entity->x, entity->y, goal_x, goal_y,
+        -1, urgent, 0, NULL, 0, 0
+    };
+    entity->path_ticket = last_ticket;
+
+    // Same or overlapping trip found recently: no search at all
+    jobs[index].path = path_cache_lookup(entity->x, entity->y, goal_x, goal_y);
+    if (jobs[index].path) {
+        queue_push(&cached, index);
+        return last_ticket;
+    }
+
+    // Start right away while this tick's budget lasts
+    if (worker_count > 0 && (urgent || (pending.count == 0 && started_this_tick < PATH_JOB_TICK_BUDGET)) &&
+        hand_out(index)) {
+        started_this_tick++;
+    } else if (urgent) {
+        queue_push_front(&pending, index);
+    } else {
+        queue_push(&pending, index);
+    }
+    return last_ticket;
+}
+
+PathTicket request_path(Entity* entity, int goal_x, int goal_y) {
+    return queue_request(entity, goal_x, goal_y, 0);
+}
+
+PathTicket request_path_urgent(Entity* entity, int goal_x, int goal_y) {
+    return queue_request(entity, goal_x, goal_y, 1);
+}
+
+void cancel_path_request(Entity* entity) {
+    PathTicket ticket = entity->path_ticket;
+    if (ticket == PATH_TICKET_NONE) return;
+    entity->path_ticket = PATH_TICKET_NONE;
+
+    for (int i = 0; i < PATH_JOB_QUEUE; i++) {
+        if (jobs[i].ticket != ticket) continue;
+
+        // Pending jobs are dropped when they reach the front of the queue;
+        // handed-out ones are skipped by the worker or discarded on return
+        if (jobs[i].snapshot >= 0) SDL_LockMutex(jobs_lock);
+        jobs[i].cancelled = 1;
+        if (jobs[i].snapshot >= 0) SDL_UnlockMutex(jobs_lock);
+        return;
+    }
+}
+
+void path_jobs_update(void) {
+    started_this_tick = 0;
+    hpa_update(HPA_TICK_BUILDS);
+
+    while (cached.count > 0) {
+        attach_result(queue_pop(&cached));
+    }
+
+    if (worker_count > 0) {
+        int finished[PATH_JOB_QUEUE];
+        int finished_count = 0;
+
+        SDL_LockMutex(jobs_lock);
+        while (done.count > 0) finished[finished_count++] = queue_pop(&done);
+        SDL_UnlockMutex(jobs_lock);
+
+        for (int i = 0; i < finished_count; i++) {
+            attach_result(finished[i]);
+        }
+    }
+
+    if (worker_count == 0) {
+        run_searches();
+        return;
+    }
+
+    while (pending.count > 0 && started_this_tick < PATH_JOB_TICK_BUDGET) {
+        int index = pending.items[pending.head];
+        if (jobs[index].cancelled) {
+            queue_pop(&pending);
+            release_job(index);
+            continue;
+        }
+
+        if (!hand_out(index)) break;    // Every snapshot is in use; try again next tick
+        queue_pop(&pending);
+        started_this_tick++;
+    }
+}
@@ -0,0 +1,128 @@
+// -----------------------------------------------------------------------------
+// path_jobs.h
+//
+// Asynchronous path requests served by a pool of worker threads.
+// This module handles:
+//
+// - Tickets: request_path() queues a search for an entity and returns at
+//   once; the result is attached to Entity::path at the start of a later
+//   tick by path_jobs_update()
+// - Workers: PATH_JOB_WORKERS threads run find_path() against a read-only
+//   snapshot of the navigation planes (see map_snapshot_planes()), so
+//   searches never race the simulation's map edits
+// - Budget: at most PATH_JOB_TICK_BUDGET requests are handed to workers per
+//   tick; the rest wait for later ticks in request order
+// - Priority: urgent requests (the player's clicks, request_path_urgent())
+//   go ahead of every waiting request and are never held back by the budget
+// - Cancellation: a new request for an entity supersedes its previous one;
+//   superseded and cancelled requests are dropped before they run, or their
+//   result is discarded if they already started
+//
+// Flow:
+//
+//   Simulation thread                     Worker threads
+//   -----------------                     --------------
+//   request_path()  -> pending / work     take job, nav_map = snapshot
+//   path_jobs_update() (start of tick)    find_path()
+//     attach finished results  <--------  done
+//     hand pending jobs to workers
+//
+// Without workers (path_jobs_start() not called, e.g. headless runs and
+// tools) path_jobs_update() searches on the simulation thread against the
+// live map, so runs stay repeatable. Up to PATH_JOB_SEARCHES requests are
+// searched at once as resumable searches (PathSearch, see pathfinding.h),
+// and all of them together expand at most PATH_JOB_TICK_NODES nodes per
+// tick: a long search, or many NPCs repathing at once, takes more ticks
+// instead of a longer tick. Urgent searches spend the budget first, and
+// one search slot is kept for them; the others split the rest evenly,
+// oldest ticket first.
+//
+// Snapshots: up to PATH_JOB_SNAPSHOTS snapshots of the planes are kept. They
+// share plane pages with world_map copy-on-write (see map_snapshot_planes()),
+// so each costs a page table plus the pages edited while it is alive. A job
+// uses the newest one; when the map has changed since, a snapshot no job is
+// reading is brought up to date by swapping in only the changed pages.
+//
+// Path cache: a request whose trip a recent result already covers (see
+// path_cache.h) is served from the cache and attached by the next
+// path_jobs_update() without a search; every searched result is stored.
+//
+// Chunk hierarchy: path_jobs_update() also builds up to HPA_TICK_BUILDS
+// missing or stale clusters (hpa_update()), so long trips find the
+// hierarchy ready instead of building it mid-search.
+//
+// If the entity has moved off the tile a result starts from by the time it
+// arrives, the request is made again from where the entity now stands.
+//
+// Threading: everything here except the workers themselves belongs to the
+// simulation thread.
+//
+// Design goals:
+// - No search runs on the simulation thread while workers are running
+// - A burst of requests spreads over several ticks instead of stalling one
+// -----------------------------------------------------------------------------
+
+#ifndef PATH_JOBS_H
+#define PATH_JOBS_H
+
+#include "entity/entity.h"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define PATH_JOB_WORKERS        2       // Worker threads started by path_jobs_start()
+#define PATH_JOB_QUEUE          256     // Requests outstanding at once; more are refused
+#define PATH_JOB_TICK_BUDGET    32      // Requests started per tick
+#define PATH_JOB_TICK_NODES     4096    // Nodes searched per tick without workers
+#define PATH_JOB_SEARCHES       4       // Searches in progress without workers
+#define PATH_JOB_SNAPSHOTS      4       // Plane snapshots kept for workers
+
+#define PATH_TICKET_NONE        0
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Identifies one request. Stored in Entity::path_ticket while the request
+// is outstanding; never reused.
+typedef uint32_t PathTicket;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Starts the worker threads. Returns 1 on success, 0 on failure (requests
+// are then served by path_jobs_update() on the calling thread).
+int path_jobs_start(void);
+
+// Stops the workers and drops every outstanding request and snapshot.
+// Safe to call when the workers were never started.
+void path_jobs_stop(void);
+
+// Requests a path for entity from its current tile to (goal_x, goal_y),
+// superseding any request it already has outstanding. The path replaces
+// entity->path when it arrives; if no path is found, entity->path is left
+// alone.
+//
+// Returns the request's ticket, or PATH_TICKET_NONE if PATH_JOB_QUEUE
+// requests are already outstanding or no path can exist (the goal is
+// unwalkable or in another region, see regions.h).
+PathTicket request_path(Entity* entity, int goal_x, int goal_y);
+
+// Same as request_path(), but served before every non-urgent request: for
+// paths a player is waiting on.
+PathTicket request_path_urgent(Entity* entity, int goal_x, int goal_y);
+
+// Cancels entity's outstanding request, if any.
+void cancel_path_request(Entity* entity);
+
+// Call at the start of every tick: builds a few chunk hierarchy clusters,
+// attaches finished results to their entities and starts pending requests
+// within the tick budget (without workers: advances the searches within
+// the node budget).
+void path_jobs_update(void);
+
+#endif  // PATH_JOBS_H
@@ -0,0 +1,232 @@
+// Implementation file for path_pool.h
+// See path_pool.h for detailed documentation.
+
+#include "navigation/path_pool.h"
+#include "navigation/search.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types and Constants
+// -----------------------------------------------------------------------------
+
+// Classes: 16, 32, 48 and 64 bytes, then four per doubling up to
+// PATH_POOL_MAX_BLOCK (80, 96, 112, 128, 160, ...)
+#define POOL_CLASSES    44
+#define LARGE_BLOCK     -1      // size_class of blocks from malloc()
+
+// Precedes every block; blocks are handed out just past it
+typedef union {
+    int32_t size_class;
+    uint64_t align;
+} BlockHeader;
+
+// Free blocks keep the next free block of their class where their data was
+typedef struct FreeBlock {
+    struct FreeBlock* next;
+} FreeBlock;
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+static SDL_SpinLock pool_lock = 0;
+static FreeBlock* free_lists[POOL_CLASSES];
+static PathPoolStats stats;
+
+static __thread PathNode* scratch = NULL;
+static __thread int scratch_capacity = 0;
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+// Class of a block of total bytes (header included), or -1 if none fits.
+static int class_of(size_t total) {
+    if (total > PATH_POOL_MAX_BLOCK) return -1;
+    if (total <= 64) return (int)((total + 15) / 16) - 1;
+
+    int p = 6;
+    while (((size_t)1 << (p + 1)) < total) p++;     // total in (2^p, 2^(p+1)]
+    size_t step = (size_t)1 << (p - 2);
+    return 4 + (p - 6) * 4 + (int)((total + step - 1) / step) - 5;
+}
+
+static size_t class_size(int size_class) {
+    if (size_class < 4) return (size_t)(size_class + 1) * 16;
+    int p = 6 + (size_class - 4) / 4;
+    return (size_t)(5 + (size_class - 4) % 4) << (p - 2);
+}
+
+// Carves a new slab into free blocks of size_class. Caller holds pool_lock.
+static int grow_class(int size_class) {
+    size_t size = class_size(size_class);
+    size_t count = PATH_POOL_SLAB / size;
+    char* slab = malloc(size * count);
+    if (!slab) return 0;
+
+    stats.bytes_reserved += size * count;
+    stats.heap_allocations++;
+    for (size_t i = 0; i < count; i++) {
+        FreeBlock* block = (FreeBlock*)(slab + i * size + sizeof(BlockHeader));
+        block->next = free_lists[size_class];
+        free_lists[size_class] = block;
+    }
+    return 1;
+}
+
+// search_dirs index of the move from a to b, or -1 if they are not
+// neighbours.
+static int move_code(PathNode a, PathNode b) {
+    for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+        if (b.x - a.x == search_dirs[dir][0] && b.y - a.y == search_dirs[dir][1]) return dir;
+    }
+    return -1;
+}
+
+static int can_compact(const PathNode* nodes, int length) {
+    if (length < PATH_COMPACT_LENGTH) return 0;
+    for (int i = 1; i < length; i++) {
+        if (move_code(nodes[i - 1], nodes[i]) < 0) return 0;
+    }
+    return 1;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+void* path_pool_alloc(size_t bytes) {
+    size_t total = bytes + sizeof(BlockHeader);
+    int size_class = class_of(total);
+
+    if (size_class < 0) {
+        BlockHeader* header = malloc(total);
+        if (!header) return NULL;
+        header->size_class = LARGE_BLOCK;
+
+        SDL_AtomicLock(&pool_lock);
+        stats.heap_allocations++;
+        SDL_AtomicUnlock(&pool_lock);
+        return header + 1;
+    }
+
+    SDL_AtomicLock(&pool_lock);
+    if (!free_lists[size_class] && !grow_class(size_class)) {
+        SDL_AtomicUnlock(&pool_lock);
+        return NULL;
+    }
+    FreeBlock* block = free_lists[size_class];
+    free_lists[size_class] = block->next;
+    stats.bytes_in_use += class_size(size_class);
+    SDL_AtomicUnlock(&pool_lock);
+
+    ((BlockHeader*)block - 1)->size_class = size_class;
+    return block;
+}
+
+void path_pool_free(void* block) {
+    if (!block) return;
+
+    BlockHeader* header = (BlockHeader*)block - 1;
+    int size_class = header->size_class;
+    if (size_class == LARGE_BLOCK) {
+        free(header);
+        return;
+    }
+
+    SDL_AtomicLock(&pool_lock);
+    ((FreeBlock*)block)->next = free_lists[size_class];
+    free_lists[size_class] = block;
+    stats.bytes_in_use -= class_size(size_class);
+    SDL_AtomicUnlock(&pool_lock);
+}
+
+PathNode* path_scratch(int length) {
+    if (length > scratch_capacity) {
+        int capacity = scratch_capacity > 0 ? scratch_capacity : 256;
+        while (capacity < length) capacity *= 2;
+        PathNode* grown = realloc(scratch, sizeof(PathNode) * capacity);
+        if (!grown) return NULL;
+        scratch = grown;
+        scratch_capacity = capacity;
+    }
+    return scratch;
+}
+
+Path* path_from_nodes(const PathNode* nodes, int length) {
+    Path* path = path_pool_alloc(sizeof(Path));
+    if (!path) return NULL;
+    memset(path, 0, sizeof(*path));
+    path->length = length;
+    if (length <= 0) return path;
+
+    if (can_compact(nodes, length)) {
+        size_t bytes = (size_t)(length - 1 + 3) / 4;
+        uint8_t* moves = path_pool_alloc(bytes);
+        if (!moves) {
+            path_pool_free(path);
+            return NULL;
+        }
+        memset(moves, 0, bytes);
+        for (int i = 1; i < length; i++) {
+            moves[(i - 1) >> 2] |= (uint8_t)(move_code(nodes[i - 1], nodes[i]) << (((i - 1) & 3) * 2));
+        }
+        path->steps = moves;
+        path->compact = 1;
+        path->first = nodes[0];
+        path->cursor_node = nodes[0];
+        return path;
+    }
+
+    path->steps = path_pool_alloc(sizeof(PathNode) * length);
+    if (!path->steps) {
+        path_pool_free(path);
+        return NULL;
+    }
+    memcpy(path->steps, nodes, sizeof(PathNode) * length);
+    return path;
+}
+
+Path* path_copy(Path* path, int offset) {
+    int length = path->length - offset;
+    PathNode* nodes = path_scratch(length > 0 ? length : 1);
+    if (!nodes) return NULL;
+    for (int i = 0; i < length; i++) {
+        nodes[i] = path_node(path, offset + i);
+    }
+    return path_from_nodes(nodes, length);
+}
+
+PathNode path_node(Path* path, int index) {
+    if (!path->compact) return ((const PathNode*)path->steps)[index];
+
+    if (index < path->cursor) {
+        path->cursor = 0;
+        path->cursor_node = path->first;
+    }
+
+    const uint8_t* moves = path->steps;
+    while (path->cursor < index) {
+        int i = path->cursor++;
+        int dir = (moves[i >> 2] >> ((i & 3) * 2)) & 3;
+        path->cursor_node.x += search_dirs[dir][0];
+        path->cursor_node.y += search_dirs[dir][1];
+    }
+    return path->cursor_node;
+}
+
+PathPoolStats path_pool_stats(void) {
+    SDL_AtomicLock(&pool_lock);
+    PathPoolStats result = stats;
+    SDL_AtomicUnlock(&pool_lock);
+    return result;
+}
+
+void release_path_scratch(void) {
+    free(scratch);
+    scratch = NULL;
+    scratch_capacity = 0;
+}
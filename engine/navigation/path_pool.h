@@ -0,0 +1,109 @@
+// -----------------------------------------------------------------------------
+// path_pool.h
+//
+// Storage for Paths.
+// This module handles:
+//
+// - A slab allocator for everything a Path owns (the Path itself, its tiles
+//   and its waypoints): blocks come in size classes four to a doubling, so
+//   storage is within 25% of a path's exact length, and freed blocks go
+//   back on their class's free list for the next path instead of to the
+//   heap
+// - Compact tiles: paths of PATH_COMPACT_LENGTH tiles or more are stored as
+//   their first tile plus one 2-bit move (a search_dirs index) per further
+//   tile, 32 times smaller than PathNodes
+// - path_node(), which reads either layout; compact paths decode from a
+//   cursor, so walking a path in order costs O(1) per tile
+// - A per-thread scratch buffer that path builders fill before handing the
+//   tiles to path_from_nodes()
+//
+// Once the slabs and scratch buffers have grown to the working set, making
+// and freeing paths does not touch the heap. Slabs are never returned.
+//
+// Usage:
+//
+//   PathNode* nodes = path_scratch(length);
+//   ... fill nodes[0 .. length - 1] ...
+//   Path* path = path_from_nodes(nodes, length);
+//   PathNode next = path_node(path, path->current);
+//   free_path(path);
+//
+// Threading: the pool is shared and guarded by a spin lock, so paths may be
+// made on one thread (path workers) and freed on another. A Path itself is
+// used by one thread at a time (path_node() moves its cursor). Scratch
+// buffers are per thread.
+//
+// Design goals:
+// - No heap traffic per path once warmed up
+// - Memory per stored path close to its length in 2-bit moves
+// -----------------------------------------------------------------------------
+
+#ifndef PATH_POOL_H
+#define PATH_POOL_H
+
+#include "navigation/pathfinding.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define PATH_COMPACT_LENGTH     16          // Paths this long or longer are stored as moves
+#define PATH_POOL_SLAB          65536       // Bytes carved into blocks at a time
+#define PATH_POOL_MAX_BLOCK     65536       // Larger requests go straight to malloc()
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Pool usage since start-up.
+//
+// Fields:
+//   bytes_in_use: Bytes of blocks currently handed out (including headers)
+//   bytes_reserved: Bytes of slabs taken from the heap
+//   heap_allocations: Slabs plus blocks too large for any class, i.e. the
+//                     times the pool itself called malloc()
+typedef struct {
+    size_t bytes_in_use;
+    size_t bytes_reserved;
+    uint32_t heap_allocations;
+} PathPoolStats;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Returns a block of at least bytes bytes (8-byte aligned), or NULL if the
+// heap is exhausted. Free it with path_pool_free().
+void* path_pool_alloc(size_t bytes);
+
+// Returns a block to the pool. Safe to call with NULL.
+void path_pool_free(void* block);
+
+// Returns the calling thread's scratch buffer, grown to hold at least
+// length tiles, or NULL if it cannot grow. The buffer is reused by the next
+// call on the same thread.
+PathNode* path_scratch(int length);
+
+// Returns a new Path holding nodes[0 .. length - 1] (compact if long enough
+// and every tile is next to the one before), with current = 0, or NULL if
+// the pool is exhausted. nodes may be the scratch buffer. Free the path
+// with free_path().
+Path* path_from_nodes(const PathNode* nodes, int length);
+
+// Returns a new Path holding the tiles of path from index offset on, or
+// NULL if the pool is exhausted.
+Path* path_copy(Path* path, int offset);
+
+// Returns tile index (0 <= index < path->length) of path.
+PathNode path_node(Path* path, int index);
+
+// Returns the pool's usage counters.
+PathPoolStats path_pool_stats(void);
+
+// Frees the calling thread's scratch buffer (see release_path_workspace()).
+void release_path_scratch(void);
+
+#endif  // PATH_POOL_H
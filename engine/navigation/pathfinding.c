@@ -3,32 +3,45 @@
 
 #include "navigation/pathfinding.h"
 #include "navigation/grid.h"
+#include "navigation/search.h"
+#include "navigation/jps.h"
+#include "navigation/hpa.h"
+#include "navigation/regions.h"
+#include "navigation/path_pool.h"
 #include "core/constants.h"
 #include "core/tile.h"
+#include "core/profiler.h"
 
 #include <stdlib.h>
-#include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 // -----------------------------------------------------------------------------
 // Internal Types and Constants
 // -----------------------------------------------------------------------------
 
-#define MAX_PATH_LENGTH 256
 #define MIN_TILE_COST 1
 
-// Internal node representation for A* algorithm.
-// Exists only during pathfinding and is discarded afterwards.
-typedef struct {
-    int x, y;
-    int g_cost;     // Cost from start
-    int h_cost;     // Heuristic to goal
-    int f_cost;     // g + h
-    int parent_x;
-    int parent_y;
-    int in_open;
-    int in_closed;
-} Node;
+// find_path() uses plain A* once more than 1 tile in this many is weighted:
+// scattered rubble turns most flat tiles into jump points and jumping
+// stops paying for itself (measured crossover around 1 in 25)
+#define JPS_MAX_WEIGHTED_SHARE 32
+
+typedef SearchNode* (*SearchFunc)(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y);
+
+// Which trips search_path() plans through hpa.h
+typedef enum {
+    ROUTE_TILES,            // None: every trip is searched tile by tile
+    ROUTE_LONG_TRIPS,       // Trips of PATH_HIERARCHY_DISTANCE or more, once hpa_ready()
+    ROUTE_HIERARCHY         // Every trip, building the clusters it needs
+} RouteMode;
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+// Each thread that plans paths keeps its own workspace between calls
+static __thread SearchSpace* thread_space = NULL;
 
 // -----------------------------------------------------------------------------
 // Internal Helpers
@@ -38,162 +51,427 @@ static int heuristic(int x1, int y1, int x2, int y2) {
     return (abs(x1 - x2) + abs(y1 - y2)) * MIN_TILE_COST;
 }
 
-static Node* get_node(Node* nodes, int x, int y) {
-    return &nodes[y * MAP_WIDTH + x];
+static SearchSpace* get_thread_space(void) {
+    if (!thread_space) {
+        thread_space = malloc(sizeof(SearchSpace));
+        if (!thread_space) return NULL;
+        search_space_init(thread_space);
+    }
+    return thread_space;
 }
 
-static Node* find_lowest_f(Node* nodes) {
-    Node* best = NULL;
+// Walks back from the goal one tile at a time and returns the number of
+// tiles before the start; fills out (if not NULL) in start -> goal order.
+//
+// A node's parent field only gives the direction of the segment that
+// reached it (one step for A*, a whole jump for JPS). Going backwards, the
+// cost of the route so far says what g the tile that segment started from
+// must have, so the first node on the segment with exactly that g is a
+// valid predecessor (the segment's own start always is).
+static int walk_back(SearchSpace* space, SearchNode* goal, int goal_x, int goal_y,
+                     PathNode* out, int length) {
+    int x = goal_x, y = goal_y;
+    int g = goal->g;
+    int dir = goal->parent;
+    int count = 0;
+
+    while (dir != SEARCH_NO_PARENT) {
+        if (out) out[length - 1 - count] = (PathNode) { x, y };
+        count++;
+
+        g -= map_move_cost(x, y);
+        x -= search_dirs[dir][0];
+        y -= search_dirs[dir][1];
+
+        SearchNode* node = search_peek(space, x, y);
+        if (node && node->g == g) dir = node->parent;
+    }
+    return count;
+}
 
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            Node* n = get_node(nodes, x, y);
-            if (!n->in_open) continue;
+static Path* reconstruct_path(SearchSpace* space, SearchNode* goal, int goal_x, int goal_y) {
+    // Count first; long paths on big maps exceed any fixed buffer
+    int length = walk_back(space, goal, goal_x, goal_y, NULL, 0);
 
-            if (!best || n->f_cost < best->f_cost) {
-                best = n;
-            }
+    PathNode* nodes = path_scratch(length > 0 ? length : 1);
+    if (!nodes) return NULL;
+    walk_back(space, goal, goal_x, goal_y, nodes, length);
+    return path_from_nodes(nodes, length);
+}
+
+// Opens the start of a plain A* search. Returns 0 on allocation failure.
+static int astar_begin(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y) {
+    if (!search_begin(space)) return 0;
+
+    SearchNode* start = search_node(space, start_x, start_y);
+    if (!start) return 0;
+    int start_h = heuristic(start_x, start_y, goal_x, goal_y);
+    start->g = 0;
+    return search_open(space, start, start_x, start_y, start_h, start_h);
+}
+
+// Offers the walkable neighbours of popped node current (at x, y) that lie
+// in tiles [x0, x1) x [y0, y1). Returns 0 on allocation failure.
+static int astar_expand(SearchSpace* space, SearchNode* current, int x, int y, int goal_x, int goal_y,
+                        int x0, int y0, int x1, int y1) {
+    for (int i = 0; i < SEARCH_DIRS; i++) {
+        int nx = x + search_dirs[i][0];
+        int ny = y + search_dirs[i][1];
+
+        if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1) continue;
+        if (!map_walkable(nx, ny)) continue;    // One load + bit test
+
+        SearchNode* neighbor = search_node(space, nx, ny);
+        if (!neighbor) return 0;
+        if (neighbor->heap_index == SEARCH_CLOSED) continue;   // Consistent heuristic: final
+
+        int tentative_g = current->g + map_move_cost(nx, ny);
+
+        if (tentative_g < neighbor->g) {
+            int h = heuristic(nx, ny, goal_x, goal_y);
+            neighbor->parent = (uint8_t)i;
+            neighbor->g = tentative_g;
+            if (!search_open(space, neighbor, nx, ny, tentative_g + h, h)) return 0;
         }
     }
+    return 1;
+}
 
-    return best;
+// Plain A* that never leaves tiles [x0, x1) x [y0, y1): every walkable
+// neighbour is a node. Returns the goal's node.
+static SearchNode* astar_search_within(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y,
+                                       int x0, int y0, int x1, int y1) {
+    if (!astar_begin(space, start_x, start_y, goal_x, goal_y)) return NULL;
+
+    // Main A* loop
+    SearchNode* current;
+    int x, y;
+    while ((current = search_pop(space, &x, &y))) {
+        if (x == goal_x && y == goal_y) return current;
+        if (!astar_expand(space, current, x, y, goal_x, goal_y, x0, y0, x1, y1)) return NULL;
+    }
+    return NULL;
 }
 
-static Path* reconstruct_path(Node* nodes, Node* goal, int start_x, int start_y) {
-    Path* path = malloc(sizeof(Path));
-    if (!path) return NULL;
+static SearchNode* astar_search(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y) {
+    return astar_search_within(space, start_x, start_y, goal_x, goal_y, 0, 0, map_width(), map_height());
+}
 
-    path->nodes = malloc(sizeof(PathNode) * MAX_PATH_LENGTH);
-    path->length = 0;
-    path->current = 0;
+// Refines one leg of a hierarchical path. Legs inside one chunk stay in
+// that chunk, as the hierarchy's costs did; jump search would scan far
+// outside it on open maps. Legs across a border are a single step.
+static SearchNode* leg_search(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y) {
+    int cx = start_x >> MAP_CHUNK_SHIFT;
+    int cy = start_y >> MAP_CHUNK_SHIFT;
+    if (cx != goal_x >> MAP_CHUNK_SHIFT || cy != goal_y >> MAP_CHUNK_SHIFT) {
+        return astar_search(space, start_x, start_y, goal_x, goal_y);
+    }
 
-    Node* current = goal;
+    int x0 = cx << MAP_CHUNK_SHIFT;
+    int y0 = cy << MAP_CHUNK_SHIFT;
+    return astar_search_within(space, start_x, start_y, goal_x, goal_y, x0, y0,
+                               x0 + MAP_CHUNK_SIZE < map_width() ? x0 + MAP_CHUNK_SIZE : map_width(),
+                               y0 + MAP_CHUNK_SIZE < map_height() ? y0 + MAP_CHUNK_SIZE : map_height());
+}
 
-    // Walk backwards through parent links
-    while (current->parent_x != -1) {
-        path->nodes[path->length++] = (PathNode) {
-            current->x,
-            current->y
-        };
+// JPS unless weighted tiles are common enough that plain A* is faster
+static SearchFunc pick_search(void) {
+    int jump = (int64_t)nav_map->weighted_tiles * JPS_MAX_WEIGHTED_SHARE <=
+               (int64_t)nav_map->width * nav_map->height;
+    return jump ? jps_search : astar_search;
+}
 
-        current = get_node(nodes, current->parent_x, current->parent_y);
+// Plans waypoints through the chunk hierarchy and refines the first leg.
+static Path* plan_hierarchical(SearchSpace* space, int start_x, int start_y, int goal_x, int goal_y) {
+    PathNode* waypoints = NULL;
+    int count = 0;
+    if (!hpa_find_waypoints(space, start_x, start_y, goal_x, goal_y, &waypoints, &count)) {
+        printf("Pathfinding: A* algorithm exhausted all possibilities, no path found from (%d,%d) to (%d,%d)\n",
+               start_x, start_y, goal_x, goal_y);
+        return NULL;
     }
 
-    // Reverse path so it runs from start -> goal
-    for (int i = 0; i < path->length / 2; i++) {
-        PathNode tmp = path->nodes[i];
-        path->nodes[i] = path->nodes[path->length - 1 - i];
-        path->nodes[path->length - 1 - i] = tmp;
+    Path* path = path_from_nodes(NULL, 0);
+    if (!path) {
+        path_pool_free(waypoints);
+        return NULL;
     }
+    path->waypoints = waypoints;
+    path->waypoint_count = count;
+    path->next_waypoint = 1;
 
+    if (!refine_path(path)) {
+        free_path(path);
+        return NULL;
+    }
     return path;
 }
 
-// -----------------------------------------------------------------------------
-// Public API Implementation
-// -----------------------------------------------------------------------------
+// Settles trips that need no search: start == goal, unwalkable ends, and
+// ends in different regions. Returns 1 and sets *path (NULL if there is no
+// path) if the trip is settled, 0 if it needs a search.
+static int settle_trip(int start_x, int start_y, int goal_x, int goal_y, Path** path) {
+    *path = NULL;
 
-void free_path(Path* path) {
-    if (!path) return;
-    free(path->nodes);
-    free(path);
-}
-
-Path* find_path(int start_x, int start_y, int goal_x, int goal_y) {
     // Early out if start == goal
     if (start_x == goal_x && start_y == goal_y) {
-        Path* path = malloc(sizeof(Path));
-        if (!path) return NULL;
-        path->nodes = malloc(sizeof(PathNode));
-        path->nodes[0] = (PathNode) { start_x, start_y };
-        path->length = 1;
-        path->current = 0;
-        return path;
+        PathNode start = { start_x, start_y };
+        *path = path_from_nodes(&start, 1);
+        return 1;
     }
 
     // Check if tiles are walkable
-    if (!is_tile_walkable(start_x, start_y)) {
+    if (!is_tile_in_bounds(start_x, start_y) || !map_walkable(start_x, start_y)) {
         printf("Pathfinding: Start tile (%d,%d) is not walkable\n", start_x, start_y);
-        return NULL;
+        return 1;
     }
 
-    if (!is_tile_walkable(goal_x, goal_y)) {
+    if (!is_tile_in_bounds(goal_x, goal_y) || !map_walkable(goal_x, goal_y)) {
         printf("Pathfinding: Goal tile (%d,%d) is not walkable\n", goal_x, goal_y);
+        return 1;
+    }
+
+    // Workers search snapshots; regions only describe the live map
+    if (nav_map == &world_map && !regions_connected(start_x, start_y, goal_x, goal_y)) {
+        printf("Pathfinding: No path from (%d,%d) to (%d,%d), they are in different regions\n",
+               start_x, start_y, goal_x, goal_y);
+        return 1;
+    }
+    return 0;
+}
+
+static int is_hierarchical_trip(int start_x, int start_y, int goal_x, int goal_y) {
+    return heuristic(start_x, start_y, goal_x, goal_y) >= PATH_HIERARCHY_DISTANCE;
+}
+
+// search: tile-level search to run; route: which trips go through hpa.h
+static Path* search_path(SearchFunc search, RouteMode route, int start_x, int start_y, int goal_x, int goal_y) {
+    Path* settled;
+    if (settle_trip(start_x, start_y, goal_x, goal_y, &settled)) return settled;
+
+    SearchSpace* space = get_thread_space();
+    if (!space) return NULL;
+
+    if (route == ROUTE_HIERARCHY ||
+        (route == ROUTE_LONG_TRIPS && is_hierarchical_trip(start_x, start_y, goal_x, goal_y) && hpa_ready())) {
+        return plan_hierarchical(space, start_x, start_y, goal_x, goal_y);
+    }
+
+    SearchNode* goal = search(space, start_x, start_y, goal_x, goal_y);
+    if (!goal) {
+        printf("Pathfinding: A* algorithm exhausted all possibilities, no path found from (%d,%d) to (%d,%d)\n",
+               start_x, start_y, goal_x, goal_y);
         return NULL;
     }
 
-    // Allocate temporary node grid
-    Node* nodes = calloc(MAP_WIDTH * MAP_HEIGHT, sizeof(Node));
-    if (!nodes) return NULL;
+    return reconstruct_path(space, goal, goal_x, goal_y);
+}
 
-    // Initialize nodes metadata
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            Node* n = get_node(nodes, x, y);
-            n->x = x;
-            n->y = y;
-            n->g_cost = INT_MAX;
-            n->parent_x = -1;
-            n->parent_y = -1;
+// Rebuilds the route of a plain A* search by following each node's parent
+// step back from the goal. Unlike walk_back(), this does not rely on move
+// costs, which may have changed while a resumable search was paused.
+// Returns NULL and sets *blocked if the route crosses a tile that is no
+// longer walkable; returns NULL on allocation failure.
+static Path* trace_steps(SearchSpace* space, int goal_x, int goal_y, int* blocked) {
+    *blocked = 0;
+    int length = 0;
+    int x = goal_x, y = goal_y;
+    SearchNode* node = search_peek(space, x, y);
+    while (node && node->parent != SEARCH_NO_PARENT) {
+        if (!map_walkable(x, y)) {
+            *blocked = 1;
+            return NULL;
         }
+        x -= search_dirs[node->parent][0];
+        y -= search_dirs[node->parent][1];
+        node = search_peek(space, x, y);
+        length++;
     }
 
-    // Initialize starting node
-    Node* start = get_node(nodes, start_x, start_y);
-    start->g_cost = 0;
-    start->h_cost = heuristic(start_x, start_y, goal_x, goal_y);
-    start->f_cost = start->h_cost;
-    start->in_open = 1;
+    PathNode* nodes = path_scratch(length > 0 ? length : 1);
+    if (!nodes) return NULL;
 
-    // Main A* loop
-    while (1) {
-        Node* current = find_lowest_f(nodes);
-        if (!current) break;
-
-        // Goal reached: reconstruct and return path
-        if (current->x == goal_x && current->y == goal_y) {
-            Path* path = reconstruct_path(nodes, current, start_x, start_y);
-            free(nodes);
-            return path;
+    x = goal_x;
+    y = goal_y;
+    for (int i = length - 1; i >= 0; i--) {
+        node = search_peek(space, x, y);
+        nodes[i] = (PathNode) { x, y };
+        x -= search_dirs[node->parent][0];
+        y -= search_dirs[node->parent][1];
+    }
+    return path_from_nodes(nodes, length);
+}
+
+static void finish_search(PathSearch* search, Path* path) {
+    search->state = PATH_SEARCH_DONE;
+    search->path = path;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+void free_path(Path* path) {
+    if (!path) return;
+    path_pool_free(path->steps);
+    path_pool_free(path->waypoints);
+    path_pool_free(path);
+}
+
+Path* find_path(int start_x, int start_y, int goal_x, int goal_y) {
+    PROFILE_BEGIN("find_path");
+    Path* path = search_path(pick_search(), ROUTE_LONG_TRIPS, start_x, start_y, goal_x, goal_y);
+    PROFILE_END();
+    return path;
+}
+
+int refine_path(Path* path) {
+    if (!path) return 0;
+
+    while (path->current >= path->length) {
+        if (!path->waypoints || path->next_waypoint >= path->waypoint_count) return 0;
+
+        PathNode from = path->waypoints[path->next_waypoint - 1];
+        PathNode to = path->waypoints[path->next_waypoint];
+        PathNode goal = path->waypoints[path->waypoint_count - 1];
+        path->next_waypoint++;
+
+        PROFILE_BEGIN("refine_path");
+        Path* leg = search_path(leg_search, ROUTE_TILES, from.x, from.y, to.x, to.y);
+        PROFILE_END();
+
+        if (!leg) {
+            // The map changed under the plan: start over from here
+            leg = find_path(from.x, from.y, goal.x, goal.y);
+            path_pool_free(path->steps);
+            path_pool_free(path->waypoints);
+            if (!leg) {
+                *path = (Path){ 0 };
+                return 0;
+            }
+            *path = *leg;
+            path_pool_free(leg);
+            continue;
         }
 
-        current->in_open = 0;
-        current->in_closed = 1;
+        // Take over the leg's tiles, keep the waypoints
+        PathNode* waypoints = path->waypoints;
+        int waypoint_count = path->waypoint_count;
+        int next_waypoint = path->next_waypoint;
+        path_pool_free(path->steps);
+        *path = *leg;
+        path->waypoints = waypoints;
+        path->waypoint_count = waypoint_count;
+        path->next_waypoint = next_waypoint;
+        path_pool_free(leg);
+    }
+    return 1;
+}
+
+Path* find_path_astar(int start_x, int start_y, int goal_x, int goal_y) {
+    PROFILE_BEGIN("find_path_astar");
+    Path* path = search_path(astar_search, ROUTE_TILES, start_x, start_y, goal_x, goal_y);
+    PROFILE_END();
+    return path;
+}
+
+Path* find_path_hierarchy(int hierarchy, int start_x, int start_y, int goal_x, int goal_y) {
+    PROFILE_BEGIN("find_path_hierarchy");
+    Path* path = search_path(pick_search(), hierarchy ? ROUTE_HIERARCHY : ROUTE_TILES,
+                             start_x, start_y, goal_x, goal_y);
+    PROFILE_END();
+    return path;
+}
 
-        // Explore 4-directional neighbors
-        static int dirs[4][2] = {
-            {  1,  0 },
-            { -1,  0 },
-            {  0,  1 },
-            {  0, -1 }
-        };
+void path_search_init(PathSearch* search) {
+    memset(search, 0, sizeof(*search));
+}
 
-        for (int i = 0; i < 4; i++) {
-            int nx = current->x + dirs[i][0];
-            int ny = current->y + dirs[i][1];
+void path_search_begin(PathSearch* search, int start_x, int start_y, int goal_x, int goal_y) {
+    free_path(search->path);
+    search->path = NULL;
+    search->state = PATH_SEARCH_RUNNING;
+    search->start_x = start_x;
+    search->start_y = start_y;
+    search->goal_x = goal_x;
+    search->goal_y = goal_y;
+    search->map_serial = nav_map->serial;
+    search->expanded = 0;
+
+    Path* settled;
+    if (settle_trip(start_x, start_y, goal_x, goal_y, &settled)) {
+        finish_search(search, settled);
+        return;
+    }
 
-            if (!is_tile_in_bounds(nx, ny)) continue;
-            if (!is_tile_walkable(nx, ny)) continue;
+    if (!astar_begin(&search->space, start_x, start_y, goal_x, goal_y)) finish_search(search, NULL);
+}
 
-            Node* neighbor = get_node(nodes, nx, ny);
-            if (neighbor->in_closed) continue;
+int path_search_step(PathSearch* search, int max_nodes) {
+    if (search->state != PATH_SEARCH_RUNNING || max_nodes <= 0) return 0;
 
-            int tentative_g = current->g_cost + tile_move_cost(nx, ny);
+    // Another map was loaded: nothing found so far applies
+    if (search->map_serial != nav_map->serial) {
+        path_search_begin(search, search->start_x, search->start_y, search->goal_x, search->goal_y);
+        if (search->state != PATH_SEARCH_RUNNING) return 0;
+    }
 
-            if (tentative_g < neighbor->g_cost) {
-                neighbor->parent_x = current->x;
-                neighbor->parent_y = current->y;
-                neighbor->g_cost = tentative_g;
-                neighbor->h_cost = heuristic(nx, ny, goal_x, goal_y);
-                neighbor->f_cost = neighbor->g_cost + neighbor->h_cost;
-                neighbor->in_open = 1;
+    int start_x = search->start_x, start_y = search->start_y;
+    int goal_x = search->goal_x, goal_y = search->goal_y;
+
+    PROFILE_BEGIN("path_search_step");
+    int spent = 0;
+    while (spent < max_nodes) {
+        int x, y;
+        SearchNode* current = search_pop(&search->space, &x, &y);
+        if (!current) {
+            printf("Pathfinding: A* algorithm exhausted all possibilities, no path found from (%d,%d) to (%d,%d)\n",
+                   start_x, start_y, goal_x, goal_y);
+            finish_search(search, NULL);
+            break;
+        }
+        spent++;
+
+        if (x == goal_x && y == goal_y) {
+            int blocked;
+            Path* path = trace_steps(&search->space, goal_x, goal_y, &blocked);
+            if (blocked) {
+                // Tiles changed between steps and the route crosses a new wall
+                path_search_begin(search, start_x, start_y, goal_x, goal_y);
+                break;
             }
+            finish_search(search, path);
+            break;
+        }
+
+        if (!astar_expand(&search->space, current, x, y, goal_x, goal_y, 0, 0, map_width(), map_height())) {
+            finish_search(search, NULL);
+            break;
         }
     }
+    search->expanded += spent;
+    PROFILE_END();
+    return spent;
+}
 
-    // No path found
-    printf("Pathfinding: A* algorithm exhausted all possibilities, no path found from (%d,%d) to (%d,%d)\n",
-           start_x, start_y, goal_x, goal_y);
-    free(nodes);
-    return NULL;
+Path* path_search_take(PathSearch* search) {
+    Path* path = search->path;
+    search->path = NULL;
+    search->state = PATH_SEARCH_IDLE;
+    return path;
+}
+
+void path_search_free(PathSearch* search) {
+    free_path(search->path);
+    search_space_free(&search->space);
+    path_search_init(search);
+}
+
+void release_path_workspace(void) {
+    release_path_scratch();
+    hpa_release_workspace();
+    if (!thread_space) return;
+    search_space_free(thread_space);
+    free(thread_space);
+    thread_space = NULL;
 }
@@ -8,18 +8,49 @@
 // - It does NOT know about entities, rendering, camera, or input
 // - It returns a Path (sequence of tiles) and nothing more
 //
-// The algorithm implemented here is a straightforward A* over a 2D grid
-// with 4-directional movement and uniform tile cost.
+// The algorithm implemented here is A* over a 2D grid with 4-directional
+// movement and per-tile move costs. find_path() runs it as a jump point
+// search (see jps.h): flat regions are crossed in straight jumps and
+// weighted tiles such as rubble get ordinary A* steps. On maps where
+// weighted tiles are common enough that jumping no longer pays, it runs
+// plain A* instead. Search state lives in a per-thread workspace (see
+// search.h) that is reused by every call on that thread. Searches read the
+// map through nav_map, so path workers (path_jobs.h) can run them on a
+// snapshot.
+//
+// Long trips on maps larger than one chunk go through the hierarchy in
+// hpa.h instead, once its clusters are built: find_path() plans waypoints
+// across chunks and returns a path whose tiles are filled in one leg at a
+// time by refine_path().
+//
+// A PathSearch is a plain A* search spread over several calls: each
+// path_search_step() expands at most a given number of nodes and returns,
+// so callers with a per-tick budget (path_jobs.h) never stall on one long
+// search.
 //
 // Design goals:
 // - Correctness over cleverness
-// - Explicit state (no hidden globals)
+// - No per-call heap allocation (returned Paths come from path_pool.h)
 // - Easy to debug and reason about
 // -----------------------------------------------------------------------------
 
 #ifndef PATHFINDING_H
 #define PATHFINDING_H
 
+#include "navigation/search.h"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+// Shortest trip planned through hpa.h (16 chunks). On walled maps the
+// hierarchy wins or loses against a tile search at 256 tiles depending on
+// the trip, and is 1.5 to 3 times faster from 512 (bench:
+// find_path_hierarchy).
+#define PATH_HIERARCHY_DISTANCE 512
+
 // -----------------------------------------------------------------------------
 // Types
 // -----------------------------------------------------------------------------
@@ -35,30 +66,84 @@ typedef struct {
 
 // Represents a complete path from start to goal.
 //
-// The path is stored as an array of PathNode structures, ordered from
-// start to goal. The path includes the starting position to ensure proper
-// movement handling when the entity is already at the start tile.
+// The path is a sequence of tile coordinates, ordered from start to goal,
+// read with path_node() (see path_pool.h). Paths from find_path() leave
+// out the tile the search started on; others (e.g. a trip that is already
+// at its goal) may include it.
 //
 // Fields:
-//   nodes: Array of tile coordinates forming the path (start -> goal)
-//   length: Number of nodes in the path
+//   steps: Tile storage from the path pool: PathNode[length], or if
+//          compact, one 2-bit move (search_dirs index) per tile after the
+//          first, four to a byte
+//   length: Number of tiles in the path
 //   current: Current position in the path (for step-by-step movement)
+//   compact: Whether steps holds moves rather than PathNodes
+//   first: Compact paths only: the first tile
+//   cursor: Compact paths only: index of cursor_node, the last tile
+//           path_node() decoded
+//   cursor_node: Compact paths only: tile at cursor
+//   waypoints: Hierarchical paths only: waypoints from start to goal;
+//              steps holds the tiles of the leg ending at
+//              waypoints[next_waypoint - 1] (NULL for ordinary paths)
+//   waypoint_count: Number of waypoints
+//   next_waypoint: Next waypoint whose leg refine_path() will fill in
 //
 // Ownership:
-// - Paths are allocated by find_path() using malloc()
+// - Paths and everything they own come from the path pool (path_pool.h)
 // - The caller is responsible for freeing the path with free_path()
-// - Paths must be freed to avoid memory leaks
+// - Paths must be freed to return their storage to the pool
 //
 // Usage:
 // - Assign a path to an entity's path field for movement
-// - The movement system advances path->current as the entity moves
-// - When path->current >= path->length, the path is complete
+// - The movement system advances path->current as the entity moves and
+//   calls refine_path() when it reaches the end of the tiles
+// - When path->current >= path->length after refine_path(), the path is
+//   complete
 typedef struct {
-    PathNode* nodes;
+    void* steps;
     int length;
     int current;
+
+    int compact;
+    PathNode first;
+    int cursor;
+    PathNode cursor_node;
+
+    PathNode* waypoints;
+    int waypoint_count;
+    int next_waypoint;
 } Path;
 
+typedef enum {
+    PATH_SEARCH_IDLE,       // Not begun, or its result was taken
+    PATH_SEARCH_RUNNING,    // Begun; call path_search_step() again
+    PATH_SEARCH_DONE        // Finished; path holds the result (NULL if none)
+} PathSearchState;
+
+// A search that can be stopped after any node and continued later.
+//
+// Each one owns its workspace, so any number can be in progress at once
+// (on one thread). The tiles are searched with plain A*, not jump point
+// search: one jump can scan a whole row, so only plain A* makes every
+// expansion cost about the same and a node budget mean the same on every
+// map. Long trips are searched the same way rather than through the chunk
+// hierarchy: an abstract search, and the cluster builds it triggers, cannot
+// be stopped part way, so a budget would not bound it.
+//
+// The map is read live between steps. Tiles that become walls only matter
+// if they are already behind the search; a finished route crossing one is
+// searched again. Cost changes behind the search can leave the route
+// slightly more expensive than optimal. Loading another map restarts it.
+typedef struct {
+    SearchSpace space;
+    PathSearchState state;
+    int start_x, start_y;
+    int goal_x, goal_y;
+    uint32_t map_serial;    // Map the search began on
+    int expanded;           // Nodes expanded since the search (re)started
+    Path* path;             // Result once state is PATH_SEARCH_DONE
+} PathSearch;
+
 // -----------------------------------------------------------------------------
 // Public API
 // -----------------------------------------------------------------------------
@@ -66,18 +151,21 @@ typedef struct {
 // Attempts to find a path from (start_x, start_y) to (goal_x, goal_y) using A*.
 //
 // This function performs a complete A* search over the grid to find an optimal
-// path from the start position to the goal. The algorithm uses:
+// path from the start position to the goal, jumping across flat tiles (jump
+// point search) and stepping tile by tile through weighted ones. The
+// algorithm uses:
 // - Manhattan distance heuristic (appropriate for 4-directional movement)
-// - Uniform tile cost (1 per tile)
+// - Per-tile move cost from the cost plane (1 on flat tiles)
 // - 4-directional movement only (cardinal directions, no diagonals)
 //
 // Algorithm overview:
-// 1. Initialize all nodes with g_cost = INT_MAX (unvisited)
-// 2. Start with initial position at g_cost = 0, calculate heuristic
-// 3. Repeatedly select the open node with lowest f_cost (g + h)
-// 4. Explore its 4 neighbors, updating costs if a better path is found
-// 5. When goal is reached, reconstruct path by walking backward through parents
-// 6. Reverse path so it's ordered start -> goal
+// 1. Start a new search generation (every node reads as unvisited)
+// 2. Open the start position at g = 0
+// 3. Repeatedly pop the open node with lowest f (g + h, ties on lower h)
+// 4. Jump from it to the next jump points in each useful direction (or step
+//    to weighted neighbours), updating costs if a better path is found
+// 5. When goal is reached, reconstruct path by walking backward through
+//    parents, filling in the tiles each jump skipped
 //
 // Args:
 //   start_x: Starting tile X coordinate
@@ -87,36 +175,65 @@ typedef struct {
 //
 // Returns:
 //   A newly allocated Path on success, containing the sequence of tiles
-//   from start to goal (including the start tile). The caller is responsible
-//   for freeing this path with free_path().
+//   after the start up to and including the goal (the start tile is left
+//   out). If start equals goal, the path is that one tile. The caller is
+//   responsible for freeing this path with free_path().
 //
 //   NULL if:
 //   - No valid path exists (blocked by obstacles)
 //   - Start or goal tile is not walkable
-//   - Start equals goal (returns a single-node path that will be cleaned up)
 //
 // Performance:
-// - Time complexity: O(n) where n is the number of reachable tiles
-// - Uses linear scan for finding lowest f_cost node (O(n) per iteration)
-// - For large maps, consider upgrading to a priority queue/heap
+// - O(k log k) where k is the number of jump points and weighted tiles
+//   visited (indexed binary heap); jumps scan rows 64 tiles per word
+// - Nothing is cleared per call; node state is invalidated by a generation
+//   counter
+// - No heap allocation once the workspace and path pool have warmed up
+//   (workspace pages are allocated the first time a chunk is searched);
+//   the returned Path comes from the path pool
+// - Falls back to plain A* (as find_path_astar()) when more than 1 tile in
+//   32 is weighted
+// - Trips of PATH_HIERARCHY_DISTANCE tiles or more (Manhattan) between
+//   different chunks search the chunk hierarchy (see hpa.h) once
+//   hpa_ready(), and refine only the first leg; such paths may be slightly
+//   longer than optimal
 //
 // This function performs NO movement. It only plans a route.
 // The resulting path must be assigned to an entity and processed by the
 // movement system for actual movement to occur.
 Path* find_path(int start_x, int start_y, int goal_x, int goal_y);
 
-// Frees a Path allocated by find_path().
+// Fills in the next leg of a hierarchical path once every tile of the
+// current leg has been walked (path->current >= path->length). Replaces
+// path->steps with the new leg and resets path->current to 0. If the leg
+// can no longer be walked (the map changed), plans again from the last
+// waypoint reached to the goal.
 //
-// This function deallocates both the Path structure and its internal nodes
-// array. It is safe to call with NULL (no-op).
+// Returns 1 if path has tiles left to walk, 0 once it is complete. Safe to
+// call on ordinary paths and on NULL.
+int refine_path(Path* path);
+
+// Same as find_path(), but expands every tile as a plain A* node.
+//
+// Returns paths of the same cost as find_path(). Kept as the reference
+// implementation for debugging and benchmarks.
+Path* find_path_astar(int start_x, int start_y, int goal_x, int goal_y);
+
+// Same as find_path(), but plans every trip through the chunk hierarchy
+// (hierarchy = 1, building any cluster it lacks) or none (0), whatever its
+// length. For benchmarks that place PATH_HIERARCHY_DISTANCE.
+Path* find_path_hierarchy(int hierarchy, int start_x, int start_y, int goal_x, int goal_y);
+
+// Frees a Path from find_path() or any other path builder.
+//
+// This function returns the Path, its tiles and its waypoints to the path
+// pool. It is safe to call with NULL (no-op).
 //
 // Args:
 //   path: Path to free, or NULL
 //
 // Ownership rule:
-// - Paths are allocated by find_path() using malloc()
 // - The caller is responsible for freeing the path when done
-// - Failure to call free_path() will result in memory leaks
 // - After calling free_path(), the path pointer becomes invalid
 //
 // Should be called when:
@@ -125,4 +242,32 @@ Path* find_path(int start_x, int start_y, int goal_x, int goal_y);
 // - The entity is destroyed or no longer needs the path
 void free_path(Path* path);
 
+// Prepares an idle search (no allocation until it begins). A zeroed
+// PathSearch is also idle.
+void path_search_init(PathSearch* search);
+
+// Begins a search from (start_x, start_y) to (goal_x, goal_y), dropping any
+// search or result search held. Trips that need no search (start == goal,
+// unwalkable ends, different regions) are done at once, with the same
+// results as find_path(). Others find paths of the same cost as
+// find_path_astar(), at any distance.
+void path_search_begin(PathSearch* search, int start_x, int start_y, int goal_x, int goal_y);
+
+// Expands at most max_nodes nodes of a running search. Returns the number
+// expanded; search->state is PATH_SEARCH_DONE once it has finished.
+int path_search_step(PathSearch* search, int max_nodes);
+
+// Returns the result of a finished search (NULL if no path was found) and
+// makes the search idle. The caller frees the path with free_path().
+Path* path_search_take(PathSearch* search);
+
+// Frees a search's workspace and result.
+void path_search_free(PathSearch* search);
+
+// Frees the calling thread's search workspace and path scratch buffer.
+//
+// Threads that call find_path() should call this before they exit. A later
+// find_path() on the same thread simply builds a new workspace.
+void release_path_workspace(void);
+
 #endif  // PATHFINDING_H
@@ -0,0 +1,223 @@
+// Implementation file for regions.h
+// See regions.h for detailed documentation.
+
+#include "navigation/regions.h"
+#include "core/map.h"
+
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+// Local piece of every tile, chunk-major:
+//   tile_pieces[chunk * MAP_CHUNK_TILES + local_y * MAP_CHUNK_SIZE + local_x]
+// 0 = unwalkable, else 1..chunk_pieces[chunk]
+static uint16_t* tile_pieces = NULL;
+static uint16_t* chunk_pieces = NULL;
+static int* chunk_base = NULL;          // Index of each chunk's first piece in piece_region
+static int chunk_count = 0;
+
+// Union-find over every piece, flattened after each update so that
+// piece_region[i] is the root of piece i
+static int* piece_region = NULL;
+static int piece_capacity = 0;
+
+static int built = 0;
+static uint32_t built_serial = 0;
+static uint32_t built_revision = 0;
+
+// Flood fill stack, one entry per tile of a chunk
+static int fill_stack[MAP_CHUNK_TILES];
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+static int ensure_tables(void) {
+    if (built && built_serial == world_map.serial &&
+        chunk_count == world_map.chunks_x * world_map.chunks_y) {
+        return 1;
+    }
+
+    regions_reset();
+    chunk_count = world_map.chunks_x * world_map.chunks_y;
+    tile_pieces = malloc((size_t)chunk_count * MAP_CHUNK_TILES * sizeof(uint16_t));
+    chunk_pieces = calloc(chunk_count, sizeof(uint16_t));
+    chunk_base = malloc((size_t)chunk_count * sizeof(int));
+    if (!tile_pieces || !chunk_pieces || !chunk_base) {
+        regions_reset();
+        return 0;
+    }
+    return 1;
+}
+
+// Numbers the 4-connected pieces of walkable tiles inside chunk (cx, cy).
+static void fill_chunk(int cx, int cy) {
+    int chunk = cy * world_map.chunks_x + cx;
+    uint16_t* pieces = &tile_pieces[(size_t)chunk * MAP_CHUNK_TILES];
+    int x0 = cx << MAP_CHUNK_SHIFT;
+    int y0 = cy << MAP_CHUNK_SHIFT;
+    int w = world_map.width - x0 < MAP_CHUNK_SIZE ? world_map.width - x0 : MAP_CHUNK_SIZE;
+    int h = world_map.height - y0 < MAP_CHUNK_SIZE ? world_map.height - y0 : MAP_CHUNK_SIZE;
+
+    // Walkable tiles start at UINT16_MAX ("not yet numbered"), padding at 0
+    for (int ly = 0; ly < MAP_CHUNK_SIZE; ly++) {
+        for (int lx = 0; lx < MAP_CHUNK_SIZE; lx++) {
+            int open = lx < w && ly < h && map_walkable(x0 + lx, y0 + ly);
+            pieces[(ly << MAP_CHUNK_SHIFT) | lx] = open ? UINT16_MAX : 0;
+        }
+    }
+
+    uint16_t count = 0;
+    for (int seed = 0; seed < MAP_CHUNK_TILES; seed++) {
+        if (pieces[seed] != UINT16_MAX) continue;
+
+        pieces[seed] = ++count;
+        int top = 0;
+        fill_stack[top++] = seed;
+        while (top > 0) {
+            int local = fill_stack[--top];
+            int lx = local & MAP_CHUNK_MASK;
+            int ly = local >> MAP_CHUNK_SHIFT;
+            int next[4] = {
+                lx + 1 < MAP_CHUNK_SIZE ? local + 1 : -1,
+                lx > 0 ? local - 1 : -1,
+                ly + 1 < MAP_CHUNK_SIZE ? local + MAP_CHUNK_SIZE : -1,
+                ly > 0 ? local - MAP_CHUNK_SIZE : -1
+            };
+            for (int i = 0; i < 4; i++) {
+                if (next[i] < 0 || pieces[next[i]] != UINT16_MAX) continue;
+                pieces[next[i]] = count;
+                fill_stack[top++] = next[i];
+            }
+        }
+    }
+    chunk_pieces[chunk] = count;
+}
+
+static int find_root(int piece) {
+    while (piece_region[piece] != piece) {
+        piece_region[piece] = piece_region[piece_region[piece]];
+        piece = piece_region[piece];
+    }
+    return piece;
+}
+
+static void join(int a, int b) {
+    a = find_root(a);
+    b = find_root(b);
+    if (a < b) piece_region[b] = a;
+    else if (b < a) piece_region[a] = b;
+}
+
+// Joins the pieces of chunk (cx, cy) with those of the chunk east (dir 0)
+// or south (dir 1) of it. Tiles along a border that are walkable on both
+// sides in an unbroken run belong to the same piece on each side, so only
+// the first pair of each run needs joining.
+static void join_border(int cx, int cy, int dir) {
+    int ncx = cx + (dir == 0), ncy = cy + (dir == 1);
+    if (ncx >= world_map.chunks_x || ncy >= world_map.chunks_y) return;
+
+    int chunk = cy * world_map.chunks_x + cx;
+    int neighbour = ncy * world_map.chunks_x + ncx;
+    const uint16_t* near = &tile_pieces[(size_t)chunk * MAP_CHUNK_TILES];
+    const uint16_t* far = &tile_pieces[(size_t)neighbour * MAP_CHUNK_TILES];
+
+    int in_run = 0;
+    for (int i = 0; i < MAP_CHUNK_SIZE; i++) {
+        // East: last column against first column; south: last row against first row
+        int a = dir == 0 ? (i << MAP_CHUNK_SHIFT) | MAP_CHUNK_MASK : (MAP_CHUNK_MASK << MAP_CHUNK_SHIFT) | i;
+        int b = dir == 0 ? (i << MAP_CHUNK_SHIFT) : i;
+        int open = near[a] && far[b];
+        if (open && !in_run) {
+            join(chunk_base[chunk] + near[a] - 1, chunk_base[neighbour] + far[b] - 1);
+        }
+        in_run = open;
+    }
+}
+
+// Brings the labels up to date with world_map. Returns 0 on allocation
+// failure.
+static int update_regions(void) {
+    if (world_map.width == 0 || world_map.height == 0) return 0;
+    if (!ensure_tables()) return 0;
+    if (built && built_revision == world_map.revision) return 1;
+
+    for (int cy = 0; cy < world_map.chunks_y; cy++) {
+        for (int cx = 0; cx < world_map.chunks_x; cx++) {
+            int chunk = cy * world_map.chunks_x + cx;
+            if (!built || world_map.chunk_revisions[chunk] > built_revision) fill_chunk(cx, cy);
+        }
+    }
+
+    int total = 0;
+    for (int chunk = 0; chunk < chunk_count; chunk++) {
+        chunk_base[chunk] = total;
+        total += chunk_pieces[chunk];
+    }
+    if (total > piece_capacity) {
+        int* grown = realloc(piece_region, sizeof(int) * total);
+        if (!grown) {
+            built = 0;
+            return 0;
+        }
+        piece_region = grown;
+        piece_capacity = total;
+    }
+
+    for (int i = 0; i < total; i++) piece_region[i] = i;
+    for (int cy = 0; cy < world_map.chunks_y; cy++) {
+        for (int cx = 0; cx < world_map.chunks_x; cx++) {
+            join_border(cx, cy, 0);
+            join_border(cx, cy, 1);
+        }
+    }
+    for (int i = 0; i < total; i++) piece_region[i] = find_root(piece_region[i]);
+
+    built = 1;
+    built_serial = world_map.serial;
+    built_revision = world_map.revision;
+    return 1;
+}
+
+// Region of (x, y); labels must be up to date and (x, y) in bounds.
+static uint32_t lookup(int x, int y) {
+    int chunk = (y >> MAP_CHUNK_SHIFT) * world_map.chunks_x + (x >> MAP_CHUNK_SHIFT);
+    uint16_t piece = tile_pieces[(size_t)chunk * MAP_CHUNK_TILES + (((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK))];
+    if (piece == 0) return REGION_NONE;
+    return (uint32_t)piece_region[chunk_base[chunk] + piece - 1] + 1;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+uint32_t region_of(int x, int y) {
+    if (x < 0 || y < 0 || x >= world_map.width || y >= world_map.height) return REGION_NONE;
+    if (!update_regions()) return REGION_NONE;
+    return lookup(x, y);
+}
+
+int regions_connected(int ax, int ay, int bx, int by) {
+    if (ax < 0 || ay < 0 || ax >= world_map.width || ay >= world_map.height) return 0;
+    if (bx < 0 || by < 0 || bx >= world_map.width || by >= world_map.height) return 0;
+    if (!update_regions()) return 1;
+
+    uint32_t region = lookup(ax, ay);
+    return region != REGION_NONE && region == lookup(bx, by);
+}
+
+void regions_reset(void) {
+    free(tile_pieces);
+    free(chunk_pieces);
+    free(chunk_base);
+    free(piece_region);
+    tile_pieces = NULL;
+    chunk_pieces = NULL;
+    chunk_base = NULL;
+    piece_region = NULL;
+    chunk_count = 0;
+    piece_capacity = 0;
+    built = 0;
+}
@@ -0,0 +1,67 @@
+// -----------------------------------------------------------------------------
+// regions.h
+//
+// Connected regions of walkable tiles.
+// This module handles:
+//
+// - Labelling every walkable tile with the region (4-connected component)
+//   it belongs to, so "can (a) reach (b) at all?" is two lookups
+// - Keeping the labels up to date as tiles change, redoing only the chunks
+//   whose world_map.chunk_revisions moved
+//
+// Labels are kept in two levels:
+//
+// - Per chunk: a flood fill inside the chunk numbers its local pieces
+//   1..n (0 for unwalkable tiles)
+// - Per map: a union-find over every chunk's pieces, joined wherever a
+//   walkable tile pair crosses a chunk border, then flattened so each
+//   piece maps straight to its region
+//
+// After an edit, the next query refills the changed chunks and redoes the
+// union-find, which visits each border run once rather than each tile.
+//
+// find_path() and request_path() use regions_connected() to turn down
+// goals in another region before any search starts, instead of exhausting
+// everything reachable from the start.
+//
+// Memory: 2 bytes per tile plus a few bytes per piece.
+//
+// Threading: regions describe world_map and belong to the thread that owns
+// it (the simulation thread); pathfinding workers do not use them.
+//
+// Design goals:
+// - O(1) rejection of unreachable goals
+// - Tile edits cost a refill of one chunk, not of the map
+// -----------------------------------------------------------------------------
+
+#ifndef REGIONS_H
+#define REGIONS_H
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define REGION_NONE 0   // Region of unwalkable and out-of-bounds tiles
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Returns the region of (x, y), or REGION_NONE if it is out of bounds,
+// unwalkable, or the labels could not be allocated. Two walkable tiles have
+// the same region exactly when a path joins them. Region numbers change
+// whenever the map does, so only compare values read without an edit in
+// between.
+uint32_t region_of(int x, int y);
+
+// Returns 1 if a path exists from (ax, ay) to (bx, by), 0 otherwise
+// (including when either tile is out of bounds or unwalkable). Also returns
+// 1 if the labels could not be allocated, so callers fall back to searching.
+int regions_connected(int ax, int ay, int bx, int by);
+
+// Frees the labels. They are rebuilt on demand by the next query.
+void regions_reset(void);
+
+#endif  // REGIONS_H
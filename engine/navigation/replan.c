@@ -0,0 +1,416 @@
+// Implementation file for replan.h
+// See replan.h for detailed documentation.
+
+#include "navigation/replan.h"
+#include "navigation/search.h"
+#include "navigation/regions.h"
+#include "navigation/path_pool.h"
+#include "core/map.h"
+
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types and Constants
+// -----------------------------------------------------------------------------
+
+#define REPLAN_TILES    (REPLAN_SIDE * REPLAN_SIDE)
+#define REPLAN_INF      (1 << 29)       // Unreached; sums of two stay below INT32_MAX
+#define REPLAN_NO_OWNER -1
+
+// Priority of a node: (min(g, rhs) + h + km, min(g, rhs)), compared in order
+typedef struct {
+    int32_t k1, k2;
+} ReplanKey;
+
+typedef struct {
+    int node;
+    ReplanKey key;
+} ReplanEntry;
+
+// One pursuer's search. Nodes are tiles of the square around the root:
+// node = (y - y0) * REPLAN_SIDE + (x - x0).
+typedef struct {
+    int owner;
+    uint64_t last_used;
+    uint32_t serial, revision;          // world_map when costs were last synced
+    int x0, y0;
+    int root;
+    int goal;
+    int32_t km;                         // Sum of heuristic distances the goal moved
+
+    int32_t* g;
+    int32_t* rhs;
+    int32_t* heap_pos;                  // Index in heap, -1 if not open
+    uint8_t* cost;                      // Copy of the move cost plane (0 = blocked)
+
+    ReplanEntry* heap;
+    int heap_count;
+} Planner;
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+static Planner planners[REPLAN_SLOTS];
+static int planners_ready = 0;
+static uint64_t use_clock = 0;
+static int last_expansions = 0;
+
+static int route[REPLAN_TILES];         // Goal -> root, filled by trace_route()
+
+// -----------------------------------------------------------------------------
+// Internal Helpers: Priority Queue
+// -----------------------------------------------------------------------------
+
+static inline int key_less(ReplanKey a, ReplanKey b) {
+    return a.k1 < b.k1 || (a.k1 == b.k1 && a.k2 < b.k2);
+}
+
+static void heap_place(Planner* p, int i, ReplanEntry entry) {
+    p->heap[i] = entry;
+    p->heap_pos[entry.node] = i;
+}
+
+static void heap_sift(Planner* p, int i) {
+    ReplanEntry entry = p->heap[i];
+
+    while (i > 0 && key_less(entry.key, p->heap[(i - 1) / 2].key)) {
+        heap_place(p, i, p->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= p->heap_count) break;
+        if (child + 1 < p->heap_count && key_less(p->heap[child + 1].key, p->heap[child].key)) child++;
+        if (!key_less(p->heap[child].key, entry.key)) break;
+        heap_place(p, i, p->heap[child]);
+        i = child;
+    }
+    heap_place(p, i, entry);
+}
+
+// Inserts node, or moves it to key if it is already open.
+static void heap_set(Planner* p, int node, ReplanKey key) {
+    int i = p->heap_pos[node];
+    if (i < 0) i = p->heap_count++;
+    p->heap[i] = (ReplanEntry){ node, key };
+    heap_sift(p, i);
+}
+
+static void heap_remove(Planner* p, int node) {
+    int i = p->heap_pos[node];
+    if (i < 0) return;
+    p->heap_pos[node] = -1;
+
+    ReplanEntry last = p->heap[--p->heap_count];
+    if (i < p->heap_count) {
+        p->heap[i] = last;
+        heap_sift(p, i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Internal Helpers: Search
+// -----------------------------------------------------------------------------
+
+static inline int node_x(const Planner* p, int node) { return p->x0 + node % REPLAN_SIDE; }
+static inline int node_y(const Planner* p, int node) { return p->y0 + node / REPLAN_SIDE; }
+
+// Node of (x, y), or -1 outside the square.
+static inline int node_at(const Planner* p, int x, int y) {
+    int lx = x - p->x0, ly = y - p->y0;
+    if (lx < 0 || ly < 0 || lx >= REPLAN_SIDE || ly >= REPLAN_SIDE) return -1;
+    return ly * REPLAN_SIDE + lx;
+}
+
+// Neighbour of node in direction dir (search_dirs), or -1 outside the square.
+static inline int neighbour(const Planner* p, int node, int dir) {
+    return node_at(p, node_x(p, node) + search_dirs[dir][0], node_y(p, node) + search_dirs[dir][1]);
+}
+
+static int heuristic(const Planner* p, int a, int b) {
+    return abs(node_x(p, a) - node_x(p, b)) + abs(node_y(p, a) - node_y(p, b));
+}
+
+static ReplanKey calc_key(const Planner* p, int node) {
+    int32_t best = p->g[node] < p->rhs[node] ? p->g[node] : p->rhs[node];
+    return (ReplanKey){ best + heuristic(p, node, p->goal) + p->km, best };
+}
+
+static uint8_t tile_cost(int x, int y) {
+    if (!map_in_bounds(x, y) || !map_walkable(x, y)) return 0;
+    return (uint8_t)map_move_cost(x, y);
+}
+
+// Entering a tile costs its move cost, so rhs is the cheapest neighbour's
+// g plus the node's own cost.
+static void update_vertex(Planner* p, int node) {
+    if (node != p->root) {
+        int32_t best = REPLAN_INF;
+        if (p->cost[node]) {
+            for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+                int pred = neighbour(p, node, dir);
+                if (pred >= 0 && p->g[pred] < best) best = p->g[pred];
+            }
+            if (best < REPLAN_INF) best += p->cost[node];
+        }
+        p->rhs[node] = best;
+    }
+
+    if (p->g[node] != p->rhs[node]) {
+        heap_set(p, node, calc_key(p, node));
+    } else {
+        heap_remove(p, node);
+    }
+}
+
+static void compute_path(Planner* p) {
+    while (p->heap_count > 0) {
+        ReplanKey goal_key = calc_key(p, p->goal);
+        ReplanEntry top = p->heap[0];
+        if (!key_less(top.key, goal_key) && p->rhs[p->goal] == p->g[p->goal]) break;
+
+        int node = top.node;
+        ReplanKey key = calc_key(p, node);
+        if (key_less(top.key, key)) {
+            heap_set(p, node, key);         // Key went stale as the goal moved
+            continue;
+        }
+
+        last_expansions++;
+        heap_remove(p, node);
+        if (p->g[node] > p->rhs[node]) {
+            p->g[node] = p->rhs[node];
+        } else {
+            p->g[node] = REPLAN_INF;
+            update_vertex(p, node);
+        }
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int next = neighbour(p, node, dir);
+            if (next >= 0) update_vertex(p, next);
+        }
+    }
+}
+
+// Starts a fresh search rooted at (x, y) towards (goal_x, goal_y). Returns
+// 0 if the goal lies outside the new square.
+static int reset_planner(Planner* p, int x, int y, int goal_x, int goal_y) {
+    p->x0 = x - REPLAN_RADIUS;
+    p->y0 = y - REPLAN_RADIUS;
+    p->serial = world_map.serial;
+    p->revision = world_map.revision;
+    p->km = 0;
+    p->heap_count = 0;
+
+    for (int node = 0; node < REPLAN_TILES; node++) {
+        p->g[node] = REPLAN_INF;
+        p->rhs[node] = REPLAN_INF;
+        p->heap_pos[node] = -1;
+        p->cost[node] = tile_cost(node_x(p, node), node_y(p, node));
+    }
+
+    p->root = node_at(p, x, y);
+    p->goal = node_at(p, goal_x, goal_y);
+    if (p->goal < 0) {
+        p->serial = 0;      // Not a search; the next call starts over
+        return 0;
+    }
+    p->rhs[p->root] = 0;
+    heap_set(p, p->root, calc_key(p, p->root));
+    return 1;
+}
+
+// Brings the cost copy up to date, updating only tiles whose cost changed.
+static void sync_costs(Planner* p) {
+    if (p->revision == world_map.revision) return;
+
+    int cx0 = (p->x0 < 0 ? 0 : p->x0) >> MAP_CHUNK_SHIFT;
+    int cy0 = (p->y0 < 0 ? 0 : p->y0) >> MAP_CHUNK_SHIFT;
+    int cx1 = (p->x0 + REPLAN_SIDE - 1) >> MAP_CHUNK_SHIFT;
+    int cy1 = (p->y0 + REPLAN_SIDE - 1) >> MAP_CHUNK_SHIFT;
+    if (cx1 >= world_map.chunks_x) cx1 = world_map.chunks_x - 1;
+    if (cy1 >= world_map.chunks_y) cy1 = world_map.chunks_y - 1;
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            int x0 = cx << MAP_CHUNK_SHIFT;
+            int y0 = cy << MAP_CHUNK_SHIFT;
+            if (!map_chunks_changed_since(x0, y0, x0 + MAP_CHUNK_MASK, y0 + MAP_CHUNK_MASK, p->revision)) continue;
+
+            for (int y = y0; y < y0 + MAP_CHUNK_SIZE; y++) {
+                for (int x = x0; x < x0 + MAP_CHUNK_SIZE; x++) {
+                    int node = node_at(p, x, y);
+                    if (node < 0) continue;
+
+                    uint8_t cost = tile_cost(x, y);
+                    if (cost == p->cost[node]) continue;
+                    p->cost[node] = cost;
+                    update_vertex(p, node);
+                }
+            }
+        }
+    }
+    p->revision = world_map.revision;
+}
+
+// Fills route with the cheapest path from the goal back to the root and
+// returns its length (goal first, root last), or 0 if the goal is unreached.
+static int trace_route(const Planner* p) {
+    if (p->g[p->goal] >= REPLAN_INF) return 0;
+
+    int length = 0;
+    int node = p->goal;
+    route[length++] = node;
+    while (node != p->root && length < REPLAN_TILES) {
+        int best = -1;
+        for (int dir = 0; dir < SEARCH_DIRS; dir++) {
+            int pred = neighbour(p, node, dir);
+            if (pred >= 0 && p->g[pred] + p->cost[node] == p->g[node]) {
+                best = pred;
+                break;
+            }
+        }
+        if (best < 0) return 0;
+        node = best;
+        route[length++] = node;
+    }
+    return node == p->root ? length : 0;
+}
+
+static int alloc_planner(Planner* p) {
+    p->g = malloc(sizeof(int32_t) * REPLAN_TILES);
+    p->rhs = malloc(sizeof(int32_t) * REPLAN_TILES);
+    p->heap_pos = malloc(sizeof(int32_t) * REPLAN_TILES);
+    p->cost = malloc(REPLAN_TILES);
+    p->heap = malloc(sizeof(ReplanEntry) * REPLAN_TILES);
+    return p->g && p->rhs && p->heap_pos && p->cost && p->heap;
+}
+
+static void free_planner(Planner* p) {
+    free(p->g);
+    free(p->rhs);
+    free(p->heap_pos);
+    free(p->cost);
+    free(p->heap);
+    *p = (Planner){ 0 };
+    p->owner = REPLAN_NO_OWNER;
+}
+
+static void ensure_planners(void) {
+    if (planners_ready) return;
+    for (int i = 0; i < REPLAN_SLOTS; i++) {
+        planners[i] = (Planner){ 0 };
+        planners[i].owner = REPLAN_NO_OWNER;
+    }
+    planners_ready = 1;
+}
+
+static Planner* find_planner(int owner) {
+    ensure_planners();
+    for (int i = 0; i < REPLAN_SLOTS; i++) {
+        if (planners[i].owner == owner && owner != REPLAN_NO_OWNER) return &planners[i];
+    }
+    return NULL;
+}
+
+// Owner's planner, or a free (else least recently used) slot handed to it.
+// *fresh is set when the slot holds no search for owner yet.
+static Planner* claim_planner(int owner, int* fresh) {
+    Planner* p = find_planner(owner);
+    *fresh = p == NULL;
+    if (p) return p;
+
+    p = &planners[0];
+    for (int i = 1; i < REPLAN_SLOTS && p->owner != REPLAN_NO_OWNER; i++) {
+        if (planners[i].owner == REPLAN_NO_OWNER || planners[i].last_used < p->last_used) p = &planners[i];
+    }
+    if (!p->g && !alloc_planner(p)) {
+        free_planner(p);
+        return NULL;
+    }
+    p->owner = owner;
+    return p;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+Path* replan_path(int owner, int start_x, int start_y, int goal_x, int goal_y, int max_steps) {
+    last_expansions = 0;
+    if (start_x == goal_x && start_y == goal_y) return NULL;
+    if (!regions_connected(start_x, start_y, goal_x, goal_y)) return NULL;
+
+    int fresh;
+    Planner* p = claim_planner(owner, &fresh);
+    if (!p) return NULL;
+    p->last_used = ++use_clock;
+
+    int start = node_at(p, start_x, start_y);
+    int goal = node_at(p, goal_x, goal_y);
+    if (fresh || p->serial != world_map.serial || start < 0 || goal < 0) {
+        if (!reset_planner(p, start_x, start_y, goal_x, goal_y)) return NULL;   // Goal too far
+        fresh = 1;
+    } else {
+        sync_costs(p);
+
+        // Keys computed for the old goal stay lower bounds once raised by
+        // the distance it moved (the heuristic is consistent)
+        if (goal != p->goal) {
+            p->km += heuristic(p, p->goal, goal);
+            p->goal = goal;
+        }
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        compute_path(p);
+
+        int length = trace_route(p);
+        start = node_at(p, start_x, start_y);
+        int at = -1;
+        for (int i = 0; i < length; i++) {
+            if (route[i] == start) {
+                at = i;
+                break;
+            }
+        }
+
+        if (at > 0) {
+            // route runs goal -> root; the path is route[at - 1] down to route[0]
+            int steps = at < max_steps ? at : max_steps;
+            PathNode* nodes = path_scratch(steps);
+            if (!nodes) return NULL;
+            for (int i = 0; i < steps; i++) {
+                int node = route[at - 1 - i];
+                nodes[i] = (PathNode){ node_x(p, node), node_y(p, node) };
+            }
+            return path_from_nodes(nodes, steps);
+        }
+        if (length == 0 && fresh) return NULL;     // No path inside the square
+
+        // The route no longer passes the pursuer: start over from it
+        if (!reset_planner(p, start_x, start_y, goal_x, goal_y)) return NULL;
+        fresh = 1;
+    }
+    return NULL;
+}
+
+int replan_active(int owner) {
+    return find_planner(owner) != NULL;
+}
+
+void replan_release(int owner) {
+    Planner* p = find_planner(owner);
+    if (p) p->owner = REPLAN_NO_OWNER;
+}
+
+int replan_last_expansions(void) {
+    return last_expansions;
+}
+
+void replan_reset(void) {
+    ensure_planners();
+    for (int i = 0; i < REPLAN_SLOTS; i++) {
+        free_planner(&planners[i]);
+    }
+}
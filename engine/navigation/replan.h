@@ -0,0 +1,76 @@
+// -----------------------------------------------------------------------------
+// replan.h
+//
+// Incremental replanning for pursuers of a moving goal (LPA* / MT-D* Lite).
+// This module handles:
+//
+// - One persistent search per pursuer (an owner id, e.g. an entity index),
+//   rooted where the pursuer stood when the search began and confined to
+//   the square of REPLAN_RADIUS tiles around that root
+// - Repairing that search when the goal moves: g values from the root do
+//   not depend on the goal, so only the priority keys change, and they
+//   are kept valid lazily by a key offset (km) instead of re-sorting
+// - Repairing it when tiles change: only tiles whose move cost differs from
+//   the planner's copy (found through world_map.chunk_revisions) are
+//   updated, and the change spreads only as far as costs actually change
+//
+// A pursuer that has walked the planned route stands on the shortest path
+// from the root, and the rest of that path is a shortest path from where
+// it stands. When a repaired path no longer passes the pursuer's tile (or
+// it has left the square), the search starts over from there.
+//
+// Usage:
+//
+//   Path* path = replan_path(owner, self->x, self->y, goal_x, goal_y, 4);
+//
+// Up to REPLAN_SLOTS pursuers keep a search at once; the least recently
+// used one is dropped when another owner needs a slot.
+//
+// Threading: simulation thread only (reads world_map).
+//
+// Design goals:
+// - Replanning cost proportional to how much the goal and map changed,
+//   not to path length
+// - No allocation after a slot's first use
+// -----------------------------------------------------------------------------
+
+#ifndef REPLAN_H
+#define REPLAN_H
+
+#include "navigation/pathfinding.h"
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define REPLAN_RADIUS   48      // Search square: root +/- this many tiles on each axis
+#define REPLAN_SLOTS    8       // Pursuers planning at once
+#define REPLAN_SIDE     (REPLAN_RADIUS * 2 + 1)
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Returns up to max_steps tiles of a cheapest path from (start_x, start_y)
+// to (goal_x, goal_y) (not including the start, like find_path()), from
+// owner's search, repaired for whatever changed since owner's last call
+// (or a new search if owner has none). Free with free_path().
+//
+// Returns NULL at the goal, if the goal lies outside the search square
+// around the start, or if no path exists inside it.
+Path* replan_path(int owner, int start_x, int start_y, int goal_x, int goal_y, int max_steps);
+
+// Returns 1 if owner has a search to repair, 0 if replan_path() would
+// start a new one.
+int replan_active(int owner);
+
+// Drops owner's search, if any.
+void replan_release(int owner);
+
+// Returns the number of nodes expanded by the last replan_path() call.
+int replan_last_expansions(void);
+
+// Frees every search. Slots are allocated again on demand.
+void replan_reset(void);
+
+#endif  // REPLAN_H
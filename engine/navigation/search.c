@@ -0,0 +1,238 @@
+// Implementation file for search.h
+// See search.h for detailed documentation.
+
+#include "navigation/search.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+const int search_dirs[SEARCH_DIRS][2] = {
+    {  1,  0 },
+    { -1,  0 },
+    {  0,  1 },
+    {  0, -1 }
+};
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+static void free_pages(SearchSpace* space) {
+    if (space->pages) {
+        for (int i = 0; i < space->chunks_x * space->chunks_y; i++) {
+            free(space->pages[i]);
+        }
+        free(space->pages);
+    }
+    space->pages = NULL;
+    space->chunks_x = space->chunks_y = 0;
+}
+
+static int layout_pages(SearchSpace* space) {
+    free_pages(space);
+
+    space->map_serial = nav_map->serial;
+    space->width = nav_map->width;
+    space->height = nav_map->height;
+
+    int count = nav_map->chunks_x * nav_map->chunks_y;
+    if (count == 0) return 1;
+
+    space->pages = calloc((size_t)count, sizeof(SearchNode*));
+    if (!space->pages) return 0;
+    space->chunks_x = nav_map->chunks_x;
+    space->chunks_y = nav_map->chunks_y;
+    return 1;
+}
+
+static int entry_before(const SearchOpenEntry* a, const SearchOpenEntry* b) {
+    return a->f < b->f || (a->f == b->f && a->h < b->h);
+}
+
+static void heap_place(SearchSpace* space, int index, SearchOpenEntry entry) {
+    space->heap[index] = entry;
+    entry.node->heap_index = index;
+}
+
+static void sift_up(SearchSpace* space, int index) {
+    SearchOpenEntry entry = space->heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!entry_before(&entry, &space->heap[parent])) break;
+        heap_place(space, index, space->heap[parent]);
+        index = parent;
+    }
+    heap_place(space, index, entry);
+}
+
+static void sift_down(SearchSpace* space, int index) {
+    SearchOpenEntry entry = space->heap[index];
+    int count = space->heap_count;
+    for (;;) {
+        int child = index * 2 + 1;
+        if (child >= count) break;
+        if (child + 1 < count && entry_before(&space->heap[child + 1], &space->heap[child])) child++;
+        if (!entry_before(&space->heap[child], &entry)) break;
+        heap_place(space, index, space->heap[child]);
+        index = child;
+    }
+    heap_place(space, index, entry);
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+void search_space_init(SearchSpace* space) {
+    memset(space, 0, sizeof(*space));
+}
+
+void search_space_free(SearchSpace* space) {
+    free_pages(space);
+    free(space->heap);
+    search_space_init(space);
+}
+
+int search_begin(SearchSpace* space) {
+    if (space->map_serial != nav_map->serial || !space->pages ||
+        space->width != nav_map->width || space->height != nav_map->height) {
+        if (!layout_pages(space)) return 0;
+    }
+
+    space->heap_count = 0;
+    space->generation++;
+
+    // Stamps wrapped: old stamps could now look current, so clear them all
+    if (space->generation == 0) {
+        for (int i = 0; i < space->chunks_x * space->chunks_y; i++) {
+            if (!space->pages[i]) continue;
+            for (int n = 0; n < MAP_CHUNK_TILES; n++) space->pages[i][n].generation = 0;
+        }
+        space->generation = 1;
+    }
+    return 1;
+}
+
+SearchNode* search_node(SearchSpace* space, int x, int y) {
+    int page_index = (y >> MAP_CHUNK_SHIFT) * space->chunks_x + (x >> MAP_CHUNK_SHIFT);
+    SearchNode* page = space->pages[page_index];
+    if (!page) {
+        page = calloc(MAP_CHUNK_TILES, sizeof(SearchNode));   // Stamps 0 = stale
+        if (!page) return NULL;
+        space->pages[page_index] = page;
+    }
+
+    SearchNode* node = &page[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK)];
+    if (node->generation != space->generation) {
+        node->generation = space->generation;
+        node->g = INT32_MAX;
+        node->heap_index = SEARCH_NEW;
+        node->parent = SEARCH_NO_PARENT;
+    }
+    return node;
+}
+
+SearchNode* search_peek(const SearchSpace* space, int x, int y) {
+    SearchNode* page = space->pages[(y >> MAP_CHUNK_SHIFT) * space->chunks_x + (x >> MAP_CHUNK_SHIFT)];
+    if (!page) return NULL;
+
+    SearchNode* node = &page[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK)];
+    return node->generation == space->generation ? node : NULL;
+}
+
+int search_open(SearchSpace* space, SearchNode* node, int x, int y, int f, int h) {
+    SearchOpenEntry entry = { f, h, x, y, node };
+
+    if (node->heap_index >= 0) {
+        // Already open: keys only ever decrease
+        space->heap[node->heap_index] = entry;
+        sift_up(space, node->heap_index);
+        return 1;
+    }
+
+    if (space->heap_count == space->heap_capacity) {
+        int capacity = space->heap_capacity ? space->heap_capacity * 2 : 1024;
+        SearchOpenEntry* heap = realloc(space->heap, sizeof(SearchOpenEntry) * capacity);
+        if (!heap) return 0;
+        space->heap = heap;
+        space->heap_capacity = capacity;
+    }
+
+    space->heap[space->heap_count] = entry;
+    sift_up(space, space->heap_count++);
+    return 1;
+}
+
+SearchNode* search_pop(SearchSpace* space, int* x, int* y) {
+    if (space->heap_count == 0) return NULL;
+
+    SearchOpenEntry top = space->heap[0];
+    if (--space->heap_count > 0) {
+        space->heap[0] = space->heap[space->heap_count];
+        sift_down(space, 0);
+    }
+
+    top.node->heap_index = SEARCH_CLOSED;
+    *x = top.x;
+    *y = top.y;
+    return top.node;
+}
+
+int bucket_queue_reserve(BucketQueue* queue, int max_cost, int entries) {
+    if (max_cost + 1 > queue->head_capacity) {
+        int* head = realloc(queue->head, sizeof(int) * (max_cost + 1));
+        if (!head) return 0;
+        queue->head = head;
+        queue->head_capacity = max_cost + 1;
+    }
+
+    if (entries > queue->capacity) {
+        int* item = realloc(queue->item, sizeof(int) * entries);
+        if (item) queue->item = item;
+        int* next = realloc(queue->next, sizeof(int) * entries);
+        if (next) queue->next = next;
+        if (!item || !next) return 0;
+        queue->capacity = entries;
+    }
+    return 1;
+}
+
+void bucket_queue_free(BucketQueue* queue) {
+    free(queue->head);
+    free(queue->item);
+    free(queue->next);
+    memset(queue, 0, sizeof(*queue));
+}
+
+void bucket_queue_begin(BucketQueue* queue, int max_cost) {
+    for (int c = 0; c <= max_cost; c++) queue->head[c] = -1;
+    queue->max_cost = max_cost;
+    queue->count = 0;
+    queue->cost = 0;
+}
+
+int bucket_queue_push(BucketQueue* queue, int item, int cost) {
+    if (cost > queue->max_cost || queue->count >= queue->capacity) return 0;
+
+    int entry = queue->count++;
+    queue->item[entry] = item;
+    queue->next[entry] = queue->head[cost];
+    queue->head[cost] = entry;
+    return 1;
+}
+
+int bucket_queue_pop(BucketQueue* queue, int* cost) {
+    while (queue->cost <= queue->max_cost && queue->head[queue->cost] < 0) {
+        queue->cost++;
+    }
+    if (queue->cost > queue->max_cost) return -1;
+
+    int entry = queue->head[queue->cost];
+    queue->head[queue->cost] = queue->next[entry];
+    *cost = queue->cost;
+    return queue->item[entry];
+}
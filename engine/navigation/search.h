@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------
+// search.h
+//
+// Reusable workspace for grid searches (A* and friends).
+// This module handles:
+//
+// - Per-tile search state (cost so far, parent, open/closed) stored in pages
+//   of MAP_CHUNK_SIZE x MAP_CHUNK_SIZE nodes, allocated the first time a
+//   search touches that chunk and kept for later searches
+// - Generation stamps: starting a search bumps one counter instead of
+//   clearing any node; a node whose stamp is old reads as unvisited
+// - An indexed binary min-heap of open nodes (ordered by f, then h) with
+//   decrease-key, so picking the next node is O(log n)
+// - A bucket queue for Dijkstra fills whose costs are small integers
+//   (movement grids, flow fields): one list per cost, O(1) push and pop
+//
+// Usage:
+//
+//   search_begin(space);
+//   SearchNode* start = search_node(space, sx, sy);
+//   start->g = 0;
+//   search_open(space, start, sx, sy, h(sx, sy), h(sx, sy));
+//   while ((node = search_pop(space, &x, &y))) { ... expand ... }
+//
+// A space serves one search at a time and belongs to one thread at a time.
+// Searches that must stay alive side by side (resumable searches, several
+// threads) each use their own SearchSpace.
+//
+// Design goals:
+// - No allocation and no clearing per search once the touched pages exist
+// - Memory proportional to the area searches actually visit
+// -----------------------------------------------------------------------------
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "core/map.h"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define SEARCH_NEW          -1      // heap_index: not yet opened this search
+#define SEARCH_CLOSED       -2      // heap_index: expanded
+#define SEARCH_NO_PARENT    0xFF    // parent of the start node
+#define SEARCH_DIRS         4
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+// Search state of one tile. Valid only while generation matches the
+// space's; search_node() refreshes stale nodes.
+typedef struct {
+    uint32_t generation;
+    int32_t g;              // Cost from the start (INT32_MAX = unreached)
+    int32_t heap_index;     // Index in the open heap, or SEARCH_NEW / SEARCH_CLOSED
+    uint8_t parent;         // Caller-defined link to the parent (e.g. a direction)
+} SearchNode;
+
+typedef struct {
+    int32_t f;              // g + h
+    int32_t h;              // Tie-break: nearer the goal first
+    int32_t x, y;
+    SearchNode* node;
+} SearchOpenEntry;
+
+typedef struct {
+    // Map the pages were laid out for (see search_begin())
+    uint32_t map_serial;
+    int width, height;
+    int chunks_x, chunks_y;
+
+    SearchNode** pages;     // One page per map chunk, NULL until touched
+    uint32_t generation;
+
+    SearchOpenEntry* heap;
+    int heap_count;
+    int heap_capacity;
+} SearchSpace;
+
+// Open list of a Dijkstra fill over costs 0 .. max_cost. Entries go into
+// one list per cost and are popped in cost order without a heap; a tile
+// whose cost drops is pushed again, and the caller skips the stale entry
+// when it pops (its cost is above the tile's best).
+//
+// Fields:
+//   head: head[cost] is the newest entry of that cost, -1 if none
+//   item, next: Caller's value of each entry, and the next entry of the
+//               same cost (-1 ends a list)
+//   count: Entries pushed since bucket_queue_begin()
+//   cost: Lowest cost that may still hold entries
+typedef struct {
+    int* head;
+    int head_capacity;
+    int max_cost;
+    int* item;
+    int* next;
+    int count;
+    int capacity;
+    int cost;
+} BucketQueue;
+
+// -----------------------------------------------------------------------------
+// Global State
+// -----------------------------------------------------------------------------
+
+// 4-directional moves { dx, dy }: +x, -x, +y, -y. Grid searches store the
+// index of the move that reached a node in its parent field.
+extern const int search_dirs[SEARCH_DIRS][2];
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Prepares an empty space (no allocation until the first search).
+void search_space_init(SearchSpace* space);
+
+// Frees the pages and heap of a space.
+void search_space_free(SearchSpace* space);
+
+// Starts a new search: empties the heap and invalidates every node by
+// bumping the generation. Re-lays out the pages if the map changed since
+// the last search. Returns 0 on allocation failure.
+int search_begin(SearchSpace* space);
+
+// Returns the node of in-bounds tile (x, y), reset to unreached if this
+// search has not touched it yet. Returns NULL if its page cannot be
+// allocated.
+SearchNode* search_node(SearchSpace* space, int x, int y);
+
+// Returns the node of (x, y) if this search has touched it, else NULL.
+// Never allocates.
+SearchNode* search_peek(const SearchSpace* space, int x, int y);
+
+// Adds node (at x, y) to the open heap with the given f and h, or lowers
+// its key if it is already open. Returns 0 on allocation failure.
+int search_open(SearchSpace* space, SearchNode* node, int x, int y, int f, int h);
+
+// Removes the open node with the lowest f (then h), marks it closed and
+// stores its tile in x, y. Returns NULL when the heap is empty.
+SearchNode* search_pop(SearchSpace* space, int* x, int* y);
+
+// Grows queue to hold costs up to max_cost and entries pushes per fill.
+// A zeroed BucketQueue is empty. Returns 0 on allocation failure (the
+// queue keeps its old size).
+int bucket_queue_reserve(BucketQueue* queue, int max_cost, int entries);
+
+// Frees a queue's storage and zeroes it.
+void bucket_queue_free(BucketQueue* queue);
+
+// Empties queue for a fill over costs 0 .. max_cost (at most the reserved
+// maximum).
+void bucket_queue_begin(BucketQueue* queue, int max_cost);
+
+// Adds item at cost, which must not be below the cost last popped.
+// Returns 0 without adding it if cost is above max_cost or the queue is
+// full.
+int bucket_queue_push(BucketQueue* queue, int item, int cost);
+
+// Removes an entry of the lowest cost, stores that cost in cost and
+// returns its item. Returns -1 when the queue is empty.
+int bucket_queue_pop(BucketQueue* queue, int* cost);
+
+#endif  // SEARCH_H
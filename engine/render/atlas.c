@@ -0,0 +1,222 @@
+// Implementation file for atlas.h
+// See atlas.h for detailed documentation.
+
+#include "render/atlas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL2/SDL_image.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types and State
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    int y;              // Top edge on the page
+    int height;
+    int cursor_x;       // Next free x
+} Shelf;
+
+typedef struct {
+    SDL_Texture* texture;
+    Shelf shelves[ATLAS_MAX_SHELVES];
+    int shelf_count;
+    int next_y;         // Top edge of the next shelf to open
+} AtlasPage;
+
+static SDL_Renderer* atlas_renderer = NULL;
+static AtlasPage pages[ATLAS_MAX_PAGES];
+static int page_count = 0;
+
+static AtlasRegion regions[ATLAS_MAX_REGIONS];
+static int region_count = 1;    // Region 0 is SPRITE_NONE
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+// Creates a page texture and clears it to transparent.
+static int create_page(void) {
+    if (page_count >= ATLAS_MAX_PAGES || !atlas_renderer) return 0;
+
+    SDL_Texture* texture = SDL_CreateTexture(atlas_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                             ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+    if (!texture) {
+        printf("Failed to create atlas page: %s\n", SDL_GetError());
+        return 0;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    // Static textures start with undefined contents; clear in strips
+    enum { STRIP_ROWS = 64 };
+    void* zeros = calloc((size_t)ATLAS_PAGE_SIZE * STRIP_ROWS, 4);
+    if (!zeros) {
+        SDL_DestroyTexture(texture);
+        return 0;
+    }
+    for (int y = 0; y < ATLAS_PAGE_SIZE; y += STRIP_ROWS) {
+        SDL_Rect strip = { 0, y, ATLAS_PAGE_SIZE, STRIP_ROWS };
+        SDL_UpdateTexture(texture, &strip, zeros, ATLAS_PAGE_SIZE * 4);
+    }
+    free(zeros);
+
+    AtlasPage* page = &pages[page_count++];
+    page->texture = texture;
+    page->shelf_count = 0;
+    page->next_y = 0;
+    return 1;
+}
+
+// Finds room for a padded w x h rectangle on a page.
+// Returns the shelf to use, opening a new one if that fits better.
+static Shelf* find_shelf(AtlasPage* page, int w, int h) {
+    Shelf* best = NULL;
+    for (int i = 0; i < page->shelf_count; i++) {
+        Shelf* shelf = &page->shelves[i];
+        if (shelf->height < h || shelf->cursor_x + w > ATLAS_PAGE_SIZE) continue;
+        if (!best || shelf->height < best->height) best = shelf;
+    }
+
+    // A shelf over twice the height wastes more than it saves; open a new one if possible
+    int can_open = page->shelf_count < ATLAS_MAX_SHELVES && page->next_y + h <= ATLAS_PAGE_SIZE;
+    if (can_open && (!best || best->height > h * 2)) {
+        Shelf* shelf = &page->shelves[page->shelf_count++];
+        shelf->y = page->next_y;
+        shelf->height = h;
+        shelf->cursor_x = 0;
+        page->next_y += h;
+        return shelf;
+    }
+    return best;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+void atlas_init(SDL_Renderer* renderer) {
+    atlas_free();
+    atlas_renderer = renderer;
+}
+
+void atlas_free(void) {
+    for (int i = 0; i < page_count; i++) {
+        SDL_DestroyTexture(pages[i].texture);
+        pages[i].texture = NULL;
+    }
+    page_count = 0;
+    region_count = 1;
+}
+
+SpriteId atlas_reserve(int width, int height) {
+    int w = width + 2 * ATLAS_PADDING;
+    int h = height + 2 * ATLAS_PADDING;
+    if (width <= 0 || height <= 0 || w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE) {
+        printf("Atlas: cannot fit %dx%d image\n", width, height);
+        return SPRITE_NONE;
+    }
+    if (region_count >= ATLAS_MAX_REGIONS) {
+        printf("Atlas: region table full\n");
+        return SPRITE_NONE;
+    }
+
+    Shelf* shelf = NULL;
+    int page_index;
+    for (page_index = 0; page_index < page_count; page_index++) {
+        shelf = find_shelf(&pages[page_index], w, h);
+        if (shelf) break;
+    }
+    if (!shelf) {
+        if (!create_page()) {
+            printf("Atlas: out of pages\n");
+            return SPRITE_NONE;
+        }
+        page_index = page_count - 1;
+        shelf = find_shelf(&pages[page_index], w, h);
+    }
+
+    AtlasRegion* region = &regions[region_count];
+    region->page = page_index;
+    region->rect = (SDL_Rect){ shelf->cursor_x + ATLAS_PADDING, shelf->y + ATLAS_PADDING, width, height };
+    region->u0 = (float)region->rect.x / ATLAS_PAGE_SIZE;
+    region->v0 = (float)region->rect.y / ATLAS_PAGE_SIZE;
+    region->u1 = (float)(region->rect.x + width) / ATLAS_PAGE_SIZE;
+    region->v1 = (float)(region->rect.y + height) / ATLAS_PAGE_SIZE;
+    shelf->cursor_x += w;
+
+    return region_count++;
+}
+
+int atlas_upload(SpriteId sprite, SDL_Surface* surface) {
+    const AtlasRegion* region = atlas_region(sprite);
+    if (!region || !surface) return 0;
+
+    SDL_Surface* pixels = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!pixels) {
+        printf("Atlas: failed to convert image: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    if (pixels->w != region->rect.w || pixels->h != region->rect.h) {
+        SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, region->rect.w, region->rect.h, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!scaled) {
+            SDL_FreeSurface(pixels);
+            return 0;
+        }
+        SDL_SetSurfaceBlendMode(pixels, SDL_BLENDMODE_NONE);   // Copy alpha as-is
+        SDL_BlitScaled(pixels, NULL, scaled, NULL);
+        SDL_FreeSurface(pixels);
+        pixels = scaled;
+    }
+
+    int ok = SDL_UpdateTexture(pages[region->page].texture, &region->rect, pixels->pixels, pixels->pitch) == 0;
+    SDL_FreeSurface(pixels);
+    if (!ok) {
+        printf("Atlas: failed to upload image: %s\n", SDL_GetError());
+    }
+    return ok;
+}
+
+SpriteId atlas_add_surface(SDL_Surface* surface) {
+    if (!surface) return SPRITE_NONE;
+
+    SpriteId sprite = atlas_reserve(surface->w, surface->h);
+    if (sprite == SPRITE_NONE) return SPRITE_NONE;
+
+    // The region stays reserved on failure; uploads are only expected to
+    // fail when the renderer is already in trouble
+    if (!atlas_upload(sprite, surface)) return SPRITE_NONE;
+    return sprite;
+}
+
+SpriteId atlas_add_image(const char* path) {
+    SDL_Surface* surface = IMG_Load(path);
+    if (!surface) {
+        printf("Failed to load image %s: %s\n", path, SDL_GetError());
+        return SPRITE_NONE;
+    }
+
+    SpriteId sprite = atlas_add_surface(surface);
+    SDL_FreeSurface(surface);
+    return sprite;
+}
+
+const AtlasRegion* atlas_region(SpriteId sprite) {
+    if (sprite <= SPRITE_NONE || sprite >= region_count) return NULL;
+    return &regions[sprite];
+}
+
+SDL_Texture* atlas_page(int page) {
+    if (page < 0 || page >= page_count) return NULL;
+    return pages[page].texture;
+}
+
+int atlas_page_count(void) {
+    return page_count;
+}
+
+void atlas_draw(SDL_Renderer* renderer, SpriteId sprite, const SDL_Rect* dest) {
+    const AtlasRegion* region = atlas_region(sprite);
+    if (!region) return;
+    SDL_RenderCopy(renderer, pages[region->page].texture, &region->rect, dest);
+}
@@ -0,0 +1,124 @@
+// -----------------------------------------------------------------------------
+// atlas.h
+//
+// Texture atlas: tile and sprite images packed into a few large textures.
+// This module handles:
+//
+// - Reserving rectangles on atlas pages (shelf packing)
+// - Uploading images into reserved rectangles (scaled to fit if needed)
+// - Looking up a sprite's page texture and texture coordinates
+//
+// Sprites are referred to by SpriteId, an index into the region table.
+// SPRITE_NONE is 0, so zero-initialized structs (entities, tile tables)
+// start out with "no sprite".
+//
+// Packing:
+//
+//   Each page is split into horizontal shelves. A region goes on the
+//   shortest existing shelf that is tall enough and has room left, or on a
+//   new shelf opened below the last one. Regions are padded by
+//   ATLAS_PADDING pixels so neighbours never bleed into each other.
+//
+//   +--------------------------+
+//   | [tile][tile][tile][tile] |  <- shelf 0 (32 px)
+//   | [npc ][player]           |  <- shelf 1 (64 px)
+//   |                          |
+//   +--------------------------+
+//
+// Regions are never freed individually; callers that recycle images of a
+// fixed size (streamed tile art, see render.c) reuse regions with
+// atlas_upload() instead.
+//
+// Design goals:
+// - Few textures, so a whole layer can be drawn with one call per page
+//   (see batch.h)
+// - Packing cost paid once at load time
+// - No per-sprite SDL_Texture objects
+// -----------------------------------------------------------------------------
+
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define ATLAS_PAGE_SIZE     2048    // Page width and height in pixels
+#define ATLAS_MAX_PAGES     8
+#define ATLAS_MAX_REGIONS   4096
+#define ATLAS_MAX_SHELVES   256     // Per page
+#define ATLAS_PADDING       1       // Empty pixels around each region
+
+#define SPRITE_NONE         0
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+typedef int SpriteId;
+
+// A packed image.
+//
+// Fields:
+//   page: Index of the page texture holding the image
+//   rect: Pixel rectangle on the page
+//   u0, v0, u1, v1: rect in normalized texture coordinates
+typedef struct {
+    int page;
+    SDL_Rect rect;
+    float u0, v0;
+    float u1, v1;
+} AtlasRegion;
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Prepares an empty atlas for the given renderer. Pages are created lazily
+// as regions are reserved.
+void atlas_init(SDL_Renderer* renderer);
+
+// Destroys every page. All SpriteIds become invalid.
+void atlas_free(void);
+
+// Reserves a width x height rectangle without uploading anything.
+//
+// Returns:
+//   The new SpriteId, or SPRITE_NONE if every page is full.
+SpriteId atlas_reserve(int width, int height);
+
+// Copies a surface into a reserved region, scaling it if the sizes differ.
+// The caller keeps ownership of the surface.
+//
+// Returns:
+//   1 on success, 0 on failure.
+int atlas_upload(SpriteId sprite, SDL_Surface* surface);
+
+// Reserves a region the size of the surface and uploads it.
+//
+// Returns:
+//   The new SpriteId, or SPRITE_NONE on failure.
+SpriteId atlas_add_surface(SDL_Surface* surface);
+
+// Loads an image file and adds it to the atlas.
+//
+// Returns:
+//   The new SpriteId, or SPRITE_NONE on failure.
+SpriteId atlas_add_image(const char* path);
+
+// Returns the region of a sprite, or NULL for SPRITE_NONE / invalid ids.
+const AtlasRegion* atlas_region(SpriteId sprite);
+
+// Returns the texture of a page, or NULL if it does not exist.
+SDL_Texture* atlas_page(int page);
+
+// Returns the number of pages created so far.
+int atlas_page_count(void);
+
+// Draws one sprite with SDL_RenderCopy. For one-off draws; layers with
+// many sprites should go through batch.h instead.
+void atlas_draw(SDL_Renderer* renderer, SpriteId sprite, const SDL_Rect* dest);
+
+#endif  // ATLAS_H
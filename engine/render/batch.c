@@ -0,0 +1,91 @@
+// Implementation file for batch.h
+// See batch.h for detailed documentation.
+
+#include "render/batch.h"
+
+// -----------------------------------------------------------------------------
+// Internal State
+// -----------------------------------------------------------------------------
+
+static SDL_Vertex vertices[ATLAS_MAX_PAGES][BATCH_MAX_QUADS * 4];
+static int quad_counts[ATLAS_MAX_PAGES];
+
+// Quad q uses vertices 4q..4q+3 as two triangles; the same indices serve every page
+static int indices[BATCH_MAX_QUADS * 6];
+static int indices_ready = 0;
+
+static int batch_mode = BATCH_UNORDERED;
+static int last_page = -1;      // Page of the newest quad (ordered mode)
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+static void build_indices(void) {
+    for (int q = 0; q < BATCH_MAX_QUADS; q++) {
+        int* i = &indices[q * 6];
+        int v = q * 4;
+        i[0] = v;     i[1] = v + 1; i[2] = v + 2;
+        i[3] = v + 2; i[4] = v + 3; i[5] = v;
+    }
+    indices_ready = 1;
+}
+
+static void flush_page(SDL_Renderer* renderer, int page) {
+    int quads = quad_counts[page];
+    if (quads == 0) return;
+
+    SDL_RenderGeometry(renderer, atlas_page(page), vertices[page], quads * 4, indices, quads * 6);
+    quad_counts[page] = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+void batch_begin(int mode) {
+    if (!indices_ready) build_indices();
+
+    for (int page = 0; page < ATLAS_MAX_PAGES; page++) {
+        quad_counts[page] = 0;
+    }
+    batch_mode = mode;
+    last_page = -1;
+}
+
+void batch_quad(SDL_Renderer* renderer, SpriteId sprite, const SDL_Rect* dest) {
+    SDL_Color white = { 255, 255, 255, 255 };
+    batch_quad_tinted(renderer, sprite, dest, white);
+}
+
+void batch_quad_tinted(SDL_Renderer* renderer, SpriteId sprite, const SDL_Rect* dest, SDL_Color tint) {
+    const AtlasRegion* region = atlas_region(sprite);
+    if (!region) return;
+
+    int page = region->page;
+    if (batch_mode == BATCH_ORDERED && last_page >= 0 && page != last_page) {
+        flush_page(renderer, last_page);
+    }
+    if (quad_counts[page] == BATCH_MAX_QUADS) {
+        flush_page(renderer, page);
+    }
+    last_page = page;
+
+    float x0 = (float)dest->x;
+    float y0 = (float)dest->y;
+    float x1 = (float)(dest->x + dest->w);
+    float y1 = (float)(dest->y + dest->h);
+
+    SDL_Vertex* v = &vertices[page][quad_counts[page]++ * 4];
+    v[0] = (SDL_Vertex){ { x0, y0 }, tint, { region->u0, region->v0 } };
+    v[1] = (SDL_Vertex){ { x1, y0 }, tint, { region->u1, region->v0 } };
+    v[2] = (SDL_Vertex){ { x1, y1 }, tint, { region->u1, region->v1 } };
+    v[3] = (SDL_Vertex){ { x0, y1 }, tint, { region->u0, region->v1 } };
+}
+
+void batch_flush(SDL_Renderer* renderer) {
+    for (int page = 0; page < atlas_page_count(); page++) {
+        flush_page(renderer, page);
+    }
+    last_page = -1;
+}
@@ -0,0 +1,65 @@
+// -----------------------------------------------------------------------------
+// batch.h
+//
+// Batched sprite submission through SDL_RenderGeometry.
+// This module handles:
+//
+// - Collecting textured quads for atlas sprites (see atlas.h)
+// - Emitting them with one SDL_RenderGeometry call per atlas page
+// - Per-quad tinting through vertex colors
+//
+// Usage:
+//
+//   batch_begin(BATCH_UNORDERED);
+//   for (...) batch_quad(renderer, sprite, &dest);
+//   batch_flush(renderer);
+//
+// Ordering:
+// - BATCH_UNORDERED: quads are bucketed per page and pages are drawn in
+//   index order at flush. Use for layers whose quads do not overlap
+//   (terrain), where submission order does not matter.
+// - BATCH_ORDERED: submission order is kept exactly; a pending run is
+//   flushed whenever the page changes. Use for overlapping sprites
+//   (entities). With all sprites of a layer on one page this is still a
+//   single call.
+//
+// Design goals:
+// - Draw calls per layer ~ atlas pages, not sprites
+// - No allocation per frame (fixed vertex buffers, shared index buffer)
+// -----------------------------------------------------------------------------
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "render/atlas.h"
+
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define BATCH_MAX_QUADS 4096    // Per page; a full page bucket is flushed early
+
+#define BATCH_UNORDERED 0
+#define BATCH_ORDERED   1
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Starts a batch. Any quads left from a previous batch are discarded.
+void batch_begin(int mode);
+
+// Queues sprite drawn into dest. SPRITE_NONE is ignored.
+void batch_quad(SDL_Renderer* renderer, SpriteId sprite, const SDL_Rect* dest);
+
+// Same as batch_quad(), with the sprite's colors multiplied by tint.
+// The tint travels in the vertex colors, so differently tinted quads on
+// one page still go out in a single call; no texture state is touched.
+void batch_quad_tinted(SDL_Renderer* renderer, SpriteId sprite, const SDL_Rect* dest, SDL_Color tint);
+
+// Draws every queued quad and empties the batch.
+void batch_flush(SDL_Renderer* renderer);
+
+#endif  // BATCH_H
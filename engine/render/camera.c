@@ -1,6 +1,6 @@
 #include "render/camera.h"
 #include "render/render.h" // For TILE_WIDTH and TILE_HEIGHT
-#include "core/map.h"    // For MAP_WIDTH / MAP_HEIGHT
+#include "core/map.h"    // For map_width() / map_height()
 #include "core/constants.h"
 
 int map_offset_x = 0;
@@ -9,30 +9,99 @@ int map_offset_y = 0;
 // Centers the map on the screen at startup
 void calculate_map_offset() {
     // Get the tile in the *center* of the map grid
-    int center_tile_x = MAP_WIDTH / 2;
-    int center_tile_y = MAP_HEIGHT / 2;
+    int center_tile_x = map_width() / 2;
+    int center_tile_y = map_height() / 2;
 
     // Convert center tile to screen coordinates (in isometric space)
     int map_center_x = (center_tile_x - center_tile_y) * (TILE_WIDTH / 2);
     int map_center_y = (center_tile_x + center_tile_y) * (TILE_HEIGHT / 2);
 
     // Calculate how far to offset the map so that the center tile ends up
-    // in the *center* of the game window (800x600)
-    map_offset_x = (800 / 2) - map_center_x;
-    map_offset_y = (600 / 2) - map_center_y;
+    // in the *center* of the game window
+    map_offset_x = (WINDOW_WIDTH / 2) - map_center_x;
+    map_offset_y = (WINDOW_HEIGHT / 2) - map_center_y;
 }
 
 // Keeps the player centered by moving the camera offset
-void update_camera(Camera* cam, int player_x, int player_y) {
+void update_camera(Camera* cam, float player_x, float player_y) {
     // Screen center in pixels
-    int screen_center_x = 800 / 2;
-    int screen_center_y = 600 / 2;
+    int screen_center_x = WINDOW_WIDTH / 2;
+    int screen_center_y = WINDOW_HEIGHT / 2;
 
-    // Convert player's tile position to isometric screen coordinates
-    int iso_x = (player_x - player_y) * (TILE_WIDTH / 2) + map_offset_x;
-    int iso_y = (player_x + player_y) * (TILE_HEIGHT / 2) + map_offset_y;
+    // Convert player's tile position (fractional while moving) to isometric screen coordinates
+    int iso_x = (int)((player_x - player_y) * (TILE_WIDTH / 2)) + map_offset_x;
+    int iso_y = (int)((player_x + player_y) * (TILE_HEIGHT / 2)) + map_offset_y;
 
     // Move the camera so that the player is always centered on the screen
     cam->x = iso_x - screen_center_x;
     cam->y = iso_y - screen_center_y;
 }
+
+// Inverse of update_camera(): which tile sits at the centre of the screen
+void camera_center_tile(const Camera* cam, int* tile_x, int* tile_y) {
+    // World-space pixel at the screen centre, relative to tile (0, 0)
+    int world_x = cam->x + WINDOW_WIDTH / 2 - map_offset_x;
+    int world_y = cam->y + WINDOW_HEIGHT / 2 - map_offset_y;
+
+    // x - y = world_x / (TILE_WIDTH / 2), x + y = world_y / (TILE_HEIGHT / 2)
+    float x_minus_y = (float)world_x / (TILE_WIDTH / 2);
+    float x_plus_y = (float)world_y / (TILE_HEIGHT / 2);
+
+    *tile_x = (int)((x_plus_y + x_minus_y) / 2.0f + 0.5f);
+    *tile_y = (int)((x_plus_y - x_minus_y) / 2.0f + 0.5f);
+}
+
+// Floor division (C division truncates towards zero)
+static int floor_div(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Inverts the projection for the window rectangle. A tile's bounding box
+// starts at ((x - y) * TILE_WIDTH/2, (x + y) * TILE_HEIGHT/2) in world
+// pixels, so it overlaps the window exactly when x - y and x + y fall in
+// the ranges below. Those two ranges bound the view diamond in tile space.
+void camera_visible_tiles(const Camera* cam, TileView* view) {
+    int half_w = TILE_WIDTH / 2;
+    int half_h = TILE_HEIGHT / 2;
+
+    // World-space pixel of the window's top-left corner
+    int world_x = cam->x - map_offset_x;
+    int world_y = cam->y - map_offset_y;
+
+    // -TILE_WIDTH < screen_x < WINDOW_WIDTH, same for y
+    view->min_u = floor_div(world_x - TILE_WIDTH, half_w) + 1;
+    view->max_u = floor_div(world_x + WINDOW_WIDTH - 1, half_w);
+    view->min_v = floor_div(world_y - TILE_HEIGHT, half_h) + 1;
+    view->max_v = floor_div(world_y + WINDOW_HEIGHT - 1, half_h);
+
+    // y = (v - u) / 2, clipped to the map
+    view->min_y = floor_div(view->min_v - view->max_u, 2);
+    view->max_y = floor_div(view->max_v - view->min_u + 1, 2);
+    if (view->min_y < 0) view->min_y = 0;
+    if (view->max_y > map_height() - 1) view->max_y = map_height() - 1;
+}
+
+int tile_view_row(const TileView* view, int y, int* x_min, int* x_max) {
+    // x - y in [min_u, max_u] and x + y in [min_v, max_v]
+    int lo = y + view->min_u;
+    int hi = y + view->max_u;
+    if (view->min_v - y > lo) lo = view->min_v - y;
+    if (view->max_v - y < hi) hi = view->max_v - y;
+    if (lo < 0) lo = 0;
+    if (hi > map_width() - 1) hi = map_width() - 1;
+
+    *x_min = lo;
+    *x_max = hi;
+    return lo <= hi;
+}
+
+void camera_visible_chunks(const Camera* cam, int* chunk_x0, int* chunk_y0, int* chunk_x1, int* chunk_y1) {
+    TileView view;
+    camera_visible_tiles(cam, &view);
+
+    // x = (u + v) / 2 over the diamond
+    *chunk_x0 = floor_div(view.min_u + view.min_v, 2) >> MAP_CHUNK_SHIFT;
+    *chunk_x1 = floor_div(view.max_u + view.max_v + 1, 2) >> MAP_CHUNK_SHIFT;
+    *chunk_y0 = view.min_y >> MAP_CHUNK_SHIFT;
+    *chunk_y1 = view.max_y >> MAP_CHUNK_SHIFT;
+}
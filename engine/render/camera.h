@@ -5,10 +5,38 @@ typedef struct Camera {
     int x, y; // world offset in pixels
 } Camera;
 
+// Tiles overlapping the window, as computed by camera_visible_tiles().
+//
+// The visible area is a diamond in tile space, bounded by ranges of
+// u = x - y (screen columns) and v = x + y (screen rows). Iterate it with:
+//
+//   for (int y = view.min_y; y <= view.max_y; y++) {
+//       int x0, x1;
+//       if (!tile_view_row(&view, y, &x0, &x1)) continue;
+//       for (int x = x0; x <= x1; x++) { ... }
+//   }
+typedef struct {
+    int min_u, max_u;   // Visible range of x - y
+    int min_v, max_v;   // Visible range of x + y
+    int min_y, max_y;   // Map rows that may contain visible tiles
+} TileView;
+
 extern int map_offset_x;
 extern int map_offset_y;
 
-void update_camera(Camera* cam, int player_x, int player_y);
+void update_camera(Camera* cam, float player_x, float player_y);
 void calculate_map_offset();
+void camera_center_tile(const Camera* cam, int* tile_x, int* tile_y);
+
+// Computes the visible tile range for the window, clipped to the map.
+// Cost is O(1); iterating the result is O(tiles on screen).
+void camera_visible_tiles(const Camera* cam, TileView* view);
+
+// Gets the inclusive visible x range of map row y. Returns 0 if empty.
+int tile_view_row(const TileView* view, int y, int* x_min, int* x_max);
+
+// Gets the inclusive box of chunks the window overlaps (may reach past
+// the map; map_view_capture() clamps it).
+void camera_visible_chunks(const Camera* cam, int* chunk_x0, int* chunk_y0, int* chunk_x1, int* chunk_y1);
 
 #endif
@@ -1,28 +1,112 @@
 #include "render/render.h"
 #include "render/camera.h"
+#include "render/terrain_cache.h"
+#include "render/batch.h"
 #include "core/map.h"
 #include "core/constants.h"
+#include "core/profiler.h"
 
 #include <SDL2/SDL_image.h>
 
-SDL_Texture* tile_textures[1]; // Only 1 tile for now
+SpriteId tile_sprites[TILE_COUNT];
+uint32_t tile_sprite_generation = 0;
 
-int load_tile_textures(SDL_Renderer* renderer) {
-    SDL_Surface* surface = IMG_Load(GRASS_TILE);
+// Atlas cells given up by release_tile_image(), reused before reserving more
+static SpriteId free_tile_cells[TILE_COUNT];
+static int free_tile_cell_count = 0;
+
+void init_render(SDL_Renderer* renderer) {
+    atlas_init(renderer);
+    for (int id = 0; id < TILE_COUNT; id++) {
+        tile_sprites[id] = SPRITE_NONE;
+    }
+    free_tile_cell_count = 0;
+    tile_sprite_generation++;
+}
+
+void shutdown_render(void) {
+    terrain_cache_clear();
+    atlas_free();
+    for (int id = 0; id < TILE_COUNT; id++) {
+        tile_sprites[id] = SPRITE_NONE;
+    }
+    free_tile_cell_count = 0;
+}
+
+const char* tile_texture_path(TileId id) {
+    if (id >= TILE_COUNT) return NULL;
+    return GRASS_TILE; // Only grass art exists for now, every tile type uses it
+}
+
+SDL_Surface* load_tile_surface(TileId id) {
+    const char* path = tile_texture_path(id);
+    if (!path) return NULL;
+
+    SDL_Surface* surface = IMG_Load(path);
     if (!surface) {
         printf("Failed to load tile: %s\n", SDL_GetError());
+    }
+    return surface;
+}
+
+int set_tile_image(TileId id, SDL_Surface* surface) {
+    if (id >= TILE_COUNT || !surface) return 0;
+
+    SpriteId cell = tile_sprites[id];
+    if (cell == SPRITE_NONE) {
+        cell = free_tile_cell_count > 0 ? free_tile_cells[--free_tile_cell_count]
+                                        : atlas_reserve(TILE_WIDTH, TILE_HEIGHT);
+        if (cell == SPRITE_NONE) return 0;
+    }
+
+    if (!atlas_upload(cell, surface)) {
+        if (tile_sprites[id] == SPRITE_NONE) free_tile_cells[free_tile_cell_count++] = cell;
         return 0;
     }
-    tile_textures[0] = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+
+    tile_sprites[id] = cell;
+    tile_sprite_generation++;
     return 1;
 }
 
-// Draws the map tiles in isometric space using camera + map offset
-void draw_map(SDL_Renderer* renderer, Camera* cam) {
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            int tile_id = tile_map[y][x]; // Get the tile type (e.g., grass, dirt, etc.)
+void release_tile_image(TileId id) {
+    if (id >= TILE_COUNT || tile_sprites[id] == SPRITE_NONE) return;
+    free_tile_cells[free_tile_cell_count++] = tile_sprites[id];
+    tile_sprites[id] = SPRITE_NONE;
+    tile_sprite_generation++;
+}
+
+int load_tile_images(void) {
+    for (int id = 0; id < TILE_COUNT; id++) {
+        SDL_Surface* surface = load_tile_surface((TileId)id);
+        if (!surface) return 0;
+
+        int ok = set_tile_image((TileId)id, surface);
+        SDL_FreeSurface(surface);
+        if (!ok) return 0;
+    }
+    return 1;
+}
+
+// Draws the map tiles one by one in isometric space using camera + map
+// offset (no render-target support). Only tiles inside the view diamond
+// are visited.
+static void draw_map_tiles(SDL_Renderer* renderer, Camera* cam, const MapView* map) {
+    TileView view;
+    camera_visible_tiles(cam, &view);
+    batch_begin(BATCH_UNORDERED);
+
+    for (int y = view.min_y; y <= view.max_y; y++) {
+        int x_min, x_max;
+        if (!tile_view_row(&view, y, &x_min, &x_max)) continue;
+
+        for (int x = x_min; x <= x_max; x++) {
+            // Get the tile type (e.g., grass, dirt, etc.)
+            const MapChunk* chunk = map_view_chunk(map, x >> MAP_CHUNK_SHIFT, y >> MAP_CHUNK_SHIFT);
+            int tile_id = chunk->tiles[((y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT) | (x & MAP_CHUNK_MASK)];
+
+            // Skip streamed-out tiles and tiles whose image is not uploaded yet
+            if (tile_id >= TILE_COUNT || tile_sprites[tile_id] == SPRITE_NONE) continue;
 
             // Convert from tile corrdinates to screen position in isometric space
             // Formula transforms square grid to diamond layout
@@ -35,7 +119,16 @@ void draw_map(SDL_Renderer* renderer, Camera* cam) {
 
             // Define where to draw this tile on screen
             SDL_Rect dest = { screen_x, screen_y, TILE_WIDTH, TILE_HEIGHT };
-            SDL_RenderCopy(renderer, tile_textures[tile_id], NULL, &dest);
+            batch_quad(renderer, tile_sprites[tile_id], &dest);
         }
     }
+    batch_flush(renderer);
+}
+
+void draw_map(SDL_Renderer* renderer, Camera* cam, const MapView* map) {
+    PROFILE_BEGIN("draw_map");
+    if (!terrain_cache_draw(renderer, cam, map)) {
+        draw_map_tiles(renderer, cam, map);
+    }
+    PROFILE_END();
 }
@@ -2,10 +2,46 @@
 #define RENDER_H
 
 #include "render/camera.h"
+#include "render/atlas.h"
+#include "core/map.h"
+#include "core/tile.h"
 
 #include <SDL2/SDL.h>
 
-int load_tile_textures(SDL_Renderer* renderer);
-void draw_map(SDL_Renderer* renderer, struct Camera* cam);
+// Atlas sprite per TileId (SPRITE_NONE = not loaded / streamed out).
+// Tile art lives in TILE_WIDTH x TILE_HEIGHT atlas cells; cells released by
+// release_tile_image() are reused by the next set_tile_image().
+extern SpriteId tile_sprites[TILE_COUNT];
+
+// Bumped whenever an entry of tile_sprites changes, so anything rendered
+// from them (see terrain_cache.h) knows to redraw.
+extern uint32_t tile_sprite_generation;
+
+// Sets up the atlas for a renderer. Call once after the renderer exists.
+void init_render(SDL_Renderer* renderer);
+
+// Releases baked terrain and the atlas. Call before destroying the renderer.
+void shutdown_render(void);
+
+// Image file for a tile type, or NULL for ids without art (e.g. MAP_TILE_VOID)
+const char* tile_texture_path(TileId id);
+
+// Decodes a tile image. Does not touch the renderer, so it is safe to call
+// from the streaming worker thread.
+SDL_Surface* load_tile_surface(TileId id);
+
+// Uploads a decoded surface as a tile type's art, scaled to the tile size,
+// replacing any existing image. Main thread only. The caller keeps
+// ownership of the surface.
+int set_tile_image(TileId id, SDL_Surface* surface);
+void release_tile_image(TileId id);
+
+// Loads the art of every tile type.
+int load_tile_images(void);
+
+// Draws the visible terrain of map (captured by map_view_capture()): baked
+// chunk textures when the renderer supports render targets (see
+// terrain_cache.h), visible tiles one by one otherwise.
+void draw_map(SDL_Renderer* renderer, struct Camera* cam, const MapView* map);
 
 #endif
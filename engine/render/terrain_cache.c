@@ -0,0 +1,258 @@
+// Implementation file for terrain_cache.h
+// See terrain_cache.h for detailed documentation.
+
+#include "render/terrain_cache.h"
+#include "render/render.h"
+#include "render/batch.h"
+#include "core/map.h"
+#include "core/tile.h"
+#include "core/constants.h"
+
+#include <stdio.h>
+#include <limits.h>
+
+// -----------------------------------------------------------------------------
+// Internal Types and State
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    SDL_Texture* texture;       // NULL = slot never used
+    int chunk_index;            // cy * chunks_x + cx, -1 = holds nothing valid
+    uint32_t revision;          // chunk_revisions[] value when baked
+    uint32_t tile_generation;   // tile_sprite_generation when baked
+    uint32_t last_drawn;        // Frame the texture was last drawn
+} BakedChunk;
+
+static BakedChunk cache[TERRAIN_CACHE_SIZE];
+static uint32_t cache_map_serial = 0;   // MapView::serial the cache was built for
+static uint32_t frame = 0;
+
+static int baked_blend_ready = 0;
+static SDL_BlendMode baked_blend_mode;
+
+// -----------------------------------------------------------------------------
+// Internal Helpers
+// -----------------------------------------------------------------------------
+
+// Draws map's chunk (chunk_x, chunk_y) with the chunk's bounding box at
+// (origin_x, origin_y). When view is given, only tiles inside it are drawn.
+static void draw_chunk_tiles(SDL_Renderer* renderer, const MapView* map, int chunk_x, int chunk_y,
+                             int origin_x, int origin_y, const TileView* view) {
+    int x0 = chunk_x << MAP_CHUNK_SHIFT;
+    int y0 = chunk_y << MAP_CHUNK_SHIFT;
+    int x1 = x0 + MAP_CHUNK_SIZE - 1;
+    int y1 = y0 + MAP_CHUNK_SIZE - 1;
+    if (x1 > map->width - 1) x1 = map->width - 1;
+    if (y1 > map->height - 1) y1 = map->height - 1;
+
+    const MapChunk* chunk = map_view_chunk(map, chunk_x, chunk_y);
+    batch_begin(BATCH_UNORDERED);
+
+    for (int y = y0; y <= y1; y++) {
+        int row_min = x0;
+        int row_max = x1;
+        if (view) {
+            int view_min, view_max;
+            if (!tile_view_row(view, y, &view_min, &view_max)) continue;
+            if (view_min > row_min) row_min = view_min;
+            if (view_max < row_max) row_max = view_max;
+        }
+
+        const TileId* row = &chunk->tiles[(y & MAP_CHUNK_MASK) << MAP_CHUNK_SHIFT];
+        for (int x = row_min; x <= row_max; x++) {
+            TileId tile_id = row[x & MAP_CHUNK_MASK];
+            if (tile_id >= TILE_COUNT || tile_sprites[tile_id] == SPRITE_NONE) continue;
+
+            int lx = x - x0;
+            int ly = y - y0;
+            SDL_Rect dest = {
+                origin_x + (lx - ly + MAP_CHUNK_SIZE - 1) * (TILE_WIDTH / 2),
+                origin_y + (lx + ly) * (TILE_HEIGHT / 2),
+                TILE_WIDTH,
+                TILE_HEIGHT
+            };
+            batch_quad(renderer, tile_sprites[tile_id], &dest);
+        }
+    }
+    batch_flush(renderer);
+}
+
+// Returns 1 if any tile of the chunk lies inside the view.
+static int chunk_visible(const TileView* view, int chunk_x, int chunk_y) {
+    int x0 = chunk_x << MAP_CHUNK_SHIFT;
+    int x1 = x0 + MAP_CHUNK_SIZE - 1;
+    int y0 = chunk_y << MAP_CHUNK_SHIFT;
+    int y1 = y0 + MAP_CHUNK_SIZE - 1;
+    if (y0 < view->min_y) y0 = view->min_y;
+    if (y1 > view->max_y) y1 = view->max_y;
+
+    for (int y = y0; y <= y1; y++) {
+        int row_min, row_max;
+        if (tile_view_row(view, y, &row_min, &row_max) && row_min <= x1 && row_max >= x0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static BakedChunk* find_baked(int chunk_index) {
+    for (int i = 0; i < TERRAIN_CACHE_SIZE; i++) {
+        if (cache[i].texture && cache[i].chunk_index == chunk_index) {
+            return &cache[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns an unused slot, creating its texture, or recycles the least
+// recently drawn one. Slots already drawn this frame are never taken.
+static BakedChunk* claim_slot(SDL_Renderer* renderer) {
+    BakedChunk* victim = NULL;
+
+    for (int i = 0; i < TERRAIN_CACHE_SIZE; i++) {
+        BakedChunk* slot = &cache[i];
+        if (!slot->texture) {
+            slot->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                              MAP_CHUNK_SIZE * TILE_WIDTH, MAP_CHUNK_SIZE * TILE_HEIGHT);
+            if (!slot->texture) {
+                printf("Failed to create terrain chunk texture: %s\n", SDL_GetError());
+                break;
+            }
+
+            if (!baked_blend_ready) {
+                baked_blend_mode = SDL_ComposeCustomBlendMode(
+                        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+                baked_blend_ready = 1;
+            }
+            if (SDL_SetTextureBlendMode(slot->texture, baked_blend_mode) != 0) {
+                // Renderer without custom blend modes: edges come out slightly dark
+                SDL_SetTextureBlendMode(slot->texture, SDL_BLENDMODE_BLEND);
+            }
+            return slot;
+        }
+        if (slot->last_drawn != frame && (!victim || slot->last_drawn < victim->last_drawn)) {
+            victim = slot;
+        }
+    }
+
+    return victim;
+}
+
+// Renders a chunk's tiles into its slot texture.
+static int bake_chunk(SDL_Renderer* renderer, BakedChunk* slot, const MapView* map, int chunk_x, int chunk_y) {
+    SDL_Texture* previous = SDL_GetRenderTarget(renderer);
+    if (SDL_SetRenderTarget(renderer, slot->texture) != 0) {
+        printf("Failed to bake terrain chunk: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+
+    draw_chunk_tiles(renderer, map, chunk_x, chunk_y, 0, 0, NULL);
+
+    SDL_SetRenderTarget(renderer, previous);
+    return 1;
+}
+
+// Draws one chunk, from its baked texture when possible.
+static void draw_chunk(SDL_Renderer* renderer, Camera* cam, const MapView* map, const TileView* view,
+                       int chunk_x, int chunk_y, int* bakes_left) {
+    int view_index = map_view_index(map, chunk_x, chunk_y);
+    if (view_index < 0 || map->chunks[view_index] == &map_void_chunk) return;  // Not resident, nothing to draw
+    int chunk_index = chunk_y * ((map->width + MAP_CHUNK_MASK) >> MAP_CHUNK_SHIFT) + chunk_x;
+
+    int x0 = chunk_x << MAP_CHUNK_SHIFT;
+    int y0 = chunk_y << MAP_CHUNK_SHIFT;
+    int origin_x = (x0 - y0 - (MAP_CHUNK_SIZE - 1)) * (TILE_WIDTH / 2) - cam->x + map_offset_x;
+    int origin_y = (x0 + y0) * (TILE_HEIGHT / 2) - cam->y + map_offset_y;
+
+    uint32_t revision = map->revisions[view_index];
+    BakedChunk* slot = find_baked(chunk_index);
+
+    if (!slot || slot->revision != revision || slot->tile_generation != tile_sprite_generation) {
+        if (*bakes_left == 0) {
+            // Out of bake budget this frame: draw the visible tiles directly
+            draw_chunk_tiles(renderer, map, chunk_x, chunk_y, origin_x, origin_y, view);
+            return;
+        }
+
+        if (!slot) slot = claim_slot(renderer);
+        if (!slot) {
+            // Every texture is on screen already (cache smaller than the view)
+            draw_chunk_tiles(renderer, map, chunk_x, chunk_y, origin_x, origin_y, view);
+            return;
+        }
+
+        (*bakes_left)--;
+        slot->chunk_index = -1;
+        if (!bake_chunk(renderer, slot, map, chunk_x, chunk_y)) {
+            draw_chunk_tiles(renderer, map, chunk_x, chunk_y, origin_x, origin_y, view);
+            return;
+        }
+        slot->chunk_index = chunk_index;
+        slot->revision = revision;
+        slot->tile_generation = tile_sprite_generation;
+    }
+
+    slot->last_drawn = frame;
+    SDL_Rect dest = { origin_x, origin_y, MAP_CHUNK_SIZE * TILE_WIDTH, MAP_CHUNK_SIZE * TILE_HEIGHT };
+    SDL_RenderCopy(renderer, slot->texture, NULL, &dest);
+}
+
+// -----------------------------------------------------------------------------
+// Public API Implementation
+// -----------------------------------------------------------------------------
+
+int terrain_cache_draw(SDL_Renderer* renderer, Camera* cam, const MapView* map) {
+    if (!SDL_RenderTargetSupported(renderer)) return 0;
+
+    if (cache_map_serial != map->serial) {
+        terrain_cache_clear();
+        cache_map_serial = map->serial;
+    }
+    frame++;
+
+    TileView view;
+    camera_visible_tiles(cam, &view);
+
+    int bakes_left = TERRAIN_BAKES_PER_FRAME;
+
+    for (int chunk_y = view.min_y >> MAP_CHUNK_SHIFT; chunk_y <= view.max_y >> MAP_CHUNK_SHIFT; chunk_y++) {
+        // Visible x range over this chunk row's tile rows
+        int y0 = chunk_y << MAP_CHUNK_SHIFT;
+        int y1 = y0 + MAP_CHUNK_SIZE - 1;
+        if (y0 < view.min_y) y0 = view.min_y;
+        if (y1 > view.max_y) y1 = view.max_y;
+
+        int x_min = INT_MAX;
+        int x_max = -1;
+        for (int y = y0; y <= y1; y++) {
+            int row_min, row_max;
+            if (!tile_view_row(&view, y, &row_min, &row_max)) continue;
+            if (row_min < x_min) x_min = row_min;
+            if (row_max > x_max) x_max = row_max;
+        }
+        if (x_max < 0) continue;
+
+        for (int chunk_x = x_min >> MAP_CHUNK_SHIFT; chunk_x <= x_max >> MAP_CHUNK_SHIFT; chunk_x++) {
+            // The row range is a union over the diamond; corner chunks may miss it
+            if (!chunk_visible(&view, chunk_x, chunk_y)) continue;
+            draw_chunk(renderer, cam, map, &view, chunk_x, chunk_y, &bakes_left);
+        }
+    }
+
+    return 1;
+}
+
+void terrain_cache_clear(void) {
+    for (int i = 0; i < TERRAIN_CACHE_SIZE; i++) {
+        if (cache[i].texture) SDL_DestroyTexture(cache[i].texture);
+        cache[i] = (BakedChunk){ 0 };
+        cache[i].chunk_index = -1;
+    }
+}
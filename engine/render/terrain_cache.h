@@ -0,0 +1,68 @@
+// -----------------------------------------------------------------------------
+// terrain_cache.h
+//
+// Pre-rendered ground layer, one render-target texture per map chunk.
+// This module handles:
+//
+// - Baking a chunk's tiles into a texture once (one batched draw, see batch.h)
+// - Drawing only the baked chunks that overlap the window (one copy each)
+// - Re-baking a chunk when its chunk_revisions entry (as captured in the
+//   MapView drawn) changes (tile edits, streaming installs/evictions) or
+//   when tile images are replaced
+// - Keeping at most TERRAIN_CACHE_SIZE textures, least recently drawn
+//   evicted first
+//
+// Chunk texture layout:
+//
+//   A chunk's tiles form a diamond MAP_CHUNK_SIZE tiles on a side. Its
+//   bounding box is MAP_CHUNK_SIZE * TILE_WIDTH by MAP_CHUNK_SIZE *
+//   TILE_HEIGHT pixels; local tile (lx, ly) is drawn at
+//
+//     ((lx - ly + MAP_CHUNK_SIZE - 1) * TILE_WIDTH/2, (lx + ly) * TILE_HEIGHT/2)
+//
+//   and the texture's top-left sits where tile (x0 - MAP_CHUNK_SIZE + 1, y0)
+//   would be drawn, (x0, y0) being the chunk's first tile.
+//
+// Baked textures hold premultiplied alpha (tiles were blended onto a clear
+// target), so they are composited with a ONE / ONE_MINUS_SRC_ALPHA blend to
+// keep tile edges from darkening.
+//
+// Design goals:
+// - Draw calls per frame ~ visible chunks (tens), not visible tiles
+// - Bounded bake cost per frame (TERRAIN_BAKES_PER_FRAME); chunks over the
+//   budget are drawn tile by tile for that frame instead of stalling
+// - Falls back to per-tile drawing when render targets are unsupported
+// -----------------------------------------------------------------------------
+
+#ifndef TERRAIN_CACHE_H
+#define TERRAIN_CACHE_H
+
+#include "render/camera.h"
+#include "core/map.h"
+
+#include <SDL2/SDL.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define TERRAIN_CACHE_SIZE      24  // Baked chunk textures kept (8 MB each at 64x32 tiles)
+#define TERRAIN_BAKES_PER_FRAME 4   // Chunk bakes allowed per terrain_cache_draw()
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+// Draws the ground layer of every chunk of map overlapping the window,
+// baking or re-baking chunk textures as needed. Chunks outside map's box
+// are not drawn.
+//
+// Returns:
+//   1 if the terrain was drawn, 0 if the renderer has no render-target
+//   support (the caller should draw tiles directly).
+int terrain_cache_draw(SDL_Renderer* renderer, Camera* cam, const MapView* map);
+
+// Destroys every baked texture. Call before destroying the renderer.
+void terrain_cache_clear(void);
+
+#endif  // TERRAIN_CACHE_H
@@ -2,64 +2,141 @@
 #include "core/scene.h"
 #include "render/render.h"
 #include "render/camera.h"
+#include "render/terrain_cache.h"
 #include "entity/entity.h"
 #include "entity/player.h"
 #include "ai/behavior.h"
 #include "helpers/sdl_helpers.h"
+#include "core/timestep.h"
+#include "core/sim.h"
+#include "core/profiler.h"
+#include "core/headless.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 
 void game_loop(SDL_Renderer* renderer) {
-    // Main game loop
+    // Main game loop: events and drawing here, simulation on its own thread
     int running = 1;
     SDL_Event e;
+    Camera view = { 0, 0 };     // Camera of the last frame drawn, for mapping clicks
+    int dumps = 0;
+
+    profile_thread_name("main");
 
     while (running) {
+        profiler_frame();
+
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
                 running = 0;
             }
+
+            // Render-target contents are lost on some backends; re-bake
+            if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET) {
+                terrain_cache_clear();
+            }
             
-            // Feed input into player behavior system
+            // F9 writes the last frames of profiler zones as a Chrome trace
+            if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F9) {
+                char path[64];
+                snprintf(path, sizeof(path), "oblique-profile-%d.json", ++dumps);
+                profiler_dump(path);
+            }
+
+            // Feed input to the simulation thread (see sim.h)
             if (e.type == SDL_MOUSEBUTTONDOWN) {
-                Entity* player = get_player();
-                if (player) {
-                    handle_player_input(player, &e);
-                }
+                sim_push_input(&e, &view);
             }
         }
 
-        // Let all entities update (including player AI or input)
-        update_scene();
+        // Newest complete tick; the simulation keeps running meanwhile
+        const WorldSnapshot* snapshot = sim_latest_snapshot();
+        float alpha = sim_snapshot_alpha(snapshot);
 
         // Clear screen first
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
-        // Draw world and entities
-        render_scene(renderer);
+        // Draw world and entities, interpolated alpha of the way into the next tick
+        render_scene(renderer, snapshot, alpha);
+        view = sim_snapshot_camera(snapshot, alpha);
 
-        // Present the final frame
+        // Present the final frame (waits for vsync when enabled)
         SDL_RenderPresent(renderer);
-
-        // Simple frame delay
-        SDL_Delay(100);
     }
 }
 
 int main(int argc, char*argv[]) {
     SDL_Window* window = NULL;
     SDL_Renderer* renderer = NULL;
+    int vsync = 1;
+    int profile_frames = 0;     // 0 = profiler off
+    int headless = 0;
+    HeadlessOptions options = { HEADLESS_DEFAULT_TICKS, NULL, HEADLESS_DEFAULT_SEED, 0 };
 
-    if (!init_sdl(&window, &renderer)) return 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            set_tick_rate(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--no-vsync") == 0) {
+            vsync = 0;
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            options.map = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = 1;
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            options.ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--offscreen") == 0) {
+            options.render = 1;
+        } else {
+            printf("Usage: %s [--tick-rate HZ] [--no-vsync] [--profile FRAMES] [--map FILE] [--seed N]\n"
+                   "       %s --headless [--ticks N] [--offscreen] [--tick-rate HZ] [--map FILE] [--seed N]\n",
+                   argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    // Zones are recorded only when profiling; F9 and exit dump the last FRAMES
+    profiler_init(profile_frames > 0, profile_frames);
+
+    if (headless) {
+        int ok = run_headless(&options);
+        if (profile_frames > 0) profiler_dump("oblique-profile-exit.json");
+        profiler_shutdown();
+        return ok ? 0 : 1;
+    }
+
+    srand(options.seed);
+    set_scene_map(options.map);
+
+    if (!init_sdl(&window, &renderer, vsync)) return 1;
+    init_render(renderer);
 
     set_scene(SCENE_EXPLORE, renderer);
 
+    if (!sim_init(1) || !sim_start()) {
+        sim_shutdown();
+        shutdown_render();
+        shutdown_sdl(window, renderer);
+        return 1;
+    }
+
     game_loop(renderer);
 
+    sim_stop();
+    sim_shutdown();
+
+    if (profiler_enabled) profiler_dump("oblique-profile-exit.json");
+    profiler_shutdown();
+    shutdown_render();
     shutdown_sdl(window, renderer);
     return 0;
 }
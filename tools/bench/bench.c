@@ -0,0 +1,799 @@
+// -----------------------------------------------------------------------------
+// bench.c
+//
+// Benchmarks for the engine's hot paths, with results written as JSON.
+//
+// Usage:
+//   oblique_bench [out.json]       default bench.json (`make bench` runs it)
+//
+// Benchmarks:
+// - find_path() (jump point search, hierarchical on long trips) and
+//   find_path_astar() on open, rubble, maze, unreachable and walled
+//   (scattered water and rubble) maps of several sizes; hierarchical paths
+//   are refined to the last tile
+// - The chunk hierarchy on a 2048-square walled map: one tick of cluster
+//   builds and the whole table from scratch, then trips of 128 to 2048
+//   tiles planned through it against the same trips searched tile by tile,
+//   which is where PATH_HIERARCHY_DISTANCE comes from
+// - calculate_move_grid() at several max_cost values, and again with
+//   nothing changed since the last call
+// - draw_map() and draw_entities() into an off-screen software renderer
+// - update_entities() with 10, 1k and 10k NPCs
+// - Chasers replanning towards a moving player: chase_behavior() (shared
+//   flow field) against one find_path() per chaser
+// - A batch of request_path() calls served by the worker pool until every
+//   path is attached, against the same searches run one after another, and
+//   one tick of the same batch served without workers (sliced searches
+//   within PATH_JOB_TICK_NODES; max_us is the worst tick)
+// - A pursuer replanning towards a goal that moves one tile per call:
+//   repairing its incremental search against a fresh find_path()
+// - Requests starting along a cached route: served by the path cache (also
+//   right after an edit the route cannot depend on) against find_path()
+// - Storing and freeing a 256-tile path in the path pool (the bytes it
+//   holds are printed)
+// - Bringing the region labels up to date after a one-tile edit
+//
+// Each case repeats its operation until BENCH_MIN_SECONDS have passed
+// (at least once, at most BENCH_MAX_ITERATIONS times) after warm-up calls,
+// and reports mean, min and max microseconds per operation. Maps, sprites
+// and entities are generated here with a fixed seed, so results do not
+// depend on asset files and runs are comparable release to release.
+// -----------------------------------------------------------------------------
+
+#include "core/map.h"
+#include "core/tile.h"
+#include "core/constants.h"
+#include "render/render.h"
+#include "render/camera.h"
+#include "entity/entity.h"
+#include "ai/behavior.h"
+#include "navigation/grid.h"
+#include "navigation/pathfinding.h"
+#include "navigation/hpa.h"
+#include "navigation/path_jobs.h"
+#include "navigation/path_cache.h"
+#include "navigation/path_pool.h"
+#include "navigation/regions.h"
+#include "navigation/replan.h"
+#include "helpers/sdl_helpers.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------------------
+
+#define BENCH_MIN_SECONDS       0.5
+#define BENCH_MAX_ITERATIONS    100000
+#define BENCH_MAX_RESULTS       128
+#define BENCH_SEED              12345
+#define BENCH_RUBBLE_ONE_IN     10
+#define BENCH_WATER_ONE_IN      7       // Walled maps: about 14% water, plus rubble
+#define BENCH_HIERARCHY_SIZE    2048    // Map the hierarchy cases run on
+#define BENCH_CHASE_RADIUS      20      // Chasers start this close to the player
+#define BENCH_CHASE_GOALS       8       // Player positions cycled through (more than FLOW_FIELD_SLOTS)
+#define BENCH_PATH_JOBS         PATH_JOB_TICK_BUDGET    // Requests per batch: all start at once
+#define BENCH_REPLAN_OFFSET     40      // Pursued goal starts this far from the pursuer on each axis
+#define BENCH_STORED_PATH       256     // Tiles in the path stored by bench_path_store()
+
+// -----------------------------------------------------------------------------
+// Results
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    const char* bench;
+    char params[128];       // JSON object body, e.g. "\"map\":\"open\",\"size\":64"
+    int iterations;
+    double mean_us;
+    double min_us;
+    double max_us;
+} BenchResult;
+
+static BenchResult results[BENCH_MAX_RESULTS];
+static int result_count = 0;
+
+typedef void (*BenchFunc)(void* ctx);
+
+static double seconds_between(Uint64 a, Uint64 b) {
+    return (double)(b - a) / SDL_GetPerformanceFrequency();
+}
+
+// Times op and records it under bench / params.
+static void run_bench(const char* bench, const char* params, int warmup, BenchFunc op, void* ctx) {
+    for (int i = 0; i < warmup; i++) op(ctx);
+
+    double total = 0.0, min = 0.0, max = 0.0;
+    int iterations = 0;
+    while (iterations < BENCH_MAX_ITERATIONS && (iterations == 0 || total < BENCH_MIN_SECONDS)) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        op(ctx);
+        double t = seconds_between(start, SDL_GetPerformanceCounter());
+
+        if (iterations == 0 || t < min) min = t;
+        if (t > max) max = t;
+        total += t;
+        iterations++;
+    }
+
+    if (result_count == BENCH_MAX_RESULTS) return;
+    BenchResult* r = &results[result_count++];
+    r->bench = bench;
+    snprintf(r->params, sizeof(r->params), "%s", params);
+    r->iterations = iterations;
+    r->mean_us = total / iterations * 1e6;
+    r->min_us = min * 1e6;
+    r->max_us = max * 1e6;
+
+    fprintf(stderr, "%-20s {%s}: %.2f us (%d runs)\n", bench, params, r->mean_us, iterations);
+}
+
+static int write_results(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return 0;
+    }
+
+    fprintf(f, "{\n  \"results\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        BenchResult* r = &results[i];
+        fprintf(f, "    {\"bench\":\"%s\",\"params\":{%s},\"iterations\":%d,"
+                   "\"mean_us\":%.3f,\"min_us\":%.3f,\"max_us\":%.3f}%s\n",
+                r->bench, r->params, r->iterations, r->mean_us, r->min_us, r->max_us,
+                i + 1 < result_count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return 1;
+}
+
+// -----------------------------------------------------------------------------
+// Maps
+// -----------------------------------------------------------------------------
+
+typedef enum {
+    MAP_OPEN,           // All walkable
+    MAP_RUBBLE,         // Open, one tile in BENCH_RUBBLE_ONE_IN is rubble
+    MAP_MAZE,           // Serpentine corridors: the path visits every row
+    MAP_UNREACHABLE,    // Open, but the goal corner is walled off
+    MAP_WALLED,         // One tile in BENCH_WATER_ONE_IN is water, then rubble as MAP_RUBBLE
+} BenchMap;
+
+static const char* map_names[] = { "open", "rubble", "maze", "unreachable", "walled" };
+
+// Builds a map and its whole chunk hierarchy, as the first ticks of a game
+// would, so long trips are timed through it.
+
+static int build_map(BenchMap kind, int size) {
+    if (!map_create(size, size)) return 0;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            map_set_tile(x, y, TILE_GRASS);
+        }
+    }
+
+    if (kind == MAP_RUBBLE) {
+        srand(BENCH_SEED);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                if (rand() % BENCH_RUBBLE_ONE_IN == 0) map_set_tile(x, y, TILE_RUBBLE);
+            }
+        }
+        map_set_tile(0, 0, TILE_GRASS);
+    } else if (kind == MAP_MAZE) {
+        // Wall every odd row, leaving one gap at alternating ends
+        for (int y = 1; y < size; y += 2) {
+            int gap = (y / 2) % 2 == 0 ? size - 1 : 0;
+            for (int x = 0; x < size; x++) {
+                if (x != gap) map_set_tile(x, y, TILE_WATER);
+            }
+        }
+    } else if (kind == MAP_UNREACHABLE) {
+        map_set_tile(size - 2, size - 1, TILE_WATER);
+        map_set_tile(size - 1, size - 2, TILE_WATER);
+    } else if (kind == MAP_WALLED) {
+        srand(BENCH_SEED);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                int r = rand();
+                if (r % BENCH_WATER_ONE_IN == 0) {
+                    map_set_tile(x, y, TILE_WATER);
+                } else if (r / BENCH_WATER_ONE_IN % BENCH_RUBBLE_ONE_IN == 0) {
+                    map_set_tile(x, y, TILE_RUBBLE);
+                }
+            }
+        }
+
+        // Keep both corners open, so the trip between them exists
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < 2; j++) {
+                map_set_tile(i, j, TILE_GRASS);
+                map_set_tile(size - 1 - i, size - 1 - j, TILE_GRASS);
+            }
+        }
+    }
+
+    hpa_update(INT_MAX);
+    return 1;
+}
+
+// Far corner, or for the maze the end of the last corridor away from its
+// entrance (with an even size the bottom row is a wall).
+static void map_goal(BenchMap kind, int size, int* x, int* y) {
+    *x = size - 1;
+    *y = size - 1;
+    if (kind == MAP_MAZE) {
+        *y = (size - 1) % 2 == 0 ? size - 1 : size - 2;
+        int entrance = ((*y - 1) / 2) % 2 == 0 ? size - 1 : 0;
+        *x = entrance == 0 ? size - 1 : 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Pathfinding
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    Path* (*find)(int start_x, int start_y, int goal_x, int goal_y);
+    int goal_x, goal_y;
+} PathBench;
+
+// Plans and refines the whole path, so hierarchical paths pay for every leg
+static void op_find_path(void* ctx) {
+    PathBench* b = ctx;
+    Path* path = b->find(0, 0, b->goal_x, b->goal_y);
+    while (refine_path(path)) path->current = path->length;
+    free_path(path);
+}
+
+static void bench_find_path(void) {
+    static const int sizes[] = { 32, 64, 128, 256, 1024 };
+
+    for (int kind = MAP_OPEN; kind <= MAP_WALLED; kind++) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            int size = sizes[s];
+            if (!build_map(kind, size)) continue;
+
+            PathBench b;
+            map_goal(kind, size, &b.goal_x, &b.goal_y);
+
+            char params[128];
+            snprintf(params, sizeof(params), "\"map\":\"%s\",\"size\":%d", map_names[kind], size);
+            b.find = find_path;
+            run_bench("find_path", params, 0, op_find_path, &b);
+            b.find = find_path_astar;
+            run_bench("find_path_astar", params, 0, op_find_path, &b);
+        }
+    }
+}
+
+static Path* find_path_through_hierarchy(int start_x, int start_y, int goal_x, int goal_y) {
+    return find_path_hierarchy(1, start_x, start_y, goal_x, goal_y);
+}
+
+static Path* find_path_by_tiles(int start_x, int start_y, int goal_x, int goal_y) {
+    return find_path_hierarchy(0, start_x, start_y, goal_x, goal_y);
+}
+
+// -----------------------------------------------------------------------------
+// Chunk hierarchy
+// -----------------------------------------------------------------------------
+
+// One tick's worth of cluster builds, from an empty table
+static void op_hpa_tick(void* ctx) {
+    (void)ctx;
+    hpa_reset();
+    hpa_update(HPA_TICK_BUILDS);
+}
+
+// Every cluster of the map, from an empty table
+static void op_hpa_build(void* ctx) {
+    (void)ctx;
+    hpa_reset();
+    hpa_update(INT_MAX);
+}
+
+static void bench_hierarchy(void) {
+    static const int trips[] = { 128, 256, 512, 1024, 2048 };     // Manhattan length
+    int size = BENCH_HIERARCHY_SIZE;
+    if (!build_map(MAP_WALLED, size)) return;
+
+    char params[128];
+    snprintf(params, sizeof(params), "\"map\":\"walled\",\"size\":%d,\"builds\":%d", size, HPA_TICK_BUILDS);
+    run_bench("hpa_update", params, 0, op_hpa_tick, NULL);
+    snprintf(params, sizeof(params), "\"map\":\"walled\",\"size\":%d", size);
+    run_bench("hpa_build", params, 0, op_hpa_build, NULL);
+
+    for (size_t t = 0; t < sizeof(trips) / sizeof(trips[0]); t++) {
+        // Diagonal from the open corner, to the next walkable tile along the row
+        PathBench b;
+        b.goal_x = trips[t] / 2 < size ? trips[t] / 2 : size - 1;
+        b.goal_y = b.goal_x;
+        while (b.goal_x + 1 < size && !map_walkable(b.goal_x, b.goal_y)) b.goal_x++;
+
+        snprintf(params, sizeof(params), "\"map\":\"walled\",\"size\":%d,\"trip\":%d,\"route\":\"hierarchy\"",
+                 size, trips[t]);
+        b.find = find_path_through_hierarchy;
+        run_bench("find_path_hierarchy", params, 1, op_find_path, &b);
+        snprintf(params, sizeof(params), "\"map\":\"walled\",\"size\":%d,\"trip\":%d,\"route\":\"tiles\"",
+                 size, trips[t]);
+        b.find = find_path_by_tiles;
+        run_bench("find_path_hierarchy", params, 1, op_find_path, &b);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Move grid
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    int max_cost;
+    int moves;          // Step the origin back and forth, so every call refills
+    int step;
+} MoveGridBench;
+
+static void op_move_grid(void* ctx) {
+    MoveGridBench* b = ctx;
+    if (b->moves) b->step = !b->step;
+    calculate_move_grid(map_width() / 2 + b->step, map_height() / 2, b->max_cost);
+}
+
+static void bench_move_grid(void) {
+    static const int costs[] = { 5, 10, 20, 40 };
+
+    if (!build_map(MAP_RUBBLE, 256)) return;
+
+    char params[128];
+    for (size_t i = 0; i < sizeof(costs) / sizeof(costs[0]); i++) {
+        MoveGridBench b = { costs[i], 1, 0 };
+        snprintf(params, sizeof(params), "\"map\":\"rubble\",\"size\":256,\"max_cost\":%d", costs[i]);
+        run_bench("calculate_move_grid", params, 1, op_move_grid, &b);
+    }
+
+    // Same origin every tick, as update_scene() calls it while the player stands still
+    MoveGridBench b = { 10, 0, 0 };
+    snprintf(params, sizeof(params), "\"map\":\"rubble\",\"size\":256,\"max_cost\":10");
+    run_bench("calculate_move_grid_unchanged", params, 1, op_move_grid, &b);
+}
+
+// -----------------------------------------------------------------------------
+// Rendering
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    SDL_Renderer* renderer;
+    Camera camera;
+    MapView map;            // Chunks under camera, as a snapshot carries them
+    EntityView* views;
+    int view_count;
+} DrawBench;
+
+static SDL_Surface* solid_surface(int w, int h, Uint8 r, Uint8 g, Uint8 b) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (surface) SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, r, g, b, 255));
+    return surface;
+}
+
+// Gives every tile type a flat-colored image and returns an entity sprite.
+static SpriteId load_bench_sprites(void) {
+    for (int id = 0; id < TILE_COUNT; id++) {
+        SDL_Surface* surface = solid_surface(TILE_WIDTH, TILE_HEIGHT, 40 * id, 120, 60);
+        if (surface) {
+            set_tile_image((TileId)id, surface);
+            SDL_FreeSurface(surface);
+        }
+    }
+
+    SDL_Surface* surface = solid_surface(32, 64, 200, 200, 200);
+    SpriteId sprite = surface ? atlas_add_surface(surface) : SPRITE_NONE;
+    SDL_FreeSurface(surface);
+    return sprite;
+}
+
+// Adds count NPCs around (cx, cy), within radius tiles.
+static void spawn_npcs(int count, int cx, int cy, int radius, SpriteId sprite) {
+    for (int i = 0; i < count; i++) {
+        int x = cx + rand() % (2 * radius + 1) - radius;
+        int y = cy + rand() % (2 * radius + 1) - radius;
+        int id = add_entity(x, y, sprite, 32, 64, 16, -48, 0, wander_behavior);
+        if (id >= 0) entities[id].state = STATE_IDLE;
+    }
+}
+
+static void op_draw_map(void* ctx) {
+    DrawBench* b = ctx;
+    SDL_RenderClear(b->renderer);
+    draw_map(b->renderer, &b->camera, &b->map);
+}
+
+static void op_draw_entities(void* ctx) {
+    DrawBench* b = ctx;
+    draw_entities(b->renderer, &b->camera, b->views, b->view_count, 0.5f);
+}
+
+static void bench_rendering(SDL_Renderer* renderer) {
+    static const int entity_counts[] = { 100, 1000, 10000 };
+
+    if (!build_map(MAP_OPEN, 256)) return;
+    calculate_map_offset();
+    SpriteId sprite = load_bench_sprites();
+
+    DrawBench b = { 0 };
+    b.renderer = renderer;
+    update_camera(&b.camera, 128.0f, 128.0f);
+
+    int x0, y0, x1, y1;
+    camera_visible_chunks(&b.camera, &x0, &y0, &x1, &y1);
+    map_view_capture(&b.map, x0, y0, x1, y1);
+
+    char params[128];
+    snprintf(params, sizeof(params), "\"map\":\"open\",\"size\":256,\"terrain_cache\":%d",
+             SDL_RenderTargetSupported(renderer) ? 1 : 0);
+    run_bench("draw_map", params, 2, op_draw_map, &b);
+
+    b.views = malloc(sizeof(EntityView) * MAX_ENTITIES);
+    if (!b.views) return;
+
+    for (size_t i = 0; i < sizeof(entity_counts) / sizeof(entity_counts[0]); i++) {
+        init_entities();
+        spawn_npcs(entity_counts[i], 128, 128, 10, sprite);     // All on screen
+        b.view_count = build_entity_views(b.views);
+
+        snprintf(params, sizeof(params), "\"entities\":%d", entity_counts[i]);
+        run_bench("draw_entities", params, 2, op_draw_entities, &b);
+    }
+    free(b.views);
+}
+
+// -----------------------------------------------------------------------------
+// Entity updates
+// -----------------------------------------------------------------------------
+
+static void op_update_entities(void* ctx) {
+    update_entities();
+}
+
+static void bench_update_entities(void) {
+    static const int npc_counts[] = { 10, 1000, 10000 };
+
+    if (!build_map(MAP_OPEN, 256)) return;
+
+    for (size_t i = 0; i < sizeof(npc_counts) / sizeof(npc_counts[0]); i++) {
+        srand(BENCH_SEED);
+        init_entities();
+        add_entity(128, 128, SPRITE_NONE, 32, 64, 16, -48, 1, NULL);   // Player for AI to react to
+        spawn_npcs(npc_counts[i], 128, 128, 120, SPRITE_NONE);
+
+        char params[128];
+        snprintf(params, sizeof(params), "\"npcs\":%d", npc_counts[i]);
+        run_bench("update_entities", params, 10, op_update_entities, NULL);
+
+        for (int e = 0; e < entity_count; e++) {
+            free_path(entities[e].path);
+            entities[e].path = NULL;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Chasers
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    Entity* player;
+    int first_npc;
+    int moves;
+    int shared;         // chase_behavior() rather than find_path() per chaser
+} ChaseBench;
+
+// Moves the player, then has every chaser plan towards it
+static void op_chase(void* ctx) {
+    ChaseBench* b = ctx;
+    b->player->x = 128 + b->moves++ % BENCH_CHASE_GOALS;
+
+    for (int e = b->first_npc; e < entity_count; e++) {
+        Entity* npc = &entities[e];
+        free_path(npc->path);
+        npc->path = NULL;
+        if (b->shared) {
+            chase_behavior(npc);
+        } else {
+            npc->path = find_path(npc->x, npc->y, b->player->x, b->player->y);
+        }
+    }
+}
+
+static void bench_chase(void) {
+    static const int chaser_counts[] = { 10, 100, 1000 };
+
+    if (!build_map(MAP_RUBBLE, 256)) return;
+
+    for (size_t i = 0; i < sizeof(chaser_counts) / sizeof(chaser_counts[0]); i++) {
+        srand(BENCH_SEED);
+        init_entities();
+        int player = add_entity(128, 128, SPRITE_NONE, 32, 64, 16, -48, 1, NULL);
+        spawn_npcs(chaser_counts[i], 128, 128, BENCH_CHASE_RADIUS, SPRITE_NONE);
+
+        ChaseBench b = { &entities[player], player + 1, 0, 1 };
+        char params[128];
+        snprintf(params, sizeof(params), "\"map\":\"rubble\",\"size\":256,\"chasers\":%d", chaser_counts[i]);
+        run_bench("chase_flow_field", params, 1, op_chase, &b);
+        b.shared = 0;
+        run_bench("chase_find_path", params, 1, op_chase, &b);
+
+        for (int e = 0; e < entity_count; e++) {
+            free_path(entities[e].path);
+            entities[e].path = NULL;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Path jobs
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    int goal_x, goal_y;
+    int async;          // request_path() on the workers rather than find_path() here
+} PathJobBench;
+
+static void op_path_jobs(void* ctx) {
+    PathJobBench* b = ctx;
+
+    for (int e = 0; e < entity_count; e++) {
+        free_path(entities[e].path);
+        entities[e].path = NULL;
+        if (b->async) {
+            request_path(&entities[e], b->goal_x, b->goal_y);
+        } else {
+            entities[e].path = find_path(entities[e].x, entities[e].y, b->goal_x, b->goal_y);
+        }
+    }
+
+    for (int e = 0; b->async && e < entity_count; ) {
+        path_jobs_update();
+        while (e < entity_count && entities[e].path_ticket == PATH_TICKET_NONE) e++;
+        if (e < entity_count) SDL_Delay(0);
+    }
+}
+
+// Without workers: one tick's share of the searches, requesting every path
+// again once the last one has arrived
+static void op_path_jobs_tick(void* ctx) {
+    PathJobBench* b = ctx;
+
+    int outstanding = 0;
+    for (int e = 0; e < entity_count; e++) {
+        outstanding |= entities[e].path_ticket != PATH_TICKET_NONE;
+    }
+    for (int e = 0; !outstanding && e < entity_count; e++) {
+        free_path(entities[e].path);
+        entities[e].path = NULL;
+        request_path(&entities[e], b->goal_x, b->goal_y);
+    }
+    path_jobs_update();
+}
+
+static void bench_path_jobs(void) {
+    if (!build_map(MAP_MAZE, 256) || !path_jobs_start()) return;
+
+    srand(BENCH_SEED);
+    init_entities();
+    for (int i = 0; i < BENCH_PATH_JOBS; i++) {
+        add_entity(rand() % 256, 2 * (rand() % 4), SPRITE_NONE, 32, 64, 16, -48, 0, NULL);    // Even rows are corridors
+    }
+
+    PathJobBench b;
+    b.async = 1;
+    map_goal(MAP_MAZE, 256, &b.goal_x, &b.goal_y);
+
+    char params[128];
+    snprintf(params, sizeof(params), "\"map\":\"maze\",\"size\":256,\"requests\":%d,\"workers\":%d",
+             BENCH_PATH_JOBS, PATH_JOB_WORKERS);
+    run_bench("path_jobs", params, 1, op_path_jobs, &b);
+    b.async = 0;
+    run_bench("path_jobs_sync", params, 1, op_path_jobs, &b);
+
+    path_jobs_stop();
+    snprintf(params, sizeof(params), "\"map\":\"maze\",\"size\":256,\"requests\":%d,\"tick_nodes\":%d",
+             BENCH_PATH_JOBS, PATH_JOB_TICK_NODES);
+    run_bench("path_jobs_tick", params, 1, op_path_jobs_tick, &b);
+    path_jobs_stop();
+    for (int e = 0; e < entity_count; e++) {
+        free_path(entities[e].path);
+        entities[e].path = NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Incremental replanning
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    int start_x, start_y;
+    int moves;
+    int incremental;    // replan_path() rather than find_path()
+} ReplanBench;
+
+// Moves the goal one tile along a short loop, then plans the whole way to it
+static void op_replan(void* ctx) {
+    ReplanBench* b = ctx;
+    int offset = b->moves++ % (2 * BENCH_CHASE_GOALS);
+    if (offset >= BENCH_CHASE_GOALS) offset = 2 * BENCH_CHASE_GOALS - 1 - offset;
+    int goal_x = b->start_x + BENCH_REPLAN_OFFSET + offset;
+    int goal_y = b->start_y + BENCH_REPLAN_OFFSET;
+
+    Path* path = b->incremental
+        ? replan_path(0, b->start_x, b->start_y, goal_x, goal_y, REPLAN_SIDE * REPLAN_SIDE)
+        : find_path(b->start_x, b->start_y, goal_x, goal_y);
+    free_path(path);
+}
+
+static void bench_replan(void) {
+    if (!build_map(MAP_RUBBLE, 256)) return;
+
+    ReplanBench b = { 64, 64, 0, 1 };
+    char params[128];
+    snprintf(params, sizeof(params), "\"map\":\"rubble\",\"size\":256,\"distance\":%d",
+             2 * BENCH_REPLAN_OFFSET);
+    run_bench("replan_moving_goal", params, 1, op_replan, &b);
+    b.incremental = 0;
+    run_bench("find_path_moving_goal", params, 1, op_replan, &b);
+    replan_reset();
+}
+
+// -----------------------------------------------------------------------------
+// Path cache
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    Path* route;        // Cached route whose tiles the requests start from
+    int goal_x, goal_y;
+    int next;
+    int edit;           // Change a tile far from the route before each request
+    int cached;         // find_path_cached() rather than find_path()
+} PathCacheBench;
+
+// Plans from the next tile along the cached route to its goal
+static void op_path_cache(void* ctx) {
+    PathCacheBench* b = ctx;
+    PathNode from = path_node(b->route, b->next++ % (b->route->length - 1));
+
+    if (b->edit) {
+        b->edit = 3 - b->edit;      // Toggle between 1 and 2
+        map_set_tile(map_width() - 1, 0, b->edit == 1 ? TILE_RUBBLE : TILE_GRASS);
+    }
+
+    Path* path = b->cached
+        ? find_path_cached(from.x, from.y, b->goal_x, b->goal_y)
+        : find_path(from.x, from.y, b->goal_x, b->goal_y);
+    free_path(path);
+}
+
+static void bench_path_cache(void) {
+    if (!build_map(MAP_RUBBLE, 256)) return;
+
+    path_cache_reset();
+    PathCacheBench b = { NULL, 100, 100, 0, 0, 1 };
+    b.route = find_path_cached(0, 0, b.goal_x, b.goal_y);
+    if (!b.route || b.route->length < 2) {
+        free_path(b.route);
+        return;
+    }
+
+    const char* params = "\"map\":\"rubble\",\"size\":256,\"distance\":200";
+    run_bench("path_cache_hit", params, 1, op_path_cache, &b);
+    b.edit = 1;
+    run_bench("path_cache_hit_after_edit", params, 1, op_path_cache, &b);
+    b.edit = 0;
+    b.cached = 0;
+    run_bench("find_path_cache_trips", params, 1, op_path_cache, &b);
+
+    PathCacheStats stats = path_cache_stats();
+    fprintf(stderr, "path cache: %u hits, %u misses, %u invalidated\n",
+            stats.hits, stats.misses, stats.invalidations);
+    free_path(b.route);
+    path_cache_reset();
+}
+
+// -----------------------------------------------------------------------------
+// Path storage
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    PathNode nodes[BENCH_STORED_PATH];
+} PathStoreBench;
+
+static void op_path_store(void* ctx) {
+    PathStoreBench* b = ctx;
+    free_path(path_from_nodes(b->nodes, BENCH_STORED_PATH));
+}
+
+static void bench_path_store(void) {
+    static PathStoreBench b;
+    for (int i = 0; i < BENCH_STORED_PATH; i++) {
+        b.nodes[i] = (PathNode){ i / 2, (i + 1) / 2 };     // Staircase: every move turns
+    }
+
+    char params[128];
+    snprintf(params, sizeof(params), "\"length\":%d", BENCH_STORED_PATH);
+    run_bench("path_store", params, 1, op_path_store, &b);
+
+    // Memory held by one stored path, against a Path plus a PathNode array
+    size_t before = path_pool_stats().bytes_in_use;
+    Path* path = path_from_nodes(b.nodes, BENCH_STORED_PATH);
+    size_t pooled = path_pool_stats().bytes_in_use - before;
+    free_path(path);
+    fprintf(stderr, "path pool: %zu bytes per %d-tile path (%zu as PathNodes)\n",
+            pooled, BENCH_STORED_PATH, sizeof(Path) + sizeof(PathNode) * BENCH_STORED_PATH);
+}
+
+// -----------------------------------------------------------------------------
+// Regions
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    int size;
+    int wall;           // Toggled each call, so every query follows an edit
+} RegionBench;
+
+static void op_regions_edit(void* ctx) {
+    RegionBench* b = ctx;
+    b->wall = !b->wall;
+    map_set_tile(b->size / 2, b->size / 2, b->wall ? TILE_WATER : TILE_GRASS);
+    regions_connected(0, 0, b->size - 1, b->size - 1);
+}
+
+static void bench_regions(void) {
+    static const int sizes[] = { 256, 1024 };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        if (!build_map(MAP_RUBBLE, sizes[s])) continue;
+
+        RegionBench b = { sizes[s], 0 };
+        char params[128];
+        snprintf(params, sizeof(params), "\"map\":\"rubble\",\"size\":%d", sizes[s]);
+        run_bench("regions_edit", params, 1, op_regions_edit, &b);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Entry Point
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    const char* out = argc > 1 ? argv[1] : "bench.json";
+
+    SDL_Surface* target = NULL;
+    SDL_Renderer* renderer = NULL;
+    if (!init_sdl_headless(&target, &renderer)) {
+        shutdown_sdl_headless(target, renderer);
+        return 1;
+    }
+    init_render(renderer);
+    srand(BENCH_SEED);
+
+    bench_find_path();
+    bench_hierarchy();
+    bench_move_grid();
+    bench_rendering(renderer);
+    bench_update_entities();
+    bench_chase();
+    bench_path_jobs();
+    bench_replan();
+    bench_path_cache();
+    bench_path_store();
+    bench_regions();
+
+    int ok = write_results(out);
+    if (ok) fprintf(stderr, "bench: wrote %d results to %s\n", result_count, out);
+
+    release_path_workspace();
+    shutdown_render();
+    shutdown_sdl_headless(target, renderer);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// -----------------------------------------------------------------------------
+// map_convert.c
+//
+// Converts text maps (data/maps/*.txt) to the binary .omap format.
+//
+// Usage:
+//   map_convert <map.txt> [more.txt ...]     writes map.omap next to each input
+//   map_convert -o <out.omap> <map.txt>      explicit output path
+//
+// Each output is loaded back through the mmap() path and compared tile by
+// tile against the text source before the tool reports success.
+// -----------------------------------------------------------------------------
+
+#include "core/map.h"
+#include "core/map_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Builds "<input without .txt>.omap" into out.
+static void derive_output_path(const char* input, char* out, size_t out_size) {
+    size_t len = strlen(input);
+    if (len > 4 && strcmp(input + len - 4, ".txt") == 0) {
+        len -= 4;
+    }
+    snprintf(out, out_size, "%.*s.omap", (int)len, input);
+}
+
+static int convert(const char* input, const char* output) {
+    if (!load_map(input)) {
+        fprintf(stderr, "map_convert: failed to read %s\n", input);
+        return 0;
+    }
+
+    int width = map_width();
+    int height = map_height();
+    TileId* expected = malloc(sizeof(TileId) * width * height);
+    if (!expected) return 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            expected[y * width + x] = map_get_tile(x, y);
+        }
+    }
+
+    int ok = save_map_file(output) && load_map_file(output) &&
+             map_width() == width && map_height() == height;
+
+    for (int y = 0; ok && y < height; y++) {
+        for (int x = 0; ok && x < width; x++) {
+            ok = map_get_tile(x, y) == expected[y * width + x];
+        }
+    }
+
+    free(expected);
+    map_free();
+
+    if (!ok) {
+        fprintf(stderr, "map_convert: %s failed verification\n", output);
+        return 0;
+    }
+
+    printf("%s -> %s (%dx%d)\n", input, output, width, height);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s [-o out.omap] <map.txt> [more.txt ...]\n", argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "-o") == 0) {
+        if (argc != 4) {
+            fprintf(stderr, "usage: %s -o <out.omap> <map.txt>\n", argv[0]);
+            return 1;
+        }
+        return convert(argv[3], argv[2]) ? 0 : 1;
+    }
+
+    int failures = 0;
+    for (int i = 1; i < argc; i++) {
+        char output[1024];
+        derive_output_path(argv[i], output, sizeof(output));
+        if (!convert(argv[i], output)) failures++;
+    }
+
+    return failures ? 1 : 0;
+}